@@ -0,0 +1,55 @@
+#include <string.h>
+#include "arena.h"
+
+#define ARENA_ALIGN sizeof(long double)
+
+size_t arenaAlign(size_t size) {
+  return (size + ARENA_ALIGN - 1) & ~(ARENA_ALIGN - 1);
+}
+
+Arena* arenaNew(size_t blockSize) {
+  Arena *a = (Arena*)malloc(sizeof(Arena));
+  assert(NULL != a);
+  a->blockSize = blockSize;
+  a->head = NULL;
+  return a;
+}
+
+void* arenaAlloc(Arena *a, size_t size) {
+  arenaBlock *block;
+  size_t header = arenaAlign(sizeof(arenaBlock));
+  size = arenaAlign(size);
+  if ( NULL == a->head || a->head->used + size > a->head->size ) {
+    size_t blockSize = size > a->blockSize ? size : a->blockSize;
+    block = (arenaBlock*)malloc(header + blockSize);
+    assert(NULL != block);
+    block->size = blockSize;
+    block->used = 0;
+    block->next = a->head;
+    a->head = block;
+  }
+  block = a->head;
+  void *out = (char*)block + header + block->used;
+  block->used += size;
+  return out;
+}
+
+char* arenaStrdup(Arena *a, const char *str) {
+  if ( NULL == str ) return NULL;
+  size_t len = strlen(str) + 1;
+  char *out = (char*)arenaAlloc(a, len);
+  memcpy(out, str, len);
+  return out;
+}
+
+void arenaFree(Arena *a) {
+  arenaBlock *current;
+  arenaBlock *next;
+  current = a->head;
+  while ( NULL != current ) {
+    next = current->next;
+    free(current);
+    current = next;
+  }
+  free(a);
+}
@@ -0,0 +1,54 @@
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <stdlib.h> /* malloc */
+#include <assert.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct arenaBlock {
+  struct arenaBlock *next;
+  size_t size;
+  size_t used;
+} arenaBlock;
+
+typedef struct {
+  size_t blockSize;
+  arenaBlock *head;
+} Arena;
+
+
+/* arena_new - Allocates and initializes an arena. Memory is handed out from blocks
+ *             of block_size bytes which are only released together by arenaFree
+ * @block_size - Size of a single block of the arena */
+
+
+Arena* arenaNew(size_t block_size);
+
+
+/* arena_alloc - Returns size bytes of memory aligned for any type from the arena
+ * @size - Number of bytes required */
+
+
+void* arenaAlloc(Arena *a, size_t size);
+
+
+/* arena_strdup - Copies a string into the arena and returns the copy, NULL for NULL
+ * @str - String to copy */
+
+
+char* arenaStrdup(Arena *a, const char *str);
+
+
+/* arena_free - Frees all the memory handed out by the arena and the arena itself */
+
+
+void arenaFree(Arena *a);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -1,4 +1,9 @@
 #include "cdg.h"
+#include "cdgCompact.h"
+#include "cdgHits.h"
+#include "cdgCores.h"
+#include "cdgTrace.h"
+#include "cdgPredicates.h"
 
 int max(int a, int b) {
   return a > b ? a : b;
@@ -32,24 +37,29 @@ void postOrder(CDGNode* root, Stack* s) {
 }
 
 CDGNode* getTrueNodeSet(CDGNode* node) {
+  if ( isCompactNode(node) ) return compactGetTrueNodeSet(node);
   return node->trueNodeSet;
 }
 
 CDGNode* setTrueNodeSet(CDGNode* node, CDGNode* trueNodeSet) {
+  assert(!isCompactNode(node));
   node->trueNodeSet = trueNodeSet;
   return node;
 }
 
 CDGNode* getFalseNodeSet(CDGNode* node) {
+  if ( isCompactNode(node) ) return compactGetFalseNodeSet(node);
   return node->falseNodeSet;
 }
 
 CDGNode* setFalseNodeSet(CDGNode* node, CDGNode* falseNodeSet) {
+  assert(!isCompactNode(node));
   node->falseNodeSet = falseNodeSet;
   return node;
 }
 
 CDGNode* setNextNode(CDGNode* node, CDGNode* nextNode) {
+  assert(!isCompactNode(node));
   node->next = nextNode;
   if ( nextNode ) setParent(nextNode, getParent(node));
   return node;
@@ -86,6 +96,7 @@ int hasUncoveredChild(CDGNode* node, int branch) {
     temp = getTrueNodeSet(node);
   else
     temp = getFalseNodeSet(node);    
+  if ( getFlags(node) & CDG_IMPLICIT(branch) ) return 1;
   while (temp) {
     if (isLeaf(temp) && 0 < getScore(temp)) return 1;
     temp = getNextNode(temp);
@@ -119,7 +130,11 @@ int isConditionalLeaf(CDGNode* node) {
 }
 
 CDGNode* resetExpr(CDGNode* node) {
-  if (NULL != node->expr) free(node->expr);
+  if (NULL != node->predicate) {
+    releasePredicate(node->predicate);
+  } else if (NULL != node->expr) {
+    free(node->expr);
+  }
   return node;
 }
 
@@ -190,6 +205,8 @@ CDGNode* newNode(int id, int score, int outcome, const char* expr, CDGNode* true
   setID(node, id);
   setScore(node, score);
   setOutcome(node, outcome);
+  setFlags(node, 0);
+  node->predicate = NULL;
   setExpr(node, expr);
   setTrueNodeSet(node, trueNodeSet);
   setFalseNodeSet(node, falseNodeSet);  
@@ -204,6 +221,7 @@ CDGNode* newBlankNode() {
 
 void deleteNode(CDGNode* node) {
   assert(NULL != node);
+  assert(!isCompactNode(node));
   resetExpr(node);
   resetTrueNodeSet(node);
   resetFalseNodeSet(node);
@@ -222,8 +240,9 @@ void deleteNodeList(CDGNode* node) {
   } while (node);
 }
 
-void deleteCDG(CDGNode* root) {
-  if ( NULL == root ) return;
+/* Deletes the nodes of a tree of plain nodes, without telling the trace recorder */
+
+void deleteNodeTree(CDGNode* root) {
   CDGNode* node;
   Stack* nodeStack = stackNew(sizeof(CDGNode*));
   postOrder(root, nodeStack);
@@ -234,48 +253,98 @@ void deleteCDG(CDGNode* root) {
   stackFree(nodeStack);
 }
 
+void deleteCDG(CDGNode* root) {
+  if ( NULL == root ) return;
+  if ( getTraceRecorder() ) traceDeleteCDG(getTraceRecorder(), root);
+  if ( isCompactNode(root) ) {
+    deleteCompactCDG(root);
+    return;
+  }
+  deleteNodeTree(root);
+}
+
 int getID(CDGNode* node) {
+  if ( isCompactNode(node) ) return compactGetID(node);
   return node->id;
 }
 
 CDGNode* setID(CDGNode* node, int id) {
+  assert(!isCompactNode(node));
   node->id = id;
   return node;
 }
 
 int getScore(CDGNode* node) {
+  if ( isCompactNode(node) ) return compactGetScore(node);
   return node->score;
 }
 
 CDGNode* setScore(CDGNode* node, int score) {
+  if ( isCompactNode(node) ) return compactSetScore(node, score);
   node->score = score;
   return node;
 }
 
 int getOutcome(CDGNode* node) {
+  if ( isCompactNode(node) ) return compactGetOutcome(node);
   return node->outcome;
 }
 
 CDGNode* setOutcome(CDGNode* node, int outcome) {
+  if ( isCompactNode(node) ) return compactSetOutcome(node, outcome);
   node->outcome = outcome;
   return node;
 }
 
+int getFlags(CDGNode* node) {
+  if ( isCompactNode(node) ) return compactGetFlags(node);
+  return node->flags;
+}
+
+CDGNode* setFlags(CDGNode* node, int flags) {
+  if ( isCompactNode(node) ) return compactSetFlags(node, flags);
+  node->flags = flags;
+  return node;
+}
+
 char* getExpr(CDGNode* node) {
+  if ( isCompactNode(node) ) return compactGetExpr(node);
   return node->expr;
 }
 
 CDGNode* setExpr(CDGNode* node, const char* expr) {
+  assert(!isCompactNode(node));
+  node->predicate = NULL;
   if ( NULL == expr ) {
     node->expr = NULL;
     return node;
   }
+  if ( NULL != getPredicateParser() ) return setPredicate(node, internPredicate(getPredicateParser(), expr));
   node->expr = (char*)malloc(sizeof(char)*(strlen(expr)+1));
   strcpy(node->expr, expr);
   return node;
 }
 
+CDGPredicate* getPredicate(CDGNode* node) {
+  if ( isCompactNode(node) ) return NULL;
+  return node->predicate;
+}
+
+CDGNode* setPredicate(CDGNode* node, CDGPredicate* predicate) {
+  assert(!isCompactNode(node));
+  assert(NULL != predicate);
+  node->predicate = retainPredicate(predicate);
+  node->expr = predicate->expr;
+  return node;
+}
+
+void* getParsedPredicate(CDGNode* node) {
+  CDGPredicate* predicate = getPredicate(node);
+  return NULL == predicate ? NULL : predicate->parsed;
+}
+
 CDGNode* addTrueNode(CDGNode* node, CDGNode* trueNode) {
+  assert(!isCompactNode(node) && !isCompactNode(trueNode));
   if ( NULL == trueNode ) return node;
   trueNode->next = node->trueNodeSet;
   node->trueNodeSet = trueNode;
@@ -284,6 +353,7 @@ CDGNode* addTrueNode(CDGNode* node, CDGNode* trueNode) {
 }
 
 CDGNode* addFalseNode(CDGNode* node, CDGNode* falseNode) {
+  assert(!isCompactNode(node) && !isCompactNode(falseNode));
   if ( NULL == falseNode ) return node;
   falseNode->next = node->falseNodeSet;
   node->falseNodeSet = falseNode;
@@ -292,40 +362,47 @@ CDGNode* addFalseNode(CDGNode* node, CDGNode* falseNode) {
 }
 
 CDGNode* getParent(CDGNode* node) {
+  if ( isCompactNode(node) ) return compactGetParent(node);
   return node->parent;
 }
 
 CDGNode* setParent(CDGNode* node, CDGNode* parentNode) {
+  assert(!isCompactNode(node));
   node->parent = parentNode;
   return node;
 }
 
 CDGNode* getNextNode(CDGNode* node) {
+  if ( isCompactNode(node) ) return compactGetNextNode(node);
   return node->next;
 }
 
+/* Score a decision has with an outcome. 0 for a branch blocked by an infeasible core or with
+   nothing left to cover below it */
+
+int scoreBranch(CDGNode* node, int outcome, int conditionalLeaf, CDGScoring* scoring) {
+  CDGHitCounts* hits = NULL != scoring ? scoring->hits : NULL;
+  if ( NULL != scoring && NULL != scoring->cores && isBranchBlocked(scoring->cores, node, outcome) ) return 0;
+  int sum = conditionalLeaf ? 0 : getConditionalNodeSum(outcome ? getTrueNodeSet(node) : getFalseNodeSet(node));
+  if ( 0 < sum ) return sum + getBranchWeight(hits, node, outcome);
+  return hasUncoveredChild(node, outcome) ? getBranchWeight(hits, node, outcome) : 0;
+}
+
 CDGNode* updateScore(CDGNode* node) {
+  return updateScoreWith(node, NULL);
+}
+
+CDGNode* updateScoreWith(CDGNode* node, CDGScoring* scoring) {
   assert(NULL != node);
   if ( isLeaf(node) ) return node;
-  if ( isConditionalLeaf(node)) {
-    if ( hasUncoveredChild(node, 1)) {
-      setScore(node, 1);
-      return setOutcome(node, 1);
-    }
-    if ( hasUncoveredChild(node, 0)) {
-      setScore(node, 1);
-      return setOutcome(node, 0);      
-    }
-    setScore(node, 0);
-    return setOutcome(node, 1);    
-  }
-  int trueScore = getConditionalNodeSum(getTrueNodeSet(node));
-  int falseScore = getConditionalNodeSum(getFalseNodeSet(node));
+  int conditionalLeaf = isConditionalLeaf(node);
+  int trueScore = scoreBranch(node, 1, conditionalLeaf, scoring);
+  int falseScore = scoreBranch(node, 0, conditionalLeaf, scoring);
   if ( trueScore >= falseScore ) {
-    setScore(node, trueScore + 1);
+    setScore(node, trueScore);
     setOutcome(node, 1);
   } else {
-    setScore(node, falseScore + 1);
+    setScore(node, falseScore);
     setOutcome(node, 0);
   }
   return node;
@@ -370,14 +447,96 @@ CDGNode* unVisitNode(CDGNode* node) {
   return setScore(node, 1);
 }
 
+CDGTransaction* beginTransaction() {
+  return beginTransactionWith(NULL);
+}
+
+CDGTransaction* beginTransactionWith(CDGScoring* scoring) {
+  CDGTransaction* txn;
+  txn = (CDGTransaction*)malloc(sizeof(CDGTransaction));
+  assert(NULL != txn);
+  txn->undoLog = stackNew(sizeof(CDGUndoEntry));
+  txn->scoring = scoring;
+  return txn;
+}
+
+void logNodeState(CDGTransaction* txn, CDGNode* node) {
+  CDGUndoEntry entry;
+  entry.node = node;
+  entry.score = getScore(node);
+  entry.outcome = getOutcome(node);
+  entry.flags = getFlags(node);
+  stackPush(txn->undoLog, &entry);
+}
+
+/* Updates a node and its ancestors, stopping at the first one whose score does not change */
+
+void transactUpdateScores(CDGTransaction* txn, CDGNode* currNode) {
+  int oldScore;
+  while ( currNode ) {
+    oldScore = getScore(currNode);
+    logNodeState(txn, currNode);
+    updateScoreWith(currNode, txn->scoring);
+    if ( oldScore == getScore(currNode) ) break;
+    currNode = getParent(currNode);
+  }
+}
+
+CDGNode* transactSetScore(CDGTransaction* txn, CDGNode* node, int score) {
+  assert(NULL != txn);
+  assert(NULL != node);
+  if ( score == getScore(node) ) return node;
+  logNodeState(txn, node);
+  setScore(node, score);
+  transactUpdateScores(txn, getParent(node));
+  return node;
+}
+
+CDGNode* transactCoverImplicit(CDGTransaction* txn, CDGNode* node, int outcome) {
+  assert(NULL != txn);
+  assert(NULL != node);
+  if ( !(getFlags(node) & CDG_IMPLICIT(outcome)) ) return node;
+  logNodeState(txn, node);
+  setFlags(node, getFlags(node) & ~CDG_IMPLICIT(outcome));
+  transactUpdateScores(txn, node);
+  return node;
+}
+
+void freeTransaction(CDGTransaction* txn) {
+  stackFree(txn->undoLog);
+  free(txn->undoLog);
+  free(txn);
+}
+
+void commitTransaction(CDGTransaction* txn) {
+  assert(NULL != txn);
+  freeTransaction(txn);
+}
+
+void rollbackTransaction(CDGTransaction* txn) {
+  assert(NULL != txn);
+  CDGUndoEntry entry;
+  while ( !stackIsEmpty(txn->undoLog) ) {
+    stackPop(txn->undoLog, &entry);
+    setScore(entry.node, entry.score);
+    setOutcome(entry.node, entry.outcome);
+    setFlags(entry.node, entry.flags);
+  }
+  freeTransaction(txn);
+}
+
 CDGNode* updateCDG(CDGNode* root) {
+  return updateCDGWith(root, NULL);
+}
+
+CDGNode* updateCDGWith(CDGNode* root, CDGScoring* scoring) {
   assert(NULL != root);
   Stack* nodeStack = stackNew(sizeof(CDGNode*));
   CDGNode* node;
   postOrder(root, nodeStack);
   while ( !stackIsEmpty(nodeStack) ) {
     stackPop(nodeStack, &node);
-    updateScore(node);
+    updateScoreWith(node, scoring);
   }
   stackFree(nodeStack);
   return root;
@@ -385,6 +544,7 @@ CDGNode* updateCDG(CDGNode* root) {
 
 void visitChildren(CDGNode* node, int outcome) {
   CDGNode* children;
+  if ( getFlags(node) & CDG_IMPLICIT(outcome) ) setFlags(node, getFlags(node) & ~CDG_IMPLICIT(outcome));
   if (outcome) {
     children = getTrueNodeSet(node);
   } else {
@@ -411,8 +571,14 @@ void visitIfExists(CDGNode* node, CDGNode* nodes[], int size) {
 }
 
 void coverNodes(CDGNode* root, CDGNode* nodes[], int size) {
+  coverNodesWith(root, nodes, size, NULL);
+}
+
+void coverNodesWith(CDGNode* root, CDGNode* nodes[], int size, CDGScoring* scoring) {
   assert(NULL != root);
   if ( 0 == size ) return;
+  if ( getTraceRecorder() ) traceCoverNodes(getTraceRecorder(), root, nodes, size);
+  if ( NULL != scoring && NULL != scoring->hits ) recordHits(scoring->hits, nodes, size);
   Stack* nodeStack = stackNew(sizeof(CDGNode*));
   CDGNode* node;
   postOrder(root, nodeStack);
@@ -420,10 +586,105 @@ void coverNodes(CDGNode* root, CDGNode* nodes[], int size) {
     stackPop(nodeStack, &node);
     visitIfExists(node, nodes, size);
   }
-  updateCDG(root);
+  updateCDGWith(root, scoring);
   return;
 }
 
+void visitChildrenInTransaction(CDGNode* node, int outcome, CDGTransaction* txn) {
+  transactCoverImplicit(txn, node, outcome);
+  CDGNode* children;
+  if (outcome) {
+    children = getTrueNodeSet(node);
+  } else {
+    children = getFalseNodeSet(node);
+  }
+  while ( children ) {
+    if ( isLeaf(children) ) {
+      transactSetScore(txn, children, 0);
+    }
+    children = getNextNode(children);
+  }
+}
+
+/* UndoRecord - Undo log entry numbered in the order it was recorded */
+
+typedef struct UndoRecord {
+  CDGUndoEntry entry;
+  int seq;
+} UndoRecord;
+
+int compareUndoByNode(const void* a, const void* b) {
+  const UndoRecord* x = (const UndoRecord*)a;
+  const UndoRecord* y = (const UndoRecord*)b;
+  if ( x->entry.node != y->entry.node ) return x->entry.node < y->entry.node ? -1 : 1;
+  return x->seq - y->seq;
+}
+
+int compareUndoBySeq(const void* a, const void* b) {
+  return ((const UndoRecord*)a)->seq - ((const UndoRecord*)b)->seq;
+}
+
+int coverNodesWithChanges(CDGNode* root, CDGNode* nodes[], int size, CDGChange changes[], int capacity, CDGScoring* scoring) {
+  assert(NULL != root);
+  if ( 0 == size ) return 0;
+  if ( getTraceRecorder() ) traceCoverNodes(getTraceRecorder(), root, nodes, size);
+  if ( NULL != scoring && NULL != scoring->hits ) recordHits(scoring->hits, nodes, size);
+  CDGTransaction* txn = beginTransactionWith(scoring);
+  Stack* nodeStack = stackNew(sizeof(CDGNode*));
+  CDGNode* node;
+  int i;
+  postOrder(root, nodeStack);
+  while ( !stackIsEmpty(nodeStack) ) {
+    stackPop(nodeStack, &node);
+    for ( i = 0; i < size; i++ ) {
+      if ( getID(node) == getID(nodes[i]) ) {
+        visitChildrenInTransaction(node, getOutcome(nodes[i]), txn);
+        /* The recorded hit reweighs the branch even if nothing below it got covered */
+        if ( NULL != scoring && NULL != scoring->hits ) transactUpdateScores(txn, node);
+        break;
+      }
+    }
+  }
+  stackFree(nodeStack);
+  free(nodeStack);
+
+  int logSize = stackSize(txn->undoLog);
+  UndoRecord* log = (UndoRecord*)malloc(sizeof(UndoRecord) * (logSize + 1));
+  assert(NULL != log);
+  for ( i = logSize - 1; i >= 0; i-- ) {
+    stackPop(txn->undoLog, &log[i].entry);
+    log[i].seq = i;
+  }
+  qsort(log, logSize, sizeof(UndoRecord), compareUndoByNode);
+  int unique = 0;
+  for ( i = 0; i < logSize; i++ ) {
+    if ( 0 == i || log[i].entry.node != log[i - 1].entry.node ) log[unique++] = log[i];
+  }
+  qsort(log, unique, sizeof(UndoRecord), compareUndoBySeq);
+
+  int count = 0;
+  CDGChange change;
+  for ( i = 0; i < unique; i++ ) {
+    node = log[i].entry.node;
+    if ( log[i].entry.score == getScore(node) && log[i].entry.outcome == getOutcome(node)
+         && log[i].entry.flags == getFlags(node) ) continue;
+    if ( count < capacity ) {
+      change.node = node;
+      change.id = getID(node);
+      change.kind = isLeaf(node) ? CDG_CHANGE_LEAF : CDG_CHANGE_DECISION;
+      change.oldScore = log[i].entry.score;
+      change.newScore = getScore(node);
+      change.oldOutcome = log[i].entry.outcome;
+      change.newOutcome = getOutcome(node);
+      changes[count] = change;
+    }
+    count++;
+  }
+  free(log);
+  commitTransaction(txn);
+  return count;
+}
+
 CDGPath* setPathNode(CDGPath* path, CDGNode* node) {
   assert(NULL != path);
   path->node = node;
@@ -438,7 +699,7 @@ CDGPath* setNextPath(CDGPath* path, CDGPath* nextPath) {
 
 CDGPath* newPath() {
   CDGPath* path;
-  path = (CDGPath*)malloc(sizeof(CDGPath*));
+  path = (CDGPath*)malloc(sizeof(CDGPath));
   assert(NULL != path);
   setPathNode(path, NULL);
   setNextPath(path, NULL);
@@ -458,26 +719,64 @@ CDGPath* getNextPath(CDGPath* path) {
 CDGNode* copyToPathNode(CDGNode* pathNode, CDGNode* node) {
   assert(NULL != pathNode);
   setID(pathNode, getID(node));
-  setExpr(pathNode, getExpr(node));
+  if ( NULL != getPredicate(node) ) {
+    setPredicate(pathNode, getPredicate(node));
+  } else {
+    setExpr(pathNode, getExpr(node));
+  }
   setOutcome(pathNode, getOutcome(node));
   return pathNode;
 }
 
-CDGNode* getTopPath(CDGNode* node, Stack* changedNodes) {
+/* CDGPathWalk - State of a getTopPath walk
+ * @scoring - Scoring of the transaction, NULL for plain coverage
+ * @cores - Infeasible cores of the scoring, NULL if none
+ * @decisions - Branches already on the path, only kept with cores
+ * @fingerprint - Fingerprint of the decisions of the path so far */
+
+typedef struct CDGPathWalk {
+  CDGScoring* scoring;
+  CDGCores* cores;
+  CDGBranchSet decisions;
+  unsigned long long fingerprint;
+} CDGPathWalk;
+
+/* Outcome to take at a decision of a path, given the branches already on it. -1 if both
+   branches complete an infeasible core or the free one has no score */
+
+int chooseFreeBranch(CDGPathWalk* walk, CDGNode* node) {
+  int outcome = getOutcome(node);
+  if ( NULL == walk->cores ) return outcome;
+  if ( completesCore(walk->cores, &walk->decisions, getID(node), outcome) ) {
+    outcome = !outcome;
+    if ( 0 == scoreBranch(node, outcome, isConditionalLeaf(node), walk->scoring) ) return -1;
+    if ( completesCore(walk->cores, &walk->decisions, getID(node), outcome) ) return -1;
+  }
+  addBranch(&walk->decisions, getID(node), outcome);
+  return outcome;
+}
+
+CDGNode* walkPath(CDGNode* node, CDGTransaction* txn, CDGPathWalk* walk) {
   CDGNode* pathNode = newBlankNode();
   CDGNode* temp = pathNode;
+  int outcome;
   while (node) {
     if ( 0 != getScore(node) ) {
       if ( isLeaf(node) ) {
-        setScore(node, 0);
-        stackPush(changedNodes, &node);
+        transactSetScore(txn, node, 0);
       } else {
-        setNextNode(temp, copyToPathNode(newBlankNode(), node));
-        temp = getNextNode(temp);        
-        if (getOutcome(node)) {
-          setTrueNodeSet(temp, getTopPath(getTrueNodeSet(node), changedNodes));
-        } else {
-          setFalseNodeSet(temp, getTopPath(getFalseNodeSet(node), changedNodes));
+        outcome = chooseFreeBranch(walk, node);
+        if ( 0 <= outcome ) {
+          setNextNode(temp, copyToPathNode(newBlankNode(), node));
+          temp = getNextNode(temp);
+          setOutcome(temp, outcome);
+          walk->fingerprint = addToFingerprint(walk->fingerprint, getID(node), outcome);
+          if (outcome) {
+            setTrueNodeSet(temp, walkPath(getTrueNodeSet(node), txn, walk));
+          } else {
+            setFalseNodeSet(temp, walkPath(getFalseNodeSet(node), txn, walk));
+          }
+          transactCoverImplicit(txn, node, outcome);
         }
       }
     }
@@ -494,14 +793,52 @@ CDGNode* getTopPath(CDGNode* node, Stack* changedNodes) {
   return pathNode;
 }
 
+CDGNode* getTopPathFingerprint(CDGNode* node, CDGTransaction* txn, unsigned long long* fingerprint) {
+  CDGPathWalk walk;
+  walk.scoring = txn->scoring;
+  walk.cores = NULL != txn->scoring ? txn->scoring->cores : NULL;
+  newBranchSet(&walk.decisions);
+  walk.fingerprint = CDG_FINGERPRINT_BASIS;
+  CDGNode* path = walkPath(node, txn, &walk);
+  deleteBranchSet(&walk.decisions);
+  if ( NULL != fingerprint ) *fingerprint = walk.fingerprint;
+  return path;
+}
+
+CDGNode* getTopPath(CDGNode* node, CDGTransaction* txn) {
+  return getTopPathFingerprint(node, txn, NULL);
+}
+
+unsigned long long addToFingerprint(unsigned long long fingerprint, int id, int outcome) {
+  fingerprint ^= (unsigned long long)(unsigned int)id << 1 | (0 != outcome);
+  fingerprint *= 0x9E3779B97F4A7C15ULL;
+  return fingerprint ^ (fingerprint >> 32);
+}
+
+unsigned long long addPathToFingerprint(unsigned long long fingerprint, CDGNode* path) {
+  for ( ; path; path = getNextNode(path) ) {
+    fingerprint = addToFingerprint(fingerprint, getID(path), getOutcome(path));
+    fingerprint = addPathToFingerprint(fingerprint, getOutcome(path) ? getTrueNodeSet(path) : getFalseNodeSet(path));
+  }
+  return fingerprint;
+}
+
+unsigned long long getPathFingerprint(CDGNode* path) {
+  return addPathToFingerprint(CDG_FINGERPRINT_BASIS, path);
+}
+
 CDGPath* getTopPaths(CDGNode* root, int numberOfPaths) {
+  return getTopPathsWith(root, numberOfPaths, NULL);
+}
+
+CDGPath* getTopPathsWith(CDGNode* root, int numberOfPaths, CDGScoring* scoring) {
   CDGPath* pathHead = NULL;
   CDGNode* path;
   CDGPath* currPath;
-  CDGNode* node;
-  Stack* changedNodes = stackNew(sizeof(CDGNode*));
-  while ( numberOfPaths-- ) {
-    path = getTopPath(root, changedNodes);
+  int remaining = numberOfPaths;
+  CDGTransaction* txn = beginTransactionWith(scoring);
+  while ( remaining-- ) {
+    path = getTopPath(root, txn);
     if ( NULL == path ) break;
     if ( NULL == pathHead ) {
       pathHead = setPathNode(newPath(), path);
@@ -510,23 +847,19 @@ CDGPath* getTopPaths(CDGNode* root, int numberOfPaths) {
       setNextPath(currPath, setPathNode(newPath(), path));
       currPath = getNextPath(currPath);
     }
-    updateCDG(root);
-  }
-  while ( !stackIsEmpty(changedNodes) ) {
-    stackPop(changedNodes, &node);    
-    setScore(node, 1);
   }
-  updateCDG(root);
-  stackFree(changedNodes);
+  rollbackTransaction(txn);
+  if ( getTraceRecorder() ) traceTopPaths(getTraceRecorder(), root, numberOfPaths, pathHead);
   return pathHead;
 }
 
 void deletePaths(CDGPath* path) {
   assert(NULL != path);
+  if ( getTraceRecorder() ) traceDeletePaths(getTraceRecorder(), path);
   CDGPath* next;
   do {
     next = getNextPath(path);
-    deleteNodeList(getPathNode(path));
+    deleteNodeTree(getPathNode(path));
     setNextPath(path, NULL);
     free(path);
     path = next;
@@ -537,9 +870,9 @@ CDGNode* addDummyNodes(CDGNode* node) {
   while(node) {
     if ( !isLeaf(node) ) {
       if ( NULL == getTrueNodeSet(node)) {
-        addTrueNode(node, newBlankNode());        
+        setFlags(node, getFlags(node) | CDG_IMPLICIT_TRUE);
       } else if ( NULL == getFalseNodeSet(node) ) {
-        addFalseNode(node, newBlankNode());
+        setFlags(node, getFlags(node) | CDG_IMPLICIT_FALSE);
       }
     }
     addDummyNodes(getTrueNodeSet(node));
@@ -578,7 +911,9 @@ CDGNode* buildFeasiblePath(CDGNode* node, CDGNode* list) {
 }
 
 CDGNode* getFeasiblePath(CDGNode* path, CDGNode* list) {
-  return buildFeasiblePath(path, list);
+  CDGNode* feasiblePath = buildFeasiblePath(path, list);
+  if ( getTraceRecorder() ) traceFeasiblePath(getTraceRecorder(), path, list, feasiblePath);
+  return feasiblePath;
 }
 
 int getPathLength(CDGNode* node) {
@@ -4,27 +4,44 @@
 #include <stdlib.h>
 #include "stack.h"
 
+#ifdef __cplusplus
+extern "C" {
+#endif
+
 /* CDGNode - Holds info about a CDG Node
  * @id - Statement id for decision statement and block id for others
  * @score - Metric used to represent the number of uncovered branches
  * @outcome - True/False depending upon the outcome to choose (only used when node is part of path)
  * @expr - Predicate of decision statement, NULL for others
+ * @predicate - Shared parsed form of expr, which then belongs to it, NULL if none
+ *              (see cdgPredicates.h)
  * @trueNodeSet - Set of CDG nodes on the "true" evaluation side of current node
  * @falseNodeSet - Set of CDG nodes on the "false" evaluation side of current node
  * @parent - Parent of current node
- * @next - Next CDG node in the node list */
+ * @next - Next CDG node in the node list
+ * @flags - CDG_IMPLICIT_TRUE / CDG_IMPLICIT_FALSE if the trueNodeSet / falseNodeSet holds an
+ *          implicit uncovered empty block (see addDummyNodes). Cleared once it is covered */
 
 typedef struct CDGNode {
   int id;
   int score;
   int outcome;
+  int flags;
   char* expr;
+  struct CDGPredicate* predicate;
   struct CDGNode* trueNodeSet;
   struct CDGNode* falseNodeSet;
   struct CDGNode* parent;
   struct CDGNode* next;        
 } CDGNode;
 
+#define CDG_IMPLICIT_TRUE 0x1
+#define CDG_IMPLICIT_FALSE 0x2
+
+/* CDG_IMPLICIT - Flag of the implicit empty block on the side of an outcome */
+
+#define CDG_IMPLICIT(outcome) ((outcome) ? CDG_IMPLICIT_TRUE : CDG_IMPLICIT_FALSE)
+
 
 /* newNode - Creates and initializes a new CDG node to parameters specified and returns the same node */
 
@@ -37,6 +54,9 @@ CDGNode* newNode(int id, int score, int outcome, const char* expr, CDGNode* true
 CDGNode* newBlankNode();
 
 /* addDummyNodes - Attaches dummy nodes to the decision nodes and return the root pointer back
+ *               - A decision node missing its trueNodeSet or falseNodeSet gets an implicit
+ *                 uncovered empty block on that side, a flag bit instead of a node. It
+ *                 scores, covers and ends paths the same as a blank leaf would
  * @root - root of the tree */
 
 CDGNode* addDummyNodes(CDGNode* root);
@@ -84,6 +104,17 @@ int getOutcome(CDGNode* node);
 
 CDGNode* setOutcome(CDGNode* node, int outcome);
 
+/* getFlags - Returns the flags of a CDG node
+ * @node - CDG Node */
+
+int getFlags(CDGNode* node);
+
+/* setFlags - Sets the flags of a CDG node and returns the same node
+ * @node - CDG Node
+ * @flags - Flags to set */
+
+CDGNode* setFlags(CDGNode* node, int flags);
+
 
 /* getExpr - Returns the predicate if the node represents a decision node else NULL
  * @node - a CDG node */
@@ -97,6 +128,24 @@ char* getExpr(CDGNode* node);
 
 CDGNode* setExpr(CDGNode* node, const char* expr);
 
+/* getPredicate - Returns the shared predicate of a node, NULL if none
+ * @node - a CDG node */
+
+struct CDGPredicate* getPredicate(CDGNode* node);
+
+/* setPredicate - Makes a node share a predicate, taking a reference to it, and returns the
+ *                same node. The expr of the node becomes that of the predicate
+ * @node - a CDG node
+ * @predicate - a predicate */
+
+CDGNode* setPredicate(CDGNode* node, struct CDGPredicate* predicate);
+
+/* getParsedPredicate - Returns the parsed form of the predicate of a node, NULL if it has no
+ *                      shared predicate
+ * @node - a CDG node */
+
+void* getParsedPredicate(CDGNode* node);
+
 
 /* getTrueNodeSet - Return trueNodeSet of a CDG node
  * @node - a CDG node */
@@ -109,6 +158,18 @@ CDGNode* getTrueNodeSet(CDGNode* node);
 
 CDGNode* getFalseNodeSet(CDGNode* node);
 
+/* setTrueNodeSet - Replaces the trueNodeSet of a CDG node and returns the same node
+ * @node - a CDG node
+ * @trueNodeSet - Head of the new set */
+
+CDGNode* setTrueNodeSet(CDGNode* node, CDGNode* trueNodeSet);
+
+/* setFalseNodeSet - Replaces the falseNodeSet of a CDG node and returns the same node
+ * @node - a CDG node
+ * @falseNodeSet - Head of the new set */
+
+CDGNode* setFalseNodeSet(CDGNode* node, CDGNode* falseNodeSet);
+
 /* addTrueNode - Adds a CDG node to the trueNodeSet of a CDG node and returns the
  *               node to whose trueNodeSet the node was added
  * @node - CDG Node to whose trueNodeSet the node is to be added
@@ -146,6 +207,21 @@ CDGNode* getNextNode(CDGNode* node);
 
 CDGNode* setNextNode(CDGNode* node, CDGNode* next);
 
+/* isLeaf - Returns 1 if the node has neither trueNodeSet nor falseNodeSet, 0 otherwise
+ * @node - a CDG node */
+
+int isLeaf(CDGNode* node);
+
+/* CDGScoring - How the branches of a CDG are scored beyond plain coverage. A CDG handle owns
+ *              one (see cdgGraph.h), the functions without a scoring use none
+ * @hits - Hit counters weighting the branches (see cdgHits.h), NULL to weigh each branch 1
+ * @cores - Infeasible cores blocking branches (see cdgCores.h), NULL to block none */
+
+typedef struct CDGScoring {
+  struct CDGHitCounts* hits;
+  struct CDGCores* cores;
+} CDGScoring;
+
 /* updateScore - Sets the score of node to the max of sum of scores of trueNodeSet
  *               and falseNodeSet
  *               This function assumes that scores of all nodes in trueNodeSet and
@@ -155,6 +231,25 @@ CDGNode* setNextNode(CDGNode* node, CDGNode* next);
 
 CDGNode* updateScore(CDGNode* node);
 
+/* updateScoreWith - Same as updateScore, scoring the branches of the node with a scoring
+ * @node - a CDG node
+ * @scoring - Scoring of the CDG, NULL for plain coverage */
+
+CDGNode* updateScoreWith(CDGNode* node, CDGScoring* scoring);
+
+/* getConditionalNodeSum - Returns the sum of scores of the decision nodes in a node list.
+ *                         For a CDG root this is the score of its top path
+ * @node - Head of the node list */
+
+int getConditionalNodeSum(CDGNode* node);
+
+/* hasUncoveredChild - Returns 1 if a branch of a decision node leads to a leaf with a score
+ *                     or to an uncovered implicit block, 0 otherwise
+ * @node - a decision node
+ * @branch - 1 for the trueNodeSet, 0 for the falseNodeSet */
+
+int hasUncoveredChild(CDGNode* node, int branch);
+
 /* updateCDG - Updates the score of all the nodes of a tree rooted at the 'node'
  *             using updateScore function by traversing in bottom-up fashion
  *           - Returns the same CDG node
@@ -162,6 +257,12 @@ CDGNode* updateScore(CDGNode* node);
 
 CDGNode* updateCDG(CDGNode* node);
 
+/* updateCDGWith - Same as updateCDG, scoring every node with a scoring
+ * @node - a CDG node
+ * @scoring - Scoring of the CDG, NULL for plain coverage */
+
+CDGNode* updateCDGWith(CDGNode* node, CDGScoring* scoring);
+
 /* coverNodes - Sets score of basic blocks which are immediate child on outcome side of
  *              nodes in the array to 0 .
  * @root - Root of CDG
@@ -170,11 +271,120 @@ CDGNode* updateCDG(CDGNode* node);
 
 void coverNodes(CDGNode* root, CDGNode* nodes[], int size);
 
+/* coverNodesWith - Same as coverNodes for a CDG scored with a scoring, also recording a hit
+ *                  for each node in its hit counters if it has any
+ * @root - Root of CDG
+ * @nodes - Array of CDGNodes. Will have id and outcome set
+ * @size - Size of array
+ * @scoring - Scoring of the CDG, NULL for plain coverage */
+
+void coverNodesWith(CDGNode* root, CDGNode* nodes[], int size, CDGScoring* scoring);
+
 /* deleteCDG - Deletes all the nodes in the CDG
  * @root - Root of CDG */
 
 void deleteCDG(CDGNode* root);
 
+/* CDGUndoEntry - State of a CDG node before a speculative edit
+ * @node - The edited node
+ * @score - Score of the node before the edit
+ * @outcome - Outcome of the node before the edit
+ * @flags - Flags of the node before the edit */
+
+typedef struct CDGUndoEntry {
+  struct CDGNode* node;
+  int score;
+  int outcome;
+  int flags;
+} CDGUndoEntry;
+
+/* CDGTransaction - Speculative score edits on a CDG which can be committed or rolled back
+ * @undoLog - Stack of CDGUndoEntry, one per node state change, latest on top
+ * @scoring - Scoring the edited nodes are rescored and the paths are built with, NULL for
+ *            plain coverage */
+
+typedef struct CDGTransaction {
+  Stack* undoLog;
+  CDGScoring* scoring;
+} CDGTransaction;
+
+/* beginTransaction - Creates and returns a new transaction with an empty undo log */
+
+CDGTransaction* beginTransaction();
+
+/* beginTransactionWith - Same as beginTransaction, rescoring with a scoring
+ * @scoring - Scoring of the CDG, NULL for plain coverage. Must outlive the transaction */
+
+CDGTransaction* beginTransactionWith(CDGScoring* scoring);
+
+/* transactSetScore - Sets the score of a node within a transaction and returns the same node
+ *                  - Scores and outcomes of the ancestors are updated incrementally, stopping
+ *                    at the first ancestor whose score does not change. Every changed node is
+ *                    recorded in the undo log
+ *                  - Assumes the scores of the CDG are up to date (see updateCDG)
+ * @txn - a transaction
+ * @node - a CDG node
+ * @score - Score to set */
+
+CDGNode* transactSetScore(CDGTransaction* txn, CDGNode* node, int score);
+
+/* transactCoverImplicit - Covers the implicit empty block on one side of a decision node within
+ *                        a transaction and updates the node and its ancestors like
+ *                        transactSetScore does for a leaf
+ * @txn - a transaction
+ * @node - a decision node
+ * @outcome - Side of the implicit block */
+
+CDGNode* transactCoverImplicit(CDGTransaction* txn, CDGNode* node, int outcome);
+
+/* commitTransaction - Keeps all the edits made within the transaction and frees it
+ * @txn - a transaction */
+
+void commitTransaction(CDGTransaction* txn);
+
+/* rollbackTransaction - Restores the exact scores, outcomes and flags the edited nodes had when the
+ *                       transaction began and frees it. Runs in O(number of edits)
+ * @txn - a transaction */
+
+void rollbackTransaction(CDGTransaction* txn);
+
+#define CDG_CHANGE_DECISION 0
+#define CDG_CHANGE_LEAF 1
+
+/* CDGChange - Change of a node made by a coverage update
+ * @node - The changed node
+ * @id - Id of the node
+ * @kind - CDG_CHANGE_LEAF for a newly covered leaf, CDG_CHANGE_DECISION for a decision node
+ *         whose score, outcome or implicit blocks changed
+ * @oldScore - Score before the update
+ * @newScore - Score after the update
+ * @oldOutcome - Outcome before the update
+ * @newOutcome - Outcome after the update */
+
+typedef struct CDGChange {
+  struct CDGNode* node;
+  int id;
+  int kind;
+  int oldScore;
+  int newScore;
+  int oldOutcome;
+  int newOutcome;
+} CDGChange;
+
+/* coverNodesWithChanges - Same as coverNodesWith but rescores only the ancestors of the covered
+ *                         leaves and reports what changed, in the order the nodes were first
+ *                         changed. Assumes the scores of the CDG are up to date
+ *                       - Returns the total number of changes, of which only the first
+ *                         capacity are written to changes. 0 means nothing changed
+ * @root - Root of CDG
+ * @nodes - Array of CDGNodes. Will have id and outcome set
+ * @size - Size of array
+ * @changes - Caller provided buffer for the changes. May be NULL if capacity is 0
+ * @capacity - Number of changes the buffer can hold
+ * @scoring - Scoring of the CDG, NULL for plain coverage */
+
+int coverNodesWithChanges(CDGNode* root, CDGNode* nodes[], int size, CDGChange changes[], int capacity, CDGScoring* scoring);
+
 /* CDGPath - List of CDG paths
  * @node - CDG node - This node will only have id, expr and next
  *         everything else will be either NULL or 0
@@ -185,6 +395,22 @@ typedef struct CDGPath {
   struct CDGPath* next;
 } CDGPath;
 
+/* newPath - Creates and returns an empty CDG path */
+
+CDGPath* newPath();
+
+/* setPathNode - Sets the head CDG node of a path and returns the same path
+ * @path - a CDG path
+ * @node - Head node of the path */
+
+CDGPath* setPathNode(CDGPath* path, CDGNode* node);
+
+/* setNextPath - Links the next CDG path and returns the same path
+ * @path - a CDG path
+ * @nextPath - Next CDG path */
+
+CDGPath* setNextPath(CDGPath* path, CDGPath* nextPath);
+
 /* getPathNode - Returns the head CDG node of a path
  * @path - a CDG path */
 
@@ -195,12 +421,76 @@ CDGNode* getPathNode(CDGPath* path);
 
 CDGPath* getNextPath(CDGPath* path);
 
+/* copyToPathNode - Copies id, predicate and outcome of a node into a path node. A shared
+ *                  predicate is shared with the path node rather than copied
+ * @pathNode - Node of a path
+ * @node - CDG node */
+
+CDGNode* copyToPathNode(CDGNode* pathNode, CDGNode* node);
+
+/* getTopPath - Returns the top path of a CDG and sets the score of the leaves it
+ *              covers to 0 within the transaction. Returns NULL if nothing is left to cover.
+ *              With infeasible cores in the scoring of the transaction, no decision of the
+ *              path completes a core with the others (see cdgCores.h)
+ * @node - CDG root node
+ * @txn - Transaction recording the covered leaves */
+
+CDGNode* getTopPath(CDGNode* node, CDGTransaction* txn);
+
+/* CDG_FINGERPRINT_BASIS - Fingerprint of the empty path */
+
+#define CDG_FINGERPRINT_BASIS 14695981039346656037ULL
+
+/* getTopPathFingerprint - Same as getTopPath, also computing the fingerprint of the path
+ *                         (see getPathFingerprint) while building it
+ * @node - CDG root node
+ * @txn - Transaction recording the covered leaves
+ * @fingerprint - Set to the fingerprint of the path. May be NULL */
+
+CDGNode* getTopPathFingerprint(CDGNode* node, CDGTransaction* txn, unsigned long long* fingerprint);
+
+/* addToFingerprint - Returns a fingerprint extended by one decision
+ * @fingerprint - Fingerprint of the decisions before, CDG_FINGERPRINT_BASIS if none
+ * @id - Id of the decision
+ * @outcome - Outcome of the decision */
+
+unsigned long long addToFingerprint(unsigned long long fingerprint, int id, int outcome);
+
+/* getPathFingerprint - Returns the 64 bit fingerprint of the (id, outcome) decisions of a path
+ *                      taken in the order getTopPath adds them. Within a CDG the sequence
+ *                      identifies the path, so equal paths have equal fingerprints
+ * @path - Head node of the path */
+
+unsigned long long getPathFingerprint(CDGNode* path);
+
 /* getTopPaths - Returns list of score-wise top paths of a CDG
+ *             - Paths are explored within a transaction which is rolled back before
+ *               returning, so the scores of the CDG are left untouched
  * @node - CDG root node
  * @numberOfPaths - Maximum number of paths to be returned */
 
 CDGPath* getTopPaths(CDGNode* node, int numberOfPaths);
 
+/* getTopPathsWith - Same as getTopPaths for a CDG scored with a scoring
+ * @node - CDG root node
+ * @numberOfPaths - Maximum number of paths to be returned
+ * @scoring - Scoring of the CDG, NULL for plain coverage */
+
+CDGPath* getTopPathsWith(CDGNode* node, int numberOfPaths, CDGScoring* scoring);
+
+/* findNode - Returns the first node with the id reachable from a node list in depth first order,
+ *            NULL if there is none
+ * @node - Head of the node list
+ * @id - Id to look up */
+
+CDGNode* findNode(CDGNode* node, int id);
+
+/* nodeExists - Returns 1 if a node with the id is reachable from a node list, 0 otherwise
+ * @node - Head of the node list
+ * @id - Id to look up */
+
+int nodeExists(CDGNode* node, int id);
+
 /* getFeasiblePath - Returns the longest path possible with given conditions satisfied
  * @path - Path from which the conditions were extracted
  * @nodeList - List of nodes which were satfisfied (Necessary Params : id, outcome, next ) */
@@ -212,9 +502,13 @@ CDGNode* getFeasiblePath(CDGNode* path, CDGNode* nodeList);
 
 int getPathLength(CDGNode* path);
 
-/* deletePaths - Deallocates memory allocated to path list
+/* deletePaths - Deallocates memory allocated to path list, the whole tree of every path
  * @path - a path head */
 
 void deletePaths(CDGPath* path);
 
+#ifdef __cplusplus
+}
+#endif
+
 #endif
@@ -0,0 +1,394 @@
+#ifndef CDG_HPP
+#define CDG_HPP
+
+#include <cassert>
+#include <cstdint>
+#include <cstdlib>
+#include <iterator>
+#include <utility>
+#include <vector>
+#include "cdg.h"
+#include "cdgCompact.h"
+
+/* C++ layer
+ *
+ * Header only C++17 wrappers over the C API. Nodes are light value types parameterised on
+ * their storage, whose accessors read the node memory directly so that loops over sibling
+ * and child sets inline completely instead of calling the out of line accessors of cdg.c.
+ * Cdg, Path and PathSet are move only owners which release their C objects on destruction.
+ *
+ * Everything converts to and from the C types: node.c() returns the CDGNode* accepted by
+ * the C API (a tagged handle for compact nodes), and every owner can adopt or release() the
+ * C object it holds */
+
+namespace cdg {
+
+/* PointerStorage - Storage of a CDG made of CDGNodes. A handle is the node itself */
+
+struct PointerStorage {
+  typedef CDGNode* Handle;
+
+  static Handle null() { return nullptr; }
+  static bool isNull(Handle h) { return nullptr == h; }
+  static Handle fromC(CDGNode* node) { assert(!isCompactNode(node)); return node; }
+  static CDGNode* c(Handle h) { return h; }
+  static int id(Handle h) { return h->id; }
+  static int score(Handle h) { return h->score; }
+  static bool outcome(Handle h) { return 0 != h->outcome; }
+  static int flags(Handle h) { return h->flags; }
+  static const char* expr(Handle h) { return h->expr; }
+  static bool isLeaf(Handle h) { return nullptr == h->trueNodeSet && nullptr == h->falseNodeSet; }
+  static Handle trueSet(Handle h) { return h->trueNodeSet; }
+  static Handle falseSet(Handle h) { return h->falseNodeSet; }
+  static Handle parent(Handle h) { return h->parent; }
+  static Handle next(Handle h) { return h->next; }
+};
+
+/* CompactStorage - Storage of a compact CDG. A handle is the store and the index of a node,
+ * resolved once from the tagged CDGNode* so that the accessors skip the store registry */
+
+struct CompactStorage {
+  struct Handle {
+    const CDGCompactStore* store;
+    unsigned int index;
+  };
+
+  static Handle null() { return Handle{nullptr, 0}; }
+  static bool isNull(Handle h) { return 0 == h.index; }
+  static Handle fromC(CDGNode* node) {
+    if ( nullptr == node ) return null();
+    assert(isCompactNode(node));
+    return Handle{getCompactStore(node), (unsigned int)((uintptr_t)node >> COMPACT_INDEX_SHIFT)};
+  }
+  static CDGNode* c(Handle h) {
+    if ( isNull(h) ) return nullptr;
+    return (CDGNode*)(((uintptr_t)h.index << COMPACT_INDEX_SHIFT) | ((uintptr_t)h.store->storeId << 1) | 1);
+  }
+  static const CDGCompactNode& node(Handle h) { return h.store->nodes[h.index]; }
+  static int id(Handle h) { return node(h).id; }
+  static int score(Handle h) { return (int)(node(h).bits >> COMPACT_SCORE_SHIFT); }
+  static bool outcome(Handle h) { return 0 != (node(h).bits & COMPACT_OUTCOME); }
+  static int flags(Handle h) { return (int)(node(h).bits >> COMPACT_IMPLICIT_SHIFT) & (CDG_IMPLICIT_TRUE | CDG_IMPLICIT_FALSE); }
+  static const char* expr(Handle h) { return getInternedString(h.store->strings, h.store->exprs[h.index]); }
+  static bool isLeaf(Handle h) { return 0 != (node(h).bits & COMPACT_LEAF); }
+  static Handle at(Handle h, unsigned int index) { return Handle{h.store, index}; }
+  static Handle trueSet(Handle h) {
+    if ( !(node(h).bits & COMPACT_HAS_TRUE) ) return null();
+    return at(h, node(h).children);
+  }
+  static Handle falseSet(Handle h) {
+    unsigned int bits = node(h).bits;
+    if ( !(bits & COMPACT_HAS_FALSE) ) return null();
+    if ( !(bits & COMPACT_HAS_TRUE) ) return at(h, node(h).children);
+    unsigned int trueCnt = (bits >> COMPACT_TRUE_CNT_SHIFT) & COMPACT_TRUE_CNT_MASK;
+    if ( COMPACT_TRUE_CNT_MASK > trueCnt ) return at(h, node(h).children + trueCnt);
+    unsigned int index = node(h).children;
+    while ( !(h.store->nodes[index].bits & COMPACT_LAST) ) index++;
+    return at(h, index + 1);
+  }
+  static Handle parent(Handle h) { return at(h, node(h).parent); }
+  static Handle next(Handle h) {
+    if ( node(h).bits & COMPACT_LAST ) return null();
+    return at(h, h.index + 1);
+  }
+};
+
+template <class Storage> class BasicNodeSet;
+
+/* BasicNode - Read only view of a CDG node. A default constructed node is null */
+
+template <class Storage>
+class BasicNode {
+ public:
+  typedef typename Storage::Handle Handle;
+
+  BasicNode() : handle(Storage::null()) {}
+  explicit BasicNode(Handle handle) : handle(handle) {}
+  static BasicNode fromC(CDGNode* node) { return BasicNode(Storage::fromC(node)); }
+
+  explicit operator bool() const { return !Storage::isNull(handle); }
+  CDGNode* c() const { return Storage::c(handle); }
+  Handle get() const { return handle; }
+
+  int id() const { return Storage::id(handle); }
+  int score() const { return Storage::score(handle); }
+  bool outcome() const { return Storage::outcome(handle); }
+  const char* expr() const { return Storage::expr(handle); }
+  bool isLeaf() const { return Storage::isLeaf(handle); }
+  int flags() const { return Storage::flags(handle); }
+  /* True if the side holds an uncovered implicit empty block, see addDummyNodes */
+  bool hasImplicit(bool side) const { return 0 != (flags() & CDG_IMPLICIT(side)); }
+  BasicNode parent() const { return BasicNode(Storage::parent(handle)); }
+  BasicNode next() const { return BasicNode(Storage::next(handle)); }
+
+  /* Sibling sets on each side, and on the side of the outcome of the node */
+  BasicNodeSet<Storage> trueSet() const { return BasicNodeSet<Storage>(Storage::trueSet(handle)); }
+  BasicNodeSet<Storage> falseSet() const { return BasicNodeSet<Storage>(Storage::falseSet(handle)); }
+  BasicNodeSet<Storage> children(bool side) const { return side ? trueSet() : falseSet(); }
+  BasicNodeSet<Storage> chosen() const { return children(outcome()); }
+
+  /* The node and its next siblings */
+  BasicNodeSet<Storage> siblings() const { return BasicNodeSet<Storage>(handle); }
+
+  bool operator==(const BasicNode& other) const { return c() == other.c(); }
+  bool operator!=(const BasicNode& other) const { return c() != other.c(); }
+
+ private:
+  Handle handle;
+};
+
+/* BasicNodeSet - Range over a sibling list, following next */
+
+template <class Storage>
+class BasicNodeSet {
+ public:
+  typedef BasicNode<Storage> Node;
+
+  class iterator {
+   public:
+    typedef std::forward_iterator_tag iterator_category;
+    typedef Node value_type;
+    typedef std::ptrdiff_t difference_type;
+    typedef const Node* pointer;
+    typedef Node reference;
+
+    iterator() {}
+    explicit iterator(Node node) : node(node) {}
+    Node operator*() const { return node; }
+    const Node* operator->() const { return &node; }
+    iterator& operator++() { node = node.next(); return *this; }
+    iterator operator++(int) { iterator old = *this; node = node.next(); return old; }
+    bool operator==(const iterator& other) const { return node == other.node; }
+    bool operator!=(const iterator& other) const { return node != other.node; }
+
+   private:
+    Node node;
+  };
+
+  BasicNodeSet() {}
+  explicit BasicNodeSet(typename Storage::Handle head) : first(head) {}
+
+  iterator begin() const { return iterator(first); }
+  iterator end() const { return iterator(); }
+  bool empty() const { return !first; }
+  Node head() const { return first; }
+
+ private:
+  Node first;
+};
+
+typedef BasicNode<PointerStorage> Node;
+typedef BasicNode<CompactStorage> CompactNode;
+typedef BasicNodeSet<PointerStorage> NodeSet;
+typedef BasicNodeSet<CompactStorage> CompactNodeSet;
+
+/* conditionalSum - Same as getConditionalNodeSum */
+
+template <class Storage>
+inline int conditionalSum(BasicNodeSet<Storage> set) {
+  int sum = 0;
+  for ( BasicNode<Storage> node : set ) {
+    if ( !node.isLeaf() ) sum += node.score();
+  }
+  return sum;
+}
+
+/* hasUncoveredLeaf - Returns true if a leaf of the set has a non zero score. Implicit blocks
+ * belong to the parent of the set, see BasicNode::hasImplicit */
+
+template <class Storage>
+inline bool hasUncoveredLeaf(BasicNodeSet<Storage> set) {
+  for ( BasicNode<Storage> node : set ) {
+    if ( node.isLeaf() && 0 < node.score() ) return true;
+  }
+  return false;
+}
+
+/* countNodes - Returns the number of nodes reachable from a set, same as getPathLength */
+
+template <class Storage>
+inline int countNodes(BasicNodeSet<Storage> set) {
+  int count = 0;
+  for ( BasicNode<Storage> node : set ) {
+    count += 1 + countNodes(node.trueSet()) + countNodes(node.falseSet());
+  }
+  return count;
+}
+
+/* Path - Owner of a single path built by the C API (getTopPath, getFeasiblePath, ...) */
+
+class Path {
+ public:
+  Path() : root(nullptr) {}
+  explicit Path(CDGNode* root) : root(root) { assert(!isCompactNode(root)); }
+  Path(Path&& other) noexcept : root(other.release()) {}
+  Path& operator=(Path&& other) noexcept {
+    if ( this != &other ) reset(other.release());
+    return *this;
+  }
+  Path(const Path&) = delete;
+  Path& operator=(const Path&) = delete;
+  ~Path() { reset(nullptr); }
+
+  explicit operator bool() const { return nullptr != root; }
+  Node head() const { return Node(root); }
+  NodeSet nodes() const { return NodeSet(root); }
+  CDGNode* get() const { return root; }
+  CDGNode* release() { CDGNode* out = root; root = nullptr; return out; }
+  void reset(CDGNode* node) {
+    if ( root ) deleteCDG(root);
+    root = node;
+  }
+
+ private:
+  CDGNode* root;
+};
+
+/* PathSet - Owner of a list of paths returned by getTopPaths. Iterates over the head node of
+ * each path */
+
+class PathSet {
+ public:
+  class iterator {
+   public:
+    typedef std::forward_iterator_tag iterator_category;
+    typedef Node value_type;
+    typedef std::ptrdiff_t difference_type;
+    typedef const Node* pointer;
+    typedef Node reference;
+
+    iterator() : path(nullptr) {}
+    explicit iterator(CDGPath* path) : path(path) {}
+    Node operator*() const { return Node(path->node); }
+    iterator& operator++() { path = path->next; return *this; }
+    iterator operator++(int) { iterator old = *this; path = path->next; return old; }
+    bool operator==(const iterator& other) const { return path == other.path; }
+    bool operator!=(const iterator& other) const { return path != other.path; }
+
+   private:
+    CDGPath* path;
+  };
+
+  PathSet() : paths(nullptr) {}
+  explicit PathSet(CDGPath* paths) : paths(paths) {}
+  PathSet(PathSet&& other) noexcept : paths(other.release()) {}
+  PathSet& operator=(PathSet&& other) noexcept {
+    if ( this != &other ) reset(other.release());
+    return *this;
+  }
+  PathSet(const PathSet&) = delete;
+  PathSet& operator=(const PathSet&) = delete;
+  ~PathSet() { reset(nullptr); }
+
+  iterator begin() const { return iterator(paths); }
+  iterator end() const { return iterator(); }
+  bool empty() const { return nullptr == paths; }
+  int size() const {
+    int count = 0;
+    for ( CDGPath* path = paths; path; path = path->next ) count++;
+    return count;
+  }
+  CDGPath* get() const { return paths; }
+  CDGPath* release() { CDGPath* out = paths; paths = nullptr; return out; }
+
+  void reset(CDGPath* list) {
+    if ( paths ) deletePaths(paths);
+    paths = list;
+  }
+
+ private:
+  CDGPath* paths;
+};
+
+/* Cdg - Owner of a CDG, plain or compact */
+
+class Cdg {
+ public:
+  Cdg() : root(nullptr) {}
+
+  /* Takes ownership of a CDG and updates its scores */
+  explicit Cdg(CDGNode* root) : root(root) {
+    if ( root ) updateCDG(root);
+  }
+
+  /* Takes ownership of a CDG whose scores are already up to date */
+  static Cdg adopt(CDGNode* root) {
+    Cdg cdg;
+    cdg.root = root;
+    return cdg;
+  }
+
+  Cdg(Cdg&& other) noexcept : root(other.release()) {}
+  Cdg& operator=(Cdg&& other) noexcept {
+    if ( this != &other ) reset(other.release());
+    return *this;
+  }
+  Cdg(const Cdg&) = delete;
+  Cdg& operator=(const Cdg&) = delete;
+  ~Cdg() { reset(nullptr); }
+
+  explicit operator bool() const { return nullptr != root; }
+  bool compact() const { return isCompactNode(root); }
+  CDGNode* get() const { return root; }
+  CDGNode* release() { CDGNode* out = root; root = nullptr; return out; }
+  void reset(CDGNode* node) {
+    if ( root ) deleteCDG(root);
+    root = node;
+  }
+
+  /* Root sibling list, for a plain or a compact CDG respectively */
+  NodeSet nodes() const { return NodeSet(PointerStorage::fromC(root)); }
+  CompactNodeSet compactNodes() const { return CompactNodeSet(CompactStorage::fromC(root)); }
+
+  /* Score of the top path */
+  int score() const {
+    if ( compact() ) return conditionalSum(compactNodes());
+    return conditionalSum(nodes());
+  }
+
+  Cdg& update() {
+    updateCDG(root);
+    return *this;
+  }
+
+  void cover(CDGNode* nodes[], int size) { coverNodes(root, nodes, size); }
+
+  /* Covers (id, outcome) pairs, see coverNodes */
+  void cover(const std::vector<std::pair<int, bool>>& branches) {
+    std::vector<CDGNode> nodes(branches.size());
+    std::vector<CDGNode*> pointers(branches.size());
+    for ( size_t i = 0; i < branches.size(); i++ ) {
+      nodes[i] = CDGNode();
+      nodes[i].id = branches[i].first;
+      nodes[i].outcome = branches[i].second;
+      pointers[i] = &nodes[i];
+    }
+    coverNodes(root, pointers.data(), (int)pointers.size());
+  }
+
+  PathSet topPaths(int numberOfPaths) const {
+    if ( nullptr == root ) return PathSet();
+    return PathSet(getTopPaths(root, numberOfPaths));
+  }
+
+  /* Compact copy of a plain CDG */
+  Cdg toCompact() const {
+    assert(!compact());
+    return adopt(compactCDG(root));
+  }
+
+ private:
+  CDGNode* root;
+};
+
+/* feasiblePath - Same as getFeasiblePath
+ * @path - Path from which the conditions were extracted
+ * @list - Satisfied nodes */
+
+inline Path feasiblePath(Node path, Node list) {
+  return Path(getFeasiblePath(path.c(), list.c()));
+}
+
+}
+
+#endif
@@ -0,0 +1,160 @@
+#include <sched.h>
+#include "cdgAsync.h"
+
+void waitForReaders(CDGAsync* async) {
+  int i, phase;
+  for ( i = 0; i < 2; i++ ) {
+    phase = __atomic_load_n(&async->phase, __ATOMIC_SEQ_CST);
+    __atomic_store_n(&async->phase, 1 - phase, __ATOMIC_SEQ_CST);
+    while ( 0 != __atomic_load_n(&async->readers[phase], __ATOMIC_SEQ_CST) ) {
+      sched_yield();
+    }
+  }
+}
+
+void publishTopPaths(CDGAsync* async, CDGPathSet* set) {
+  CDGPathSet* old = __atomic_exchange_n(&async->published, set, __ATOMIC_SEQ_CST);
+  waitForReaders(async);
+  releasePathSet(old);
+}
+
+void applyCoverageBatch(CDGAsync* async, CDGCoverageBatch* batch) {
+  CDGNode** nodes = (CDGNode**)malloc(sizeof(CDGNode*) * (batch->size + 1));
+  assert(NULL != nodes);
+  int i;
+  for ( i = 0; i < batch->size; i++ ) {
+    nodes[i] = newNode(batch->ids[i], 0, batch->outcomes[i], NULL, NULL, NULL, NULL, NULL);
+  }
+  cdgCoverNodes(async->cdg, nodes, batch->size);
+  for ( i = 0; i < batch->size; i++ ) {
+    deleteNode(nodes[i]);
+  }
+  free(nodes);
+}
+
+void deleteCoverageBatch(CDGCoverageBatch* batch) {
+  free(batch->ids);
+  free(batch->outcomes);
+  free(batch);
+}
+
+void* runAsyncScoring(void* arg) {
+  CDGAsync* async = (CDGAsync*)arg;
+  CDGCoverageBatch* batch;
+  CDGCoverageBatch* next;
+  unsigned long taken, epoch;
+  pthread_mutex_lock(&async->lock);
+  while (1) {
+    while ( NULL == async->head && !async->stop ) {
+      pthread_cond_wait(&async->changed, &async->lock);
+    }
+    if ( NULL == async->head ) break;
+    batch = async->head;
+    async->head = async->tail = NULL;
+    taken = async->submitted;
+    pthread_mutex_unlock(&async->lock);
+
+    epoch = cdgEpoch(async->cdg);
+    while ( batch ) {
+      next = batch->next;
+      applyCoverageBatch(async, batch);
+      deleteCoverageBatch(batch);
+      batch = next;
+    }
+    if ( epoch != cdgEpoch(async->cdg) ) {
+      publishTopPaths(async, cdgGetTopPaths(async->cdg, async->numberOfPaths));
+    }
+
+    pthread_mutex_lock(&async->lock);
+    async->applied = taken;
+    pthread_cond_broadcast(&async->drained);
+  }
+  pthread_mutex_unlock(&async->lock);
+  return NULL;
+}
+
+CDGAsync* cdgStartAsync(CDG* cdg, int numberOfPaths) {
+  assert(NULL != cdg);
+  CDGAsync* async;
+  async = (CDGAsync*)malloc(sizeof(CDGAsync));
+  assert(NULL != async);
+  async->cdg = cdg;
+  async->numberOfPaths = numberOfPaths;
+  async->published = cdgGetTopPaths(cdg, numberOfPaths);
+  async->readers[0] = 0;
+  async->readers[1] = 0;
+  async->phase = 0;
+  pthread_mutex_init(&async->lock, NULL);
+  pthread_cond_init(&async->changed, NULL);
+  pthread_cond_init(&async->drained, NULL);
+  async->head = NULL;
+  async->tail = NULL;
+  async->submitted = 0;
+  async->applied = 0;
+  async->stop = 0;
+  int rc = pthread_create(&async->thread, NULL, runAsyncScoring, async);
+  assert(0 == rc);
+  return async;
+}
+
+void cdgAsyncCoverNodes(CDGAsync* async, CDGNode* nodes[], int size) {
+  assert(NULL != async);
+  if ( 0 == size ) return;
+  CDGCoverageBatch* batch = (CDGCoverageBatch*)malloc(sizeof(CDGCoverageBatch));
+  assert(NULL != batch);
+  batch->ids = (int*)malloc(sizeof(int) * size);
+  batch->outcomes = (int*)malloc(sizeof(int) * size);
+  assert(NULL != batch->ids && NULL != batch->outcomes);
+  int i;
+  for ( i = 0; i < size; i++ ) {
+    batch->ids[i] = getID(nodes[i]);
+    batch->outcomes[i] = getOutcome(nodes[i]);
+  }
+  batch->size = size;
+  batch->next = NULL;
+  pthread_mutex_lock(&async->lock);
+  if ( NULL == async->tail ) {
+    async->head = batch;
+  } else {
+    async->tail->next = batch;
+  }
+  async->tail = batch;
+  async->submitted++;
+  pthread_cond_signal(&async->changed);
+  pthread_mutex_unlock(&async->lock);
+}
+
+CDGPathSet* cdgAsyncGetTopPaths(CDGAsync* async) {
+  assert(NULL != async);
+  int phase = __atomic_load_n(&async->phase, __ATOMIC_SEQ_CST);
+  __atomic_add_fetch(&async->readers[phase], 1, __ATOMIC_SEQ_CST);
+  CDGPathSet* set = retainPathSet(__atomic_load_n(&async->published, __ATOMIC_SEQ_CST));
+  __atomic_sub_fetch(&async->readers[phase], 1, __ATOMIC_SEQ_CST);
+  return set;
+}
+
+void cdgAsyncFlush(CDGAsync* async) {
+  assert(NULL != async);
+  pthread_mutex_lock(&async->lock);
+  unsigned long target = async->submitted;
+  while ( async->applied < target ) {
+    pthread_cond_wait(&async->drained, &async->lock);
+  }
+  pthread_mutex_unlock(&async->lock);
+}
+
+CDG* cdgStopAsync(CDGAsync* async) {
+  assert(NULL != async);
+  pthread_mutex_lock(&async->lock);
+  async->stop = 1;
+  pthread_cond_signal(&async->changed);
+  pthread_mutex_unlock(&async->lock);
+  pthread_join(async->thread, NULL);
+  CDG* cdg = async->cdg;
+  releasePathSet(async->published);
+  pthread_cond_destroy(&async->drained);
+  pthread_cond_destroy(&async->changed);
+  pthread_mutex_destroy(&async->lock);
+  free(async);
+  return cdg;
+}
@@ -0,0 +1,97 @@
+#ifndef CDG_ASYNC_H
+#define CDG_ASYNC_H
+
+#include <pthread.h>
+#include "cdgGraph.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* CDGCoverageBatch - Coverage submitted to the background thread
+ * @ids - Ids of the covered nodes
+ * @outcomes - Outcomes of the covered nodes
+ * @size - Number of covered nodes
+ * @next - Next submitted batch */
+
+typedef struct CDGCoverageBatch {
+  int* ids;
+  int* outcomes;
+  int size;
+  struct CDGCoverageBatch* next;
+} CDGCoverageBatch;
+
+/* CDGAsync - Asynchronous mode of a CDG handle. A background thread owns the CDG, applies the
+ *            submitted coverage, rescores and publishes the top paths. Readers pick up the
+ *            published set without ever waiting for the thread: they announce themselves on
+ *            one of two reader counters and the thread only frees a replaced set after both
+ *            counters drained (grace period), so a reader holds no lock
+ * @cdg - The CDG handle. Must not be used directly until cdgStopAsync
+ * @numberOfPaths - Number of top paths published
+ * @published - Latest published top paths
+ * @readers - Number of readers between announcing themselves and retaining the set, per phase
+ * @phase - Counter new readers announce themselves on
+ * @lock - Protects the queue, submitted, applied and stop
+ * @changed - Signals new coverage or stop to the thread
+ * @drained - Signals applied coverage to cdgAsyncFlush
+ * @head - First batch to apply
+ * @tail - Last batch to apply
+ * @submitted - Number of batches submitted
+ * @applied - Number of batches applied and published
+ * @stop - Set to stop the thread
+ * @thread - The background thread */
+
+typedef struct CDGAsync {
+  CDG* cdg;
+  int numberOfPaths;
+  CDGPathSet* published;
+  int readers[2];
+  int phase;
+  pthread_mutex_t lock;
+  pthread_cond_t changed;
+  pthread_cond_t drained;
+  CDGCoverageBatch* head;
+  CDGCoverageBatch* tail;
+  unsigned long submitted;
+  unsigned long applied;
+  int stop;
+  pthread_t thread;
+} CDGAsync;
+
+/* cdgStartAsync - Publishes the current top paths of a CDG and hands the CDG over to a
+ *                 background thread
+ * @cdg - a CDG handle
+ * @numberOfPaths - Number of top paths to keep published */
+
+CDGAsync* cdgStartAsync(CDG* cdg, int numberOfPaths);
+
+/* cdgAsyncCoverNodes - Queues coverage (see coverNodes) for the background thread and
+ *                      returns without waiting for it to be applied
+ * @async - an asynchronous CDG
+ * @nodes - Array of CDGNodes. Will have id and outcome set
+ * @size - Size of array */
+
+void cdgAsyncCoverNodes(CDGAsync* async, CDGNode* nodes[], int size);
+
+/* cdgAsyncGetTopPaths - Returns the latest published top paths. Never blocks. The caller owns
+ *                       one reference to the set. Thread safe
+ * @async - an asynchronous CDG */
+
+CDGPathSet* cdgAsyncGetTopPaths(CDGAsync* async);
+
+/* cdgAsyncFlush - Waits until all the coverage queued so far has been applied and published
+ * @async - an asynchronous CDG */
+
+void cdgAsyncFlush(CDGAsync* async);
+
+/* cdgStopAsync - Applies the queued coverage, stops the background thread and returns the
+ *                CDG handle to synchronous use
+ * @async - an asynchronous CDG */
+
+CDG* cdgStopAsync(CDGAsync* async);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,151 @@
+#include <pthread.h>
+#include <unistd.h>
+#include "cdgBatch.h"
+#include "cdgPredicates.h"
+
+#define BATCH_ARENA_BLOCK_SIZE (64 * 1024)
+
+/* BatchJob - State shared by the workers of a batch */
+
+typedef struct BatchJob {
+  CDGNode** paths;
+  int** satisfied;
+  int* satisfiedSizes;
+  int size;
+  int nextPair;
+  CDGFeasibleBatch* batch;
+} BatchJob;
+
+typedef struct BatchWorker {
+  BatchJob* job;
+  Arena* arena;
+} BatchWorker;
+
+int compareIds(const void* a, const void* b) {
+  int x = *(const int*)a;
+  int y = *(const int*)b;
+  return (x > y) - (x < y);
+}
+
+int idSatisfied(int* ids, int size, int id) {
+  return NULL != bsearch(&id, ids, size, sizeof(int), compareIds);
+}
+
+CDGNode* newArenaPathNode(Arena* arena, CDGNode* node) {
+  CDGNode* out = (CDGNode*)arenaAlloc(arena, sizeof(CDGNode));
+  out->id = getID(node);
+  out->score = 1;
+  out->outcome = getOutcome(node);
+  out->predicate = getPredicate(node);
+  if ( NULL != out->predicate ) {
+    out->expr = retainPredicate(out->predicate)->expr;
+  } else {
+    out->expr = arenaStrdup(arena, getExpr(node));
+  }
+  out->trueNodeSet = NULL;
+  out->falseNodeSet = NULL;
+  out->parent = NULL;
+  out->next = NULL;
+  return out;
+}
+
+CDGNode* buildArenaFeasiblePath(Arena* arena, CDGNode* node, int* ids, int size) {
+  while ( node && !idSatisfied(ids, size, getID(node)) ) {
+    node = getNextNode(node);
+  }
+  if ( NULL == node ) return NULL;
+  CDGNode* out = newArenaPathNode(arena, node);
+  CDGNode* child;
+  out->trueNodeSet = buildArenaFeasiblePath(arena, getTrueNodeSet(node), ids, size);
+  for ( child = out->trueNodeSet; child; child = child->next ) child->parent = out;
+  out->falseNodeSet = buildArenaFeasiblePath(arena, getFalseNodeSet(node), ids, size);
+  for ( child = out->falseNodeSet; child; child = child->next ) child->parent = out;
+  out->next = buildArenaFeasiblePath(arena, getNextNode(node), ids, size);
+  return out;
+}
+
+void* runBatchWorker(void* arg) {
+  BatchWorker* worker = (BatchWorker*)arg;
+  BatchJob* job = worker->job;
+  int i, *ids;
+  while ( (i = __sync_fetch_and_add(&job->nextPair, 1)) < job->size ) {
+    ids = (int*)arenaAlloc(worker->arena, sizeof(int) * (job->satisfiedSizes[i] + 1));
+    if ( job->satisfiedSizes[i] ) memcpy(ids, job->satisfied[i], sizeof(int) * job->satisfiedSizes[i]);
+    qsort(ids, job->satisfiedSizes[i], sizeof(int), compareIds);
+    job->batch->paths[i] = buildArenaFeasiblePath(worker->arena, job->paths[i], ids, job->satisfiedSizes[i]);
+  }
+  return NULL;
+}
+
+CDGFeasibleBatch* getFeasiblePaths(CDGNode* paths[], int* satisfied[], int satisfiedSizes[], int size, int numThreads) {
+  assert(0 <= size);
+  if ( 0 >= numThreads ) numThreads = (int)sysconf(_SC_NPROCESSORS_ONLN);
+  if ( numThreads > size ) numThreads = size;
+  if ( 0 >= numThreads ) numThreads = 1;
+  CDGFeasibleBatch* batch = (CDGFeasibleBatch*)malloc(sizeof(CDGFeasibleBatch));
+  assert(NULL != batch);
+  batch->size = size;
+  batch->paths = (CDGNode**)calloc(size + 1, sizeof(CDGNode*));
+  batch->arenaCnt = numThreads;
+  batch->arenas = (Arena**)malloc(sizeof(Arena*) * numThreads);
+  assert(NULL != batch->paths && NULL != batch->arenas);
+
+  BatchJob job;
+  job.paths = paths;
+  job.satisfied = satisfied;
+  job.satisfiedSizes = satisfiedSizes;
+  job.size = size;
+  job.nextPair = 0;
+  job.batch = batch;
+
+  BatchWorker* workers = (BatchWorker*)malloc(sizeof(BatchWorker) * numThreads);
+  pthread_t* threads = (pthread_t*)malloc(sizeof(pthread_t) * numThreads);
+  assert(NULL != workers && NULL != threads);
+  int i;
+  for ( i = 0; i < numThreads; i++ ) {
+    workers[i].job = &job;
+    workers[i].arena = batch->arenas[i] = arenaNew(BATCH_ARENA_BLOCK_SIZE);
+  }
+  for ( i = 1; i < numThreads; i++ ) {
+    if ( 0 != pthread_create(&threads[i], NULL, runBatchWorker, &workers[i]) ) {
+      threads[i] = pthread_self();
+    }
+  }
+  runBatchWorker(&workers[0]);
+  for ( i = 1; i < numThreads; i++ ) {
+    if ( !pthread_equal(threads[i], pthread_self()) ) pthread_join(threads[i], NULL);
+  }
+  free(threads);
+  free(workers);
+  return batch;
+}
+
+CDGNode* getBatchPath(CDGFeasibleBatch* batch, int i) {
+  assert(NULL != batch);
+  assert(0 <= i && i < batch->size);
+  return batch->paths[i];
+}
+
+/* Drops the references the nodes of an arena path hold to their predicates */
+
+void releaseArenaPredicates(CDGNode* node) {
+  for ( ; node; node = node->next ) {
+    if ( NULL != node->predicate ) releasePredicate(node->predicate);
+    releaseArenaPredicates(node->trueNodeSet);
+    releaseArenaPredicates(node->falseNodeSet);
+  }
+}
+
+void deleteFeasibleBatch(CDGFeasibleBatch* batch) {
+  assert(NULL != batch);
+  int i;
+  for ( i = 0; i < batch->size; i++ ) {
+    releaseArenaPredicates(batch->paths[i]);
+  }
+  for ( i = 0; i < batch->arenaCnt; i++ ) {
+    arenaFree(batch->arenas[i]);
+  }
+  free(batch->arenas);
+  free(batch->paths);
+  free(batch);
+}
@@ -0,0 +1,51 @@
+#ifndef CDG_BATCH_H
+#define CDG_BATCH_H
+
+#include "cdg.h"
+#include "arena.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* CDGFeasibleBatch - Feasible paths computed together for many (path, satisfied set) pairs
+ * @paths - Feasible path of every pair, in input order. NULL when nothing is satisfied
+ * @size - Number of pairs
+ * @arenas - Arenas holding the path nodes and the predicates they do not share, one per worker
+ * @arenaCnt - Number of arenas */
+
+typedef struct CDGFeasibleBatch {
+  CDGNode** paths;
+  int size;
+  Arena** arenas;
+  int arenaCnt;
+} CDGFeasibleBatch;
+
+/* getFeasiblePaths - Computes getFeasiblePath for every (path, satisfied id set) pair on a pool
+ *                    of worker threads and returns the results as a batch
+ *                  - Result nodes are allocated from the arenas of the batch and must only be
+ *                    released through deleteFeasibleBatch
+ * @paths - Array of paths from which the conditions were extracted
+ * @satisfied - Array of arrays of ids of the satisfied nodes, one per path
+ * @satisfiedSizes - Size of each array of satisfied ids
+ * @size - Number of paths
+ * @numThreads - Number of worker threads, 0 to use one per online processor */
+
+CDGFeasibleBatch* getFeasiblePaths(CDGNode* paths[], int* satisfied[], int satisfiedSizes[], int size, int numThreads);
+
+/* getBatchPath - Returns the feasible path of the i-th pair of a batch
+ * @batch - a batch
+ * @i - Index of the pair */
+
+CDGNode* getBatchPath(CDGFeasibleBatch* batch, int i);
+
+/* deleteFeasibleBatch - Deallocates a batch and all the paths in it
+ * @batch - a batch */
+
+void deleteFeasibleBatch(CDGFeasibleBatch* batch);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
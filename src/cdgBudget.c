@@ -0,0 +1,535 @@
+#include "cdgBudget.h"
+#include "cdgHits.h"
+#include "cdgCores.h"
+
+/* Budget scores of the decisions of a CDG. The table of a decision is a cap followed by its
+   packed score (score << 1 | outcome) within each budget from 0 to the cap, the scores within
+   larger budgets being those within the cap. A depth table only holds the score within the
+   depth left at the decision, so its cap is 1. Tables are found by node through an open
+   addressing hash table of pool offsets. Weights and blocked branches come from the scoring */
+
+typedef struct BudgetTables {
+  CDGScoring* scoring;
+  CDGNode** nodes;
+  int* offsets;
+  int slotCnt;
+  int tableCnt;
+  int* pool;
+  int poolSize;
+  int poolCapacity;
+} BudgetTables;
+
+/* State of a budgeted walk. Same as CDGPathWalk without the fingerprint, with the decisions
+   of the path in the order they were added, whose tables the covered leaves change */
+
+typedef struct BudgetWalk {
+  CDGCores* cores;
+  CDGBranchSet decisions;
+  CDGNode** added;
+  int addedCnt;
+  int addedCapacity;
+} BudgetWalk;
+
+void newBudgetTables(BudgetTables* tables, CDGScoring* scoring) {
+  tables->scoring = scoring;
+  tables->nodes = NULL;
+  tables->offsets = NULL;
+  tables->slotCnt = 0;
+  tables->tableCnt = 0;
+  tables->pool = NULL;
+  tables->poolSize = 0;
+  tables->poolCapacity = 0;
+}
+
+void deleteBudgetTables(BudgetTables* tables) {
+  free(tables->nodes);
+  free(tables->offsets);
+  free(tables->pool);
+}
+
+unsigned int hashBudgetNode(CDGNode* node, int slotCnt) {
+  unsigned long long hash = (unsigned long long)(size_t)node * 0x9E3779B97F4A7C15ULL;
+  return (unsigned int)(hash >> 32) & (slotCnt - 1);
+}
+
+void growBudgetSlots(BudgetTables* tables) {
+  CDGNode** nodes = tables->nodes;
+  int* offsets = tables->offsets;
+  int slotCnt = tables->slotCnt;
+  int i;
+  unsigned int j;
+  tables->slotCnt = 0 == slotCnt ? 64 : 2 * slotCnt;
+  tables->nodes = (CDGNode**)calloc(tables->slotCnt, sizeof(CDGNode*));
+  tables->offsets = (int*)malloc(sizeof(int) * tables->slotCnt);
+  assert(NULL != tables->nodes && NULL != tables->offsets);
+  for ( i = 0; i < slotCnt; i++ ) {
+    if ( NULL == nodes[i] ) continue;
+    j = hashBudgetNode(nodes[i], tables->slotCnt);
+    while ( NULL != tables->nodes[j] ) j = (j + 1) & (tables->slotCnt - 1);
+    tables->nodes[j] = nodes[i];
+    tables->offsets[j] = offsets[i];
+  }
+  free(nodes);
+  free(offsets);
+}
+
+/* Adds an empty table with a cap for a node and returns its offset in the pool */
+
+int addBudgetTable(BudgetTables* tables, CDGNode* node, int cap) {
+  unsigned int j;
+  int offset = tables->poolSize;
+  if ( 2 * (tables->tableCnt + 1) > tables->slotCnt ) growBudgetSlots(tables);
+  j = hashBudgetNode(node, tables->slotCnt);
+  while ( NULL != tables->nodes[j] ) {
+    assert(node != tables->nodes[j]);
+    j = (j + 1) & (tables->slotCnt - 1);
+  }
+  tables->nodes[j] = node;
+  tables->offsets[j] = offset;
+  tables->tableCnt++;
+  while ( offset + cap + 2 > tables->poolCapacity ) {
+    tables->poolCapacity = 0 == tables->poolCapacity ? 256 : 2 * tables->poolCapacity;
+    tables->pool = (int*)realloc(tables->pool, sizeof(int) * tables->poolCapacity);
+    assert(NULL != tables->pool);
+  }
+  tables->pool[offset] = cap;
+  tables->poolSize = offset + cap + 2;
+  return offset;
+}
+
+/* Returns the table of a node, NULL if it has none */
+
+int* getBudgetTable(BudgetTables* tables, CDGNode* node) {
+  unsigned int j;
+  if ( 0 == tables->slotCnt ) return NULL;
+  j = hashBudgetNode(node, tables->slotCnt);
+  while ( NULL != tables->nodes[j] ) {
+    if ( node == tables->nodes[j] ) return &tables->pool[tables->offsets[j]];
+    j = (j + 1) & (tables->slotCnt - 1);
+  }
+  return NULL;
+}
+
+/* Score a branch has when its children score childSum within the budget. As in scoreBranch, a
+   branch whose children score nothing only scores if it has an uncovered child */
+
+int scoreBudgetBranch(int weight, int uncovered, int childSum) {
+  if ( weight < 0 ) return 0;
+  if ( 0 < childSum ) return childSum + weight;
+  return uncovered ? weight : 0;
+}
+
+/* Branch weights of a decision, -1 for a branch blocked by an infeasible core */
+
+void getBudgetWeights(BudgetTables* tables, CDGNode* node, int weights[2], int uncovered[2]) {
+  CDGCores* cores = NULL != tables->scoring ? tables->scoring->cores : NULL;
+  int outcome;
+  for ( outcome = 0; outcome < 2; outcome++ ) {
+    if ( NULL != cores && isBranchBlocked(cores, node, outcome) ) {
+      weights[outcome] = -1;
+    } else {
+      weights[outcome] = getBranchWeight(NULL != tables->scoring ? tables->scoring->hits : NULL, node, outcome);
+    }
+    uncovered[outcome] = hasUncoveredChild(node, outcome);
+  }
+}
+
+int packBudgetScore(int weights[2], int uncovered[2], int trueSum, int falseSum) {
+  int trueScore = scoreBudgetBranch(weights[1], uncovered[1], trueSum);
+  int falseScore = scoreBudgetBranch(weights[0], uncovered[0], falseSum);
+  if ( trueScore >= falseScore ) return trueScore << 1 | 1;
+  return falseScore << 1;
+}
+
+int addLengthTable(BudgetTables* tables, CDGNode* node, int budget);
+
+/* Adds the length tables of the decisions of a node list, with a budget of at most budget each,
+   and returns the best scores of the list within each budget from 0 to the returned cap, as a
+   malloc'd array. Merges the tables the decisions already have instead unless add is set */
+
+int* mergeLengthTables(BudgetTables* tables, CDGNode* node, int budget, int* cap, int add) {
+  int* merged = (int*)malloc(sizeof(int));
+  int* next;
+  int* table;
+  int size = 0;
+  int offset, nodeCap, newSize, k, j, best, score;
+  assert(NULL != merged);
+  merged[0] = 0;
+  for ( ; node && 0 < budget; node = getNextNode(node) ) {
+    if ( isLeaf(node) ) continue;
+    if ( add ) {
+      offset = addLengthTable(tables, node, budget);
+      table = &tables->pool[offset];
+    } else {
+      table = getBudgetTable(tables, node);
+      assert(NULL != table);
+    }
+    nodeCap = table[0];
+    newSize = size + nodeCap < budget ? size + nodeCap : budget;
+    next = (int*)malloc(sizeof(int) * (newSize + 1));
+    assert(NULL != next);
+    for ( k = 0; k <= newSize; k++ ) {
+      best = 0;
+      for ( j = k > size ? k - size : 0; j <= k && j <= nodeCap; j++ ) {
+        score = merged[k - j] + (table[1 + j] >> 1);
+        if ( score > best ) best = score;
+      }
+      next[k] = best;
+    }
+    free(merged);
+    merged = next;
+    size = newSize;
+  }
+  *cap = size;
+  return merged;
+}
+
+/* Fills the length table of a decision, or adds it after those of the decisions below it for
+   budgets of at most budget, and returns its offset. The cap of a table only depends on the
+   decisions below it, so a table filled again within its own cap keeps it */
+
+int fillLengthTable(BudgetTables* tables, CDGNode* node, int budget, int add) {
+  int weights[2], uncovered[2];
+  int trueCap, falseCap, cap, offset, k;
+  int* trueSums = mergeLengthTables(tables, getTrueNodeSet(node), budget - 1, &trueCap, add);
+  int* falseSums = mergeLengthTables(tables, getFalseNodeSet(node), budget - 1, &falseCap, add);
+  int* table;
+  getBudgetWeights(tables, node, weights, uncovered);
+  cap = 1 + (trueCap > falseCap ? trueCap : falseCap);
+  if ( add ) {
+    offset = addBudgetTable(tables, node, cap);
+  } else {
+    offset = getBudgetTable(tables, node) - tables->pool;
+    assert(cap == tables->pool[offset]);
+  }
+  table = &tables->pool[offset];
+  table[1] = 0;
+  for ( k = 1; k <= cap; k++ ) {
+    table[1 + k] = packBudgetScore(weights, uncovered, trueSums[k - 1 < trueCap ? k - 1 : trueCap],
+                                   falseSums[k - 1 < falseCap ? k - 1 : falseCap]);
+  }
+  free(trueSums);
+  free(falseSums);
+  return offset;
+}
+
+int addLengthTable(BudgetTables* tables, CDGNode* node, int budget) {
+  return fillLengthTable(tables, node, budget, 1);
+}
+
+/* Adds the depth tables of a decision and the decisions below it, with depth left at the
+   decision, and returns its score */
+
+int addDepthTable(BudgetTables* tables, CDGNode* node, int depth) {
+  int weights[2], uncovered[2], sums[2];
+  int outcome, offset;
+  CDGNode* child;
+  for ( outcome = 0; outcome < 2; outcome++ ) {
+    sums[outcome] = 0;
+    child = outcome ? getTrueNodeSet(node) : getFalseNodeSet(node);
+    for ( ; child && 1 < depth; child = getNextNode(child) ) {
+      if ( !isLeaf(child) ) sums[outcome] += addDepthTable(tables, child, depth - 1);
+    }
+  }
+  getBudgetWeights(tables, node, weights, uncovered);
+  offset = addBudgetTable(tables, node, 1);
+  tables->pool[offset + 1] = 0;
+  tables->pool[offset + 2] = packBudgetScore(weights, uncovered, sums[1], sums[0]);
+  return tables->pool[offset + 2] >> 1;
+}
+
+int addDepthTables(BudgetTables* tables, CDGNode* node, int depth) {
+  int sum = 0;
+  for ( ; node && 0 < depth; node = getNextNode(node) ) {
+    if ( !isLeaf(node) ) sum += addDepthTable(tables, node, depth);
+  }
+  return sum;
+}
+
+/* Fills the depth table of a decision again from the tables of the decisions below it, those
+   below the depth left having none */
+
+void refreshDepthTable(BudgetTables* tables, CDGNode* node) {
+  int weights[2], uncovered[2], sums[2];
+  int outcome;
+  int* table;
+  CDGNode* child;
+  for ( outcome = 0; outcome < 2; outcome++ ) {
+    sums[outcome] = 0;
+    child = outcome ? getTrueNodeSet(node) : getFalseNodeSet(node);
+    for ( ; child; child = getNextNode(child) ) {
+      if ( isLeaf(child) ) continue;
+      table = getBudgetTable(tables, child);
+      if ( NULL != table ) sums[outcome] += table[2] >> 1;
+    }
+  }
+  getBudgetWeights(tables, node, weights, uncovered);
+  table = getBudgetTable(tables, node);
+  assert(NULL != table);
+  table[2] = packBudgetScore(weights, uncovered, sums[1], sums[0]);
+}
+
+/* Appends a decision taking an outcome to a path and returns it, or returns NULL if the branch
+   completes an infeasible core with the decisions already on the path */
+
+CDGNode* appendBudgetDecision(BudgetWalk* walk, CDGNode* temp, CDGNode* node, int outcome) {
+  if ( NULL != walk->cores ) {
+    if ( completesCore(walk->cores, &walk->decisions, getID(node), outcome) ) return NULL;
+    addBranch(&walk->decisions, getID(node), outcome);
+  }
+  if ( walk->addedCnt == walk->addedCapacity ) {
+    walk->addedCapacity = 0 == walk->addedCapacity ? 64 : 2 * walk->addedCapacity;
+    walk->added = (CDGNode**)realloc(walk->added, sizeof(CDGNode*) * walk->addedCapacity);
+    assert(NULL != walk->added);
+  }
+  walk->added[walk->addedCnt++] = node;
+  setNextNode(temp, copyToPathNode(newBlankNode(), node));
+  temp = getNextNode(temp);
+  setOutcome(temp, outcome);
+  return temp;
+}
+
+CDGNode* finishBudgetPath(CDGNode* pathNode, CDGNode* temp) {
+  CDGNode* head = getNextNode(pathNode);
+  if ( temp == pathNode ) head = NULL;
+  deleteNode(pathNode);
+  return head;
+}
+
+/* Splits a budget among the decisions of a node list the way their merged scores were reached.
+   Returns a malloc'd array of the budget of each decision, in list order */
+
+int* splitLengthBudget(BudgetTables* tables, CDGNode* node, int budget) {
+  CDGNode* temp;
+  int** decisionTables;
+  int* sizes;
+  int* prefix;
+  int* split;
+  int count = 0;
+  int width, i, k, j, best, score;
+  for ( temp = node; temp; temp = getNextNode(temp) ) {
+    if ( !isLeaf(temp) ) count++;
+  }
+  decisionTables = (int**)malloc(sizeof(int*) * (count + 1));
+  sizes = (int*)malloc(sizeof(int) * (count + 1));
+  split = (int*)malloc(sizeof(int) * (count + 1));
+  assert(NULL != decisionTables && NULL != sizes && NULL != split);
+  sizes[0] = 0;
+  for ( i = 0, temp = node; temp; temp = getNextNode(temp) ) {
+    if ( isLeaf(temp) ) continue;
+    decisionTables[i] = getBudgetTable(tables, temp);
+    assert(NULL != decisionTables[i]);
+    sizes[i + 1] = sizes[i] + decisionTables[i][0] < budget ? sizes[i] + decisionTables[i][0] : budget;
+    i++;
+  }
+  width = sizes[count] + 1;
+  prefix = (int*)malloc(sizeof(int) * (count + 1) * width);
+  assert(NULL != prefix);
+  prefix[0] = 0;
+  for ( i = 0; i < count; i++ ) {
+    for ( k = 0; k <= sizes[i + 1]; k++ ) {
+      best = 0;
+      for ( j = k > sizes[i] ? k - sizes[i] : 0; j <= k && j <= decisionTables[i][0]; j++ ) {
+        score = prefix[i * width + k - j] + (decisionTables[i][1 + j] >> 1);
+        if ( score > best ) best = score;
+      }
+      prefix[(i + 1) * width + k] = best;
+    }
+  }
+  k = sizes[count];
+  for ( i = count - 1; 0 <= i; i-- ) {
+    for ( j = k > sizes[i] ? k - sizes[i] : 0; j <= k && j <= decisionTables[i][0]; j++ ) {
+      if ( prefix[i * width + k - j] + (decisionTables[i][1 + j] >> 1) == prefix[(i + 1) * width + k] ) break;
+    }
+    assert(j <= k && j <= decisionTables[i][0]);
+    split[i] = j;
+    k -= j;
+  }
+  free(decisionTables);
+  free(sizes);
+  free(prefix);
+  return split;
+}
+
+CDGNode* walkWithinLength(BudgetTables* tables, CDGNode* node, int budget, CDGTransaction* txn, BudgetWalk* walk) {
+  CDGNode* pathNode = newBlankNode();
+  CDGNode* temp = pathNode;
+  CDGNode* added;
+  int* split = 0 < budget ? splitLengthBudget(tables, node, budget) : NULL;
+  int* table;
+  int i = 0;
+  int outcome, share;
+  for ( ; node; node = getNextNode(node) ) {
+    if ( isLeaf(node) ) {
+      if ( 0 != getScore(node) ) transactSetScore(txn, node, 0);
+      continue;
+    }
+    share = NULL != split ? split[i++] : 0;
+    if ( 0 == share ) continue;
+    table = getBudgetTable(tables, node);
+    if ( 0 == table[1 + share] >> 1 ) continue;
+    outcome = table[1 + share] & 1;
+    added = appendBudgetDecision(walk, temp, node, outcome);
+    if ( NULL == added ) continue;
+    temp = added;
+    if ( outcome ) {
+      setTrueNodeSet(temp, walkWithinLength(tables, getTrueNodeSet(node), share - 1, txn, walk));
+    } else {
+      setFalseNodeSet(temp, walkWithinLength(tables, getFalseNodeSet(node), share - 1, txn, walk));
+    }
+    transactCoverImplicit(txn, node, outcome);
+  }
+  free(split);
+  return finishBudgetPath(pathNode, temp);
+}
+
+CDGNode* walkWithinDepth(BudgetTables* tables, CDGNode* node, int depth, CDGTransaction* txn, BudgetWalk* walk) {
+  CDGNode* pathNode = newBlankNode();
+  CDGNode* temp = pathNode;
+  CDGNode* added;
+  int* table;
+  int outcome;
+  for ( ; node; node = getNextNode(node) ) {
+    if ( isLeaf(node) ) {
+      if ( 0 != getScore(node) ) transactSetScore(txn, node, 0);
+      continue;
+    }
+    if ( 0 == depth ) continue;
+    table = getBudgetTable(tables, node);
+    if ( 0 == table[2] >> 1 ) continue;
+    outcome = table[2] & 1;
+    added = appendBudgetDecision(walk, temp, node, outcome);
+    if ( NULL == added ) continue;
+    temp = added;
+    if ( outcome ) {
+      setTrueNodeSet(temp, walkWithinDepth(tables, getTrueNodeSet(node), depth - 1, txn, walk));
+    } else {
+      setFalseNodeSet(temp, walkWithinDepth(tables, getFalseNodeSet(node), depth - 1, txn, walk));
+    }
+    transactCoverImplicit(txn, node, outcome);
+  }
+  return finishBudgetPath(pathNode, temp);
+}
+
+void addBudgetTables(BudgetTables* tables, CDGNode* node, int budget, int byDepth) {
+  int cap;
+  if ( byDepth ) {
+    addDepthTables(tables, node, budget);
+  } else {
+    free(mergeLengthTables(tables, node, budget, &cap, 1));
+  }
+}
+
+/* Fills the tables of the decisions of the last path again, below ones first. The leaves it
+   covered and the implicit blocks it took are all in the branches of these decisions */
+
+void refreshBudgetTables(BudgetTables* tables, BudgetWalk* walk, int byDepth) {
+  int i;
+  for ( i = walk->addedCnt - 1; 0 <= i; i-- ) {
+    if ( byDepth ) {
+      refreshDepthTable(tables, walk->added[i]);
+    } else {
+      fillLengthTable(tables, walk->added[i], getBudgetTable(tables, walk->added[i])[0], 0);
+    }
+  }
+}
+
+CDGNode* walkBudgetPath(BudgetTables* tables, CDGNode* node, CDGTransaction* txn, int budget, int byDepth,
+                        BudgetWalk* walk) {
+  CDGNode* path;
+  walk->cores = NULL != txn->scoring ? txn->scoring->cores : NULL;
+  walk->addedCnt = 0;
+  newBranchSet(&walk->decisions);
+  if ( byDepth ) {
+    path = walkWithinDepth(tables, node, budget, txn, walk);
+  } else {
+    path = walkWithinLength(tables, node, budget, txn, walk);
+  }
+  deleteBranchSet(&walk->decisions);
+  return path;
+}
+
+CDGNode* getBudgetPath(CDGNode* node, CDGTransaction* txn, int budget, int byDepth) {
+  assert(NULL != txn);
+  assert(0 <= budget);
+  BudgetTables tables;
+  BudgetWalk walk;
+  CDGNode* path;
+  walk.added = NULL;
+  walk.addedCapacity = 0;
+  newBudgetTables(&tables, txn->scoring);
+  addBudgetTables(&tables, node, budget, byDepth);
+  path = walkBudgetPath(&tables, node, txn, budget, byDepth, &walk);
+  free(walk.added);
+  deleteBudgetTables(&tables);
+  return path;
+}
+
+CDGNode* getTopPathWithinLength(CDGNode* node, CDGTransaction* txn, int maxLength) {
+  return getBudgetPath(node, txn, maxLength, 0);
+}
+
+CDGNode* getTopPathWithinDepth(CDGNode* node, CDGTransaction* txn, int maxDepth) {
+  return getBudgetPath(node, txn, maxDepth, 1);
+}
+
+/* The tables are built once and after each path only those of its decisions are filled again */
+
+CDGPath* getBudgetPaths(CDGNode* root, int numberOfPaths, int budget, int byDepth) {
+  assert(0 <= budget);
+  CDGPath* pathHead = NULL;
+  CDGNode* path;
+  CDGPath* currPath;
+  CDGTransaction* txn = beginTransaction();
+  BudgetTables tables;
+  BudgetWalk walk;
+  walk.added = NULL;
+  walk.addedCapacity = 0;
+  newBudgetTables(&tables, txn->scoring);
+  addBudgetTables(&tables, root, budget, byDepth);
+  while ( numberOfPaths-- ) {
+    path = walkBudgetPath(&tables, root, txn, budget, byDepth, &walk);
+    if ( NULL == path ) break;
+    refreshBudgetTables(&tables, &walk, byDepth);
+    if ( NULL == pathHead ) {
+      pathHead = setPathNode(newPath(), path);
+      currPath = pathHead;
+    } else {
+      setNextPath(currPath, setPathNode(newPath(), path));
+      currPath = getNextPath(currPath);
+    }
+  }
+  free(walk.added);
+  deleteBudgetTables(&tables);
+  rollbackTransaction(txn);
+  return pathHead;
+}
+
+CDGPath* getTopPathsWithinLength(CDGNode* node, int numberOfPaths, int maxLength) {
+  return getBudgetPaths(node, numberOfPaths, maxLength, 0);
+}
+
+CDGPath* getTopPathsWithinDepth(CDGNode* node, int numberOfPaths, int maxDepth) {
+  return getBudgetPaths(node, numberOfPaths, maxDepth, 1);
+}
+
+int getScoreWithinLength(CDGNode* node, int maxLength) {
+  assert(0 <= maxLength);
+  BudgetTables tables;
+  int cap;
+  newBudgetTables(&tables, NULL);
+  int* merged = mergeLengthTables(&tables, node, maxLength, &cap, 1);
+  int score = merged[cap];
+  free(merged);
+  deleteBudgetTables(&tables);
+  return score;
+}
+
+int getScoreWithinDepth(CDGNode* node, int maxDepth) {
+  assert(0 <= maxDepth);
+  BudgetTables tables;
+  newBudgetTables(&tables, NULL);
+  int score = addDepthTables(&tables, node, maxDepth);
+  deleteBudgetTables(&tables);
+  return score;
+}
@@ -0,0 +1,82 @@
+#ifndef CDG_BUDGET_H
+#define CDG_BUDGET_H
+
+#include "cdg.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Budgeted top paths
+ *
+ * getTopPath follows the best outcome of every decision with a score down to the leaves, so
+ * its paths get as long and as deep as the CDG. The budgeted variants return the best path
+ * with at most maxLength decisions, or with decisions nested at most maxDepth deep.
+ *
+ * The budget is part of the scoring rather than a cut of the top path. A decision scores
+ * within a budget the way updateScore scores it, with the sums of its children replaced by
+ * what they score within the budget left below the decision: maxDepth - 1 for a depth, and
+ * for a length the best split of the remaining decisions among the children. Decisions
+ * nested deeper than the budget score 0, so a decision at the edge of the budget scores like
+ * a conditional leaf. Within an unlimited budget the scores are those of updateScore and the
+ * paths those of getTopPath.
+ *
+ * The length scores of a decision are a table by budget, merged bottom-up over siblings like
+ * a knapsack, and are kept only up to the number of decisions below it. The scores are
+ * computed from the scores of the CDG, so these assume updateCDG has been run.
+ * getTopPathWithin* computes them for each call, getTopPathsWithin* once per call, then only
+ * again for the decisions of each path, whose branches hold the leaves it covers. With infeasible cores in the scoring of the transaction (see
+ * beginTransactionWith), blocked branches score 0 and a decision completing a core with the
+ * decisions already on the path is left out, without trying its other branch.
+ * getTopPathsWithin* and getScoreWithin* score with plain coverage */
+
+/* getTopPathWithinLength - Same as getTopPath, returning the best path with at most
+ *                          maxLength decisions
+ * @node - CDG root node
+ * @txn - Transaction recording the covered leaves
+ * @maxLength - Maximum number of decisions of the path */
+
+CDGNode* getTopPathWithinLength(CDGNode* node, CDGTransaction* txn, int maxLength);
+
+/* getTopPathWithinDepth - Same as getTopPath, returning the best path whose decisions are
+ *                         nested at most maxDepth deep, those of the root list being at 1
+ * @node - CDG root node
+ * @txn - Transaction recording the covered leaves
+ * @maxDepth - Maximum nesting depth of the decisions of the path */
+
+CDGNode* getTopPathWithinDepth(CDGNode* node, CDGTransaction* txn, int maxDepth);
+
+/* getTopPathsWithinLength - Same as getTopPaths, with each path having at most maxLength
+ *                           decisions
+ * @node - CDG root node
+ * @numberOfPaths - Maximum number of paths to be returned
+ * @maxLength - Maximum number of decisions of each path */
+
+CDGPath* getTopPathsWithinLength(CDGNode* node, int numberOfPaths, int maxLength);
+
+/* getTopPathsWithinDepth - Same as getTopPaths, with the decisions of each path nested at
+ *                          most maxDepth deep
+ * @node - CDG root node
+ * @numberOfPaths - Maximum number of paths to be returned
+ * @maxDepth - Maximum nesting depth of the decisions of each path */
+
+CDGPath* getTopPathsWithinDepth(CDGNode* node, int numberOfPaths, int maxDepth);
+
+/* getScoreWithinLength - Returns the score of the best path with at most maxLength decisions
+ * @node - CDG root node
+ * @maxLength - Maximum number of decisions of the path */
+
+int getScoreWithinLength(CDGNode* node, int maxLength);
+
+/* getScoreWithinDepth - Returns the score of the best path whose decisions are nested at
+ *                       most maxDepth deep
+ * @node - CDG root node
+ * @maxDepth - Maximum nesting depth of the decisions of the path */
+
+int getScoreWithinDepth(CDGNode* node, int maxDepth);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,196 @@
+#include "cdgBuffer.h"
+
+CDGPathBuffer* initPathBuffer(CDGPathBuffer* buffer, CDGNode* nodes, int nodeCapacity, CDGNode** paths, int pathCapacity, CDGUndoEntry* undo, int undoCapacity) {
+  assert(NULL != buffer);
+  assert(NULL != nodes || 0 == nodeCapacity);
+  buffer->nodes = nodes;
+  buffer->nodeCapacity = nodeCapacity;
+  buffer->nodeCnt = 0;
+  buffer->paths = paths;
+  buffer->pathCapacity = NULL == paths ? 0 : pathCapacity;
+  buffer->pathCnt = 0;
+  buffer->undo = undo;
+  buffer->undoCapacity = NULL == undo ? 0 : undoCapacity;
+  buffer->requiredNodes = 0;
+  buffer->requiredUndo = 0;
+  buffer->truncated = 0;
+  return buffer;
+}
+
+/* Takes the next node of the buffer, or NULL once it is full. The count keeps growing so
+ * that the caller learns the required size */
+
+CDGNode* takeBufferNode(CDGPathBuffer* buffer, CDGNode* node) {
+  CDGNode* pathNode;
+  if ( buffer->nodeCnt++ >= buffer->nodeCapacity ) return NULL;
+  pathNode = &buffer->nodes[buffer->nodeCnt - 1];
+  pathNode->id = getID(node);
+  pathNode->score = 0;
+  pathNode->outcome = getOutcome(node);
+  pathNode->flags = 0;
+  pathNode->expr = getExpr(node);
+  pathNode->predicate = getPredicate(node);
+  pathNode->trueNodeSet = NULL;
+  pathNode->falseNodeSet = NULL;
+  pathNode->parent = NULL;
+  pathNode->next = NULL;
+  return pathNode;
+}
+
+void addUndoEntry(CDGPathBuffer* buffer, int* undoCnt, CDGNode* node) {
+  if ( *undoCnt < buffer->undoCapacity ) {
+    buffer->undo[*undoCnt].node = node;
+    buffer->undo[*undoCnt].score = getScore(node);
+    buffer->undo[*undoCnt].outcome = getOutcome(node);
+    buffer->undo[*undoCnt].flags = getFlags(node);
+  }
+  (*undoCnt)++;
+}
+
+/* Reads like getTopPath without covering anything, recording the leaves to cover in undo.
+ * An implicit empty block is recorded as its decision node, with the covered side as outcome */
+
+CDGNode* walkTopPathInto(CDGNode* node, CDGPathBuffer* buffer, int* undoCnt) {
+  CDGNode* pathNode = NULL;
+  CDGNode* temp = NULL;
+  CDGNode* curr;
+  CDGNode* branch;
+  while (node) {
+    if ( 0 != getScore(node) ) {
+      if ( isLeaf(node) ) {
+        addUndoEntry(buffer, undoCnt, node);
+      } else {
+        curr = takeBufferNode(buffer, node);
+        branch = walkTopPathInto(getOutcome(node) ? getTrueNodeSet(node) : getFalseNodeSet(node), buffer, undoCnt);
+        if ( getFlags(node) & CDG_IMPLICIT(getOutcome(node)) ) addUndoEntry(buffer, undoCnt, node);
+        if ( curr ) {
+          if (getOutcome(node)) {
+            curr->trueNodeSet = branch;
+          } else {
+            curr->falseNodeSet = branch;
+          }
+          if ( NULL == temp ) {
+            pathNode = curr;
+          } else {
+            temp->next = curr;
+          }
+          temp = curr;
+        }
+      }
+    }
+    node = getNextNode(node);
+  }
+  return pathNode;
+}
+
+/* Updates a node and its ancestors, stopping at the first unchanged one */
+
+void updateScoresInPlace(CDGNode* currNode) {
+  int oldScore, oldOutcome;
+  while ( currNode ) {
+    oldScore = getScore(currNode);
+    oldOutcome = getOutcome(currNode);
+    updateScore(currNode);
+    if ( oldScore == getScore(currNode) && oldOutcome == getOutcome(currNode) ) break;
+    currNode = getParent(currNode);
+  }
+}
+
+void setScoreInPlace(CDGNode* node, int score) {
+  setScore(node, score);
+  updateScoresInPlace(getParent(node));
+}
+
+/* Covers the leaf or the implicit block of an undo entry */
+
+void coverUndoEntry(CDGUndoEntry* entry) {
+  if ( isLeaf(entry->node) ) {
+    setScoreInPlace(entry->node, 0);
+    return;
+  }
+  setFlags(entry->node, getFlags(entry->node) & ~CDG_IMPLICIT(entry->outcome));
+  updateScoresInPlace(entry->node);
+}
+
+/* Every restored leaf is followed by an update of its ancestors, so once all of them are
+ * restored each ancestor has been updated after its last changed child, which gives back
+ * the scores the CDG had before under plain coverage, the only scoring supported */
+
+void restoreCoveredLeaves(CDGPathBuffer* buffer, int undoCnt) {
+  CDGUndoEntry* entry;
+  while ( undoCnt-- ) {
+    entry = &buffer->undo[undoCnt];
+    if ( isLeaf(entry->node) ) {
+      setOutcome(entry->node, entry->outcome);
+      setScoreInPlace(entry->node, entry->score);
+    } else {
+      setFlags(entry->node, entry->flags);
+      updateScoresInPlace(entry->node);
+    }
+  }
+}
+
+int getTopPathsInto(CDGNode* root, int numberOfPaths, CDGPathBuffer* buffer) {
+  assert(NULL != buffer);
+  int undoCnt = 0;
+  int nodeCnt, pathUndoCnt, i;
+  CDGNode* path;
+  buffer->nodeCnt = 0;
+  buffer->pathCnt = 0;
+  buffer->truncated = 0;
+  buffer->requiredNodes = 0;
+  buffer->requiredUndo = 0;
+  if ( numberOfPaths > buffer->pathCapacity ) numberOfPaths = buffer->pathCapacity;
+  while ( numberOfPaths-- ) {
+    nodeCnt = buffer->nodeCnt;
+    pathUndoCnt = undoCnt;
+    path = walkTopPathInto(root, buffer, &pathUndoCnt);
+    if ( buffer->nodeCnt > buffer->nodeCapacity || pathUndoCnt > buffer->undoCapacity ) {
+      buffer->truncated = 1;
+      buffer->requiredNodes = buffer->nodeCnt;
+      buffer->requiredUndo = pathUndoCnt;
+      buffer->nodeCnt = nodeCnt;
+      break;
+    }
+    if ( NULL == path ) break;
+    buffer->paths[buffer->pathCnt++] = path;
+    for ( i = undoCnt; i < pathUndoCnt; i++ ) {
+      coverUndoEntry(&buffer->undo[i]);
+    }
+    undoCnt = pathUndoCnt;
+  }
+  restoreCoveredLeaves(buffer, undoCnt);
+  return buffer->pathCnt;
+}
+
+CDGNode* buildFeasiblePathInto(CDGNode* node, CDGNode* list, CDGPathBuffer* buffer) {
+  while ( node && 0 == nodeExists(list, getID(node))) {
+    node = getNextNode(node);
+  }
+  if ( NULL == node ) return NULL;
+  CDGNode* out = takeBufferNode(buffer, node);
+  CDGNode* trueNodeSet = buildFeasiblePathInto(getTrueNodeSet(node), list, buffer);
+  CDGNode* falseNodeSet = buildFeasiblePathInto(getFalseNodeSet(node), list, buffer);
+  CDGNode* next = buildFeasiblePathInto(getNextNode(node), list, buffer);
+  if ( NULL == out ) return NULL;
+  out->trueNodeSet = trueNodeSet;
+  out->falseNodeSet = falseNodeSet;
+  out->next = next;
+  return out;
+}
+
+CDGNode* getFeasiblePathInto(CDGNode* path, CDGNode* list, CDGPathBuffer* buffer) {
+  assert(NULL != buffer);
+  buffer->nodeCnt = 0;
+  buffer->pathCnt = 0;
+  buffer->requiredNodes = 0;
+  buffer->requiredUndo = 0;
+  CDGNode* out = buildFeasiblePathInto(path, list, buffer);
+  buffer->truncated = buffer->nodeCnt > buffer->nodeCapacity;
+  if ( buffer->truncated ) {
+    buffer->requiredNodes = buffer->nodeCnt;
+    buffer->nodeCnt = 0;
+    return NULL;
+  }
+  return out;
+}
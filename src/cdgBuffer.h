@@ -0,0 +1,86 @@
+#ifndef CDG_BUFFER_H
+#define CDG_BUFFER_H
+
+#include "cdg.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Allocation free path queries
+ *
+ * getTopPathsInto and getFeasiblePathInto build their paths in memory supplied by the caller
+ * and never allocate. Path nodes share the predicates of the CDG they were taken from, so
+ * they must neither be passed to deleteCDG/deletePaths nor outlive that CDG. A buffer can be
+ * reused for any number of queries, each query overwrites the previous result */
+
+/* CDGPathBuffer - Caller supplied storage of path queries
+ * @nodes - Storage of the path nodes
+ * @nodeCapacity - Number of entries of nodes
+ * @nodeCnt - Number of path nodes used by the last query
+ * @paths - Head of each path built by the last query
+ * @pathCapacity - Number of entries of paths
+ * @pathCnt - Number of paths built by the last query
+ * @undo - Scratch space recording the leaves and implicit blocks covered while building top paths
+ * @undoCapacity - Number of entries of undo
+ * @requiredNodes - Set by a truncated query to the number of nodes needed to get further
+ * @requiredUndo - Set by a truncated query to the number of undo entries needed to get further
+ * @truncated - 1 if the last query ran out of space, 0 otherwise */
+
+typedef struct CDGPathBuffer {
+  CDGNode* nodes;
+  int nodeCapacity;
+  int nodeCnt;
+  CDGNode** paths;
+  int pathCapacity;
+  int pathCnt;
+  CDGUndoEntry* undo;
+  int undoCapacity;
+  int requiredNodes;
+  int requiredUndo;
+  int truncated;
+} CDGPathBuffer;
+
+/* initPathBuffer - Sets up a path buffer over caller supplied arrays and returns it
+ * @buffer - Buffer to set up
+ * @nodes - Storage of path nodes
+ * @nodeCapacity - Number of entries of nodes
+ * @paths - Storage of path heads, may be NULL for feasible path queries
+ * @pathCapacity - Number of entries of paths
+ * @undo - Scratch space for top path queries, may be NULL for feasible path queries
+ * @undoCapacity - Number of entries of undo */
+
+CDGPathBuffer* initPathBuffer(CDGPathBuffer* buffer, CDGNode* nodes, int nodeCapacity, CDGNode** paths, int pathCapacity, CDGUndoEntry* undo, int undoCapacity);
+
+/* getTopPathsInto - Same as getTopPaths, building the paths into a buffer. Returns the number
+ *                   of paths built, also in buffer->pathCnt
+ *                 - If the buffer runs out of space the paths built so far are kept,
+ *                   buffer->truncated is set and requiredNodes and requiredUndo give the
+ *                   capacities needed to build at least one more path
+ *                 - Like transactions, assumes the scores of the CDG are up to date. The
+ *                   scores are restored before returning, by rescoring the ancestors of the
+ *                   covered leaves with updateScore
+ *                 - Only plain coverage, without a scoring, is supported: the root of a
+ *                   handle with hit counters or infeasible cores would be rescored without
+ *                   them (see getTopPathsWith instead)
+ * @root - Root of CDG
+ * @numberOfPaths - Maximum number of paths, capped at buffer->pathCapacity
+ * @buffer - a path buffer */
+
+int getTopPathsInto(CDGNode* root, int numberOfPaths, CDGPathBuffer* buffer);
+
+/* getFeasiblePathInto - Same as getFeasiblePath, building the path into a buffer. Returns the
+ *                       path, or NULL either when nothing is feasible or when the buffer is
+ *                       too small, in which case buffer->truncated is set and requiredNodes is
+ *                       the exact number of nodes needed
+ * @path - Path from which the conditions were extracted
+ * @list - List of nodes whose conditions are satisfied
+ * @buffer - a path buffer */
+
+CDGNode* getFeasiblePathInto(CDGNode* path, CDGNode* list, CDGPathBuffer* buffer);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
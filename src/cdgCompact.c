@@ -0,0 +1,204 @@
+#include <pthread.h>
+#include "cdgCompact.h"
+
+#define COMPACT_MAX_STORES 0x8000
+
+CDGCompactStore* compactStores[COMPACT_MAX_STORES];
+pthread_mutex_t compactStoresLock = PTHREAD_MUTEX_INITIALIZER;
+
+CDGNode* compactHandle(CDGCompactStore* store, unsigned int index) {
+  if ( 0 == index ) return NULL;
+  return (CDGNode*)(((uintptr_t)index << COMPACT_INDEX_SHIFT) | ((uintptr_t)store->storeId << 1) | 1);
+}
+
+CDGCompactStore* getCompactStore(CDGNode* node) {
+  assert(isCompactNode(node));
+  return compactStores[((uintptr_t)node >> 1) & (COMPACT_MAX_STORES - 1)];
+}
+
+unsigned int compactIndex(CDGNode* node) {
+  return (unsigned int)((uintptr_t)node >> COMPACT_INDEX_SHIFT);
+}
+
+CDGCompactNode* compactNode(CDGNode* node) {
+  return &getCompactStore(node)->nodes[compactIndex(node)];
+}
+
+int registerCompactStore(CDGCompactStore* store) {
+  int i;
+  pthread_mutex_lock(&compactStoresLock);
+  for ( i = 0; i < COMPACT_MAX_STORES; i++ ) {
+    if ( NULL == compactStores[i] ) {
+      compactStores[i] = store;
+      break;
+    }
+  }
+  pthread_mutex_unlock(&compactStoresLock);
+  assert(COMPACT_MAX_STORES > i);
+  return i;
+}
+
+unsigned int compactScoreBits(int score) {
+  assert(0 <= score);
+  if ( COMPACT_MAX_SCORE < score ) score = COMPACT_MAX_SCORE;
+  return (unsigned int)score << COMPACT_SCORE_SHIFT;
+}
+
+unsigned int placeCompactSet(CDGCompactStore* store, CDGNode** sources, CDGNode* node, unsigned int parent) {
+  unsigned int start = store->size + 1;
+  unsigned int index = 0;
+  unsigned int bits;
+  while ( node ) {
+    index = ++store->size;
+    sources[index] = node;
+    bits = compactScoreBits(getScore(node));
+    if ( getOutcome(node) ) bits |= COMPACT_OUTCOME;
+    if ( getTrueNodeSet(node) ) bits |= COMPACT_HAS_TRUE;
+    if ( getFalseNodeSet(node) ) bits |= COMPACT_HAS_FALSE;
+    if ( isLeaf(node) ) bits |= COMPACT_LEAF;
+    bits |= (unsigned int)getFlags(node) << COMPACT_IMPLICIT_SHIFT;
+    store->nodes[index].id = getID(node);
+    store->nodes[index].children = 0;
+    store->nodes[index].parent = parent;
+    store->nodes[index].bits = bits;
+    store->exprs[index] = internString(store->strings, getExpr(node));
+    node = getNextNode(node);
+  }
+  store->nodes[index].bits |= COMPACT_LAST;
+  return start;
+}
+
+CDGNode* compactCDG(CDGNode* root) {
+  assert(NULL != root);
+  assert(!isCompactNode(root));
+  int size = getPathLength(root);
+  CDGCompactStore* store = (CDGCompactStore*)malloc(sizeof(CDGCompactStore));
+  CDGNode** sources = (CDGNode**)malloc(sizeof(CDGNode*) * (size + 1));
+  assert(NULL != store && NULL != sources);
+  store->nodes = (CDGCompactNode*)malloc(sizeof(CDGCompactNode) * (size + 1));
+  store->exprs = (unsigned int*)malloc(sizeof(unsigned int) * (size + 1));
+  assert(NULL != store->nodes && NULL != store->exprs);
+  store->strings = newInternTable();
+  store->size = 0;
+  memset(&store->nodes[0], 0, sizeof(CDGCompactNode));
+  store->exprs[0] = 0;
+
+  unsigned int i, start, trueCnt;
+  placeCompactSet(store, sources, root, 0);
+  for ( i = 1; i <= (unsigned int)store->size; i++ ) {
+    if ( getTrueNodeSet(sources[i]) ) {
+      start = placeCompactSet(store, sources, getTrueNodeSet(sources[i]), i);
+      store->nodes[i].children = start;
+      trueCnt = store->size + 1 - start;
+      if ( COMPACT_TRUE_CNT_MASK < trueCnt ) trueCnt = COMPACT_TRUE_CNT_MASK;
+      store->nodes[i].bits |= trueCnt << COMPACT_TRUE_CNT_SHIFT;
+    }
+    if ( getFalseNodeSet(sources[i]) ) {
+      start = placeCompactSet(store, sources, getFalseNodeSet(sources[i]), i);
+      if ( 0 == store->nodes[i].children ) store->nodes[i].children = start;
+    }
+  }
+  assert(size == store->size);
+  free(sources);
+  store->storeId = registerCompactStore(store);
+  return compactHandle(store, 1);
+}
+
+size_t getCompactCDGMemory(CDGNode* node) {
+  CDGCompactStore* store = getCompactStore(node);
+  CDGInternTable* strings = store->strings;
+  size_t bytes = sizeof(CDGCompactStore) + sizeof(CDGInternTable);
+  int i;
+  bytes += (store->size + 1) * (sizeof(CDGCompactNode) + sizeof(unsigned int));
+  bytes += strings->capacity * sizeof(char*) + strings->slotCnt * sizeof(int);
+  for ( i = 0; i < strings->size; i++ ) {
+    bytes += strlen(strings->strings[i]) + 1;
+  }
+  return bytes;
+}
+
+void deleteCompactCDG(CDGNode* node) {
+  CDGCompactStore* store = getCompactStore(node);
+  pthread_mutex_lock(&compactStoresLock);
+  compactStores[store->storeId] = NULL;
+  pthread_mutex_unlock(&compactStoresLock);
+  deleteInternTable(store->strings);
+  free(store->exprs);
+  free(store->nodes);
+  free(store);
+}
+
+int compactGetID(CDGNode* node) {
+  return compactNode(node)->id;
+}
+
+int compactGetScore(CDGNode* node) {
+  return (int)(compactNode(node)->bits >> COMPACT_SCORE_SHIFT);
+}
+
+CDGNode* compactSetScore(CDGNode* node, int score) {
+  CDGCompactNode* n = compactNode(node);
+  n->bits = (n->bits & ((1u << COMPACT_SCORE_SHIFT) - 1)) | compactScoreBits(score);
+  return node;
+}
+
+int compactGetOutcome(CDGNode* node) {
+  return (int)(compactNode(node)->bits & COMPACT_OUTCOME);
+}
+
+CDGNode* compactSetOutcome(CDGNode* node, int outcome) {
+  CDGCompactNode* n = compactNode(node);
+  if ( outcome ) {
+    n->bits |= COMPACT_OUTCOME;
+  } else {
+    n->bits &= ~COMPACT_OUTCOME;
+  }
+  return node;
+}
+
+int compactGetFlags(CDGNode* node) {
+  return (int)(compactNode(node)->bits >> COMPACT_IMPLICIT_SHIFT) & (CDG_IMPLICIT_TRUE | CDG_IMPLICIT_FALSE);
+}
+
+CDGNode* compactSetFlags(CDGNode* node, int flags) {
+  CDGCompactNode* n = compactNode(node);
+  n->bits &= ~((unsigned int)(CDG_IMPLICIT_TRUE | CDG_IMPLICIT_FALSE) << COMPACT_IMPLICIT_SHIFT);
+  n->bits |= (unsigned int)flags << COMPACT_IMPLICIT_SHIFT;
+  return node;
+}
+
+char* compactGetExpr(CDGNode* node) {
+  CDGCompactStore* store = getCompactStore(node);
+  return (char*)getInternedString(store->strings, store->exprs[compactIndex(node)]);
+}
+
+CDGNode* compactGetTrueNodeSet(CDGNode* node) {
+  CDGCompactStore* store = getCompactStore(node);
+  CDGCompactNode* n = &store->nodes[compactIndex(node)];
+  if ( !(n->bits & COMPACT_HAS_TRUE) ) return NULL;
+  return compactHandle(store, n->children);
+}
+
+CDGNode* compactGetFalseNodeSet(CDGNode* node) {
+  CDGCompactStore* store = getCompactStore(node);
+  CDGCompactNode* n = &store->nodes[compactIndex(node)];
+  if ( !(n->bits & COMPACT_HAS_FALSE) ) return NULL;
+  if ( !(n->bits & COMPACT_HAS_TRUE) ) return compactHandle(store, n->children);
+  unsigned int trueCnt = (n->bits >> COMPACT_TRUE_CNT_SHIFT) & COMPACT_TRUE_CNT_MASK;
+  if ( COMPACT_TRUE_CNT_MASK > trueCnt ) return compactHandle(store, n->children + trueCnt);
+  unsigned int index = n->children;
+  while ( !(store->nodes[index].bits & COMPACT_LAST) ) index++;
+  return compactHandle(store, index + 1);
+}
+
+CDGNode* compactGetParent(CDGNode* node) {
+  CDGCompactStore* store = getCompactStore(node);
+  return compactHandle(store, store->nodes[compactIndex(node)].parent);
+}
+
+CDGNode* compactGetNextNode(CDGNode* node) {
+  CDGCompactStore* store = getCompactStore(node);
+  unsigned int index = compactIndex(node);
+  if ( store->nodes[index].bits & COMPACT_LAST ) return NULL;
+  return compactHandle(store, index + 1);
+}
@@ -0,0 +1,115 @@
+#ifndef CDG_COMPACT_H
+#define CDG_COMPACT_H
+
+#include <stdint.h>
+#include "cdg.h"
+#include "cdgWire.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Compact storage mode
+ *
+ * A compact CDG keeps all its nodes in one array of 16 byte CDGCompactNodes. Nodes of a
+ * sibling set are stored next to each other, the trueNodeSet of a node immediately followed
+ * by its falseNodeSet, so that next and the children only need one index. Predicates are
+ * interned once per CDG and referred to by handle.
+ *
+ * Compact nodes are handed out as tagged CDGNode pointers (lowest bit set) which carry the
+ * store and the index of the node, index << COMPACT_INDEX_SHIFT | storeId << 1 | 1. Every
+ * accessor of cdg.h (getID, getScore, getTrueNodeSet, ...) as well as updateCDG, coverNodes,
+ * getTopPaths, getFeasiblePath and the transactions accept them. Their members must never
+ * be dereferenced directly and the structure of a compact CDG cannot be modified */
+
+#define COMPACT_OUTCOME 0x1
+#define COMPACT_LEAF 0x2
+#define COMPACT_LAST 0x4
+#define COMPACT_HAS_TRUE 0x8
+#define COMPACT_HAS_FALSE 0x10
+#define COMPACT_TRUE_CNT_SHIFT 5
+#define COMPACT_TRUE_CNT_MASK 0x1f
+#define COMPACT_IMPLICIT_SHIFT 10
+#define COMPACT_SCORE_SHIFT 12
+#define COMPACT_MAX_SCORE 0xfffff
+#define COMPACT_INDEX_SHIFT 16
+
+/* CDGCompactNode - A node of a compact CDG
+ * @id - Statement id for decision statement and block id for others
+ * @children - Index of the first node of the trueNodeSet, or of the falseNodeSet if the
+ *             trueNodeSet is empty. 0 for leaves
+ * @parent - Index of the parent, 0 for the nodes of the root set
+ * @bits - score << COMPACT_SCORE_SHIFT | node flags << COMPACT_IMPLICIT_SHIFT |
+ *         size of trueNodeSet << COMPACT_TRUE_CNT_SHIFT | compact flags.
+ *         The score saturates at COMPACT_MAX_SCORE and the size of the trueNodeSet at
+ *         COMPACT_TRUE_CNT_MASK, in which case the falseNodeSet is found by a scan */
+
+typedef struct CDGCompactNode {
+  int id;
+  unsigned int children;
+  unsigned int parent;
+  unsigned int bits;
+} CDGCompactNode;
+
+/* CDGCompactStore - Storage of a compact CDG
+ * @nodes - Nodes, indexed from 1
+ * @exprs - Predicate handle of each node into strings, 0 for none
+ * @strings - Interned predicates
+ * @size - Number of nodes
+ * @storeId - Slot of the store in the registry of compact stores */
+
+typedef struct CDGCompactStore {
+  CDGCompactNode* nodes;
+  unsigned int* exprs;
+  CDGInternTable* strings;
+  int size;
+  int storeId;
+} CDGCompactStore;
+
+/* isCompactNode - Returns non zero if the node is a compact node handle
+ * @node - a CDG node */
+
+#define isCompactNode(node) (((uintptr_t)(node)) & 1)
+
+/* compactCDG - Copies a CDG into a new compact CDG and returns the handle of its root.
+ *              The source CDG is left untouched. Delete the compact CDG with deleteCDG
+ * @root - Root of CDG */
+
+CDGNode* compactCDG(CDGNode* root);
+
+/* getCompactStore - Returns the storage of the compact CDG a compact node belongs to
+ * @node - a compact node */
+
+CDGCompactStore* getCompactStore(CDGNode* node);
+
+/* getCompactCDGMemory - Returns the number of bytes used by the compact CDG a compact node
+ *                       belongs to, including its interned predicates
+ * @node - a compact node */
+
+size_t getCompactCDGMemory(CDGNode* node);
+
+/* deleteCompactCDG - Deallocates the compact CDG a compact node belongs to
+ * @node - a compact node */
+
+void deleteCompactCDG(CDGNode* node);
+
+/* Accessors of compact nodes, used by the accessors of cdg.h */
+
+int compactGetID(CDGNode* node);
+int compactGetScore(CDGNode* node);
+CDGNode* compactSetScore(CDGNode* node, int score);
+int compactGetOutcome(CDGNode* node);
+CDGNode* compactSetOutcome(CDGNode* node, int outcome);
+int compactGetFlags(CDGNode* node);
+CDGNode* compactSetFlags(CDGNode* node, int flags);
+char* compactGetExpr(CDGNode* node);
+CDGNode* compactGetTrueNodeSet(CDGNode* node);
+CDGNode* compactGetFalseNodeSet(CDGNode* node);
+CDGNode* compactGetParent(CDGNode* node);
+CDGNode* compactGetNextNode(CDGNode* node);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
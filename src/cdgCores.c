@@ -0,0 +1,270 @@
+#include <string.h>
+#include "cdgCores.h"
+
+void newBranchSet(CDGBranchSet* set) {
+  assert(NULL != set);
+  set->branches = NULL;
+  set->size = 0;
+  set->capacity = 0;
+}
+
+/* Index of the first branch from an index on that is not below (id, outcome) */
+
+int findBranch(CDGBranchSet* set, int from, int id, int outcome) {
+  int low = from, high = set->size, mid;
+  while ( low < high ) {
+    mid = (low + high) / 2;
+    if ( set->branches[mid].id < id || (set->branches[mid].id == id && set->branches[mid].outcome < outcome) ) {
+      low = mid + 1;
+    } else {
+      high = mid;
+    }
+  }
+  return low;
+}
+
+int isBranchAt(CDGBranchSet* set, int i, int id, int outcome) {
+  return i < set->size && id == set->branches[i].id && outcome == set->branches[i].outcome;
+}
+
+void addBranch(CDGBranchSet* set, int id, int outcome) {
+  assert(NULL != set);
+  outcome = 0 != outcome;
+  int i = findBranch(set, 0, id, outcome);
+  if ( isBranchAt(set, i, id, outcome) ) return;
+  if ( set->size == set->capacity ) {
+    set->capacity = 0 == set->capacity ? 16 : 2 * set->capacity;
+    set->branches = (CDGBranch*)realloc(set->branches, sizeof(CDGBranch) * set->capacity);
+    assert(NULL != set->branches);
+  }
+  memmove(&set->branches[i + 1], &set->branches[i], sizeof(CDGBranch) * (set->size - i));
+  set->branches[i].id = id;
+  set->branches[i].outcome = outcome;
+  set->size++;
+}
+
+void removeBranch(CDGBranchSet* set, int id, int outcome) {
+  outcome = 0 != outcome;
+  int i = findBranch(set, 0, id, outcome);
+  if ( !isBranchAt(set, i, id, outcome) ) return;
+  memmove(&set->branches[i], &set->branches[i + 1], sizeof(CDGBranch) * (set->size - i - 1));
+  set->size--;
+}
+
+int hasBranch(CDGBranchSet* set, int id, int outcome) {
+  assert(NULL != set);
+  outcome = 0 != outcome;
+  return isBranchAt(set, findBranch(set, 0, id, outcome), id, outcome);
+}
+
+void deleteBranchSet(CDGBranchSet* set) {
+  assert(NULL != set);
+  free(set->branches);
+  newBranchSet(set);
+}
+
+CDGCoreTrie* newCoreTrieNode(int id, int outcome) {
+  CDGCoreTrie* trie;
+  trie = (CDGCoreTrie*)malloc(sizeof(CDGCoreTrie));
+  assert(NULL != trie);
+  trie->id = id;
+  trie->outcome = outcome;
+  trie->coreEnds = 0;
+  trie->children = NULL;
+  trie->next = NULL;
+  return trie;
+}
+
+CDGCores* newInfeasibleCores() {
+  CDGCores* cores;
+  cores = (CDGCores*)malloc(sizeof(CDGCores));
+  assert(NULL != cores);
+  cores->trie = newCoreTrieNode(-1, 1);
+  newBranchSet(&cores->branches);
+  cores->holders = NULL;
+  cores->list = NULL;
+  cores->coreCnt = 0;
+  cores->coreCapacity = 0;
+  return cores;
+}
+
+/* Returns 1 if the trie below a node holds a core whose remaining branches are all in a set
+   from an index on. Children are in increasing order, so each one is looked up past the branch
+   matched by its parent */
+
+int matchCore(CDGCoreTrie* trie, CDGBranchSet* set, int from) {
+  CDGCoreTrie* child;
+  int i;
+  for ( child = trie->children; child; child = child->next ) {
+    i = findBranch(set, from, child->id, child->outcome);
+    if ( i == set->size ) break;
+    if ( !isBranchAt(set, i, child->id, child->outcome) ) continue;
+    if ( child->coreEnds || matchCore(child, set, i + 1) ) return 1;
+  }
+  return 0;
+}
+
+CDGCoreTrie* getCoreChild(CDGCoreTrie* trie, CDGBranch* branch) {
+  CDGCoreTrie** link = &trie->children;
+  CDGCoreTrie* child;
+  while ( *link && ((*link)->id < branch->id || ((*link)->id == branch->id && (*link)->outcome < branch->outcome)) ) {
+    link = &(*link)->next;
+  }
+  if ( *link && (*link)->id == branch->id && (*link)->outcome == branch->outcome ) return *link;
+  child = newCoreTrieNode(branch->id, branch->outcome);
+  child->next = *link;
+  *link = child;
+  return child;
+}
+
+/* Adds a branch of a stored core to the branches of the cores and to the cores holding it */
+
+void addCoreBranch(CDGCores* cores, int id, int outcome, int core) {
+  int i = findBranch(&cores->branches, 0, id, outcome);
+  int capacity = cores->branches.capacity;
+  CDGCoreList* holders;
+  if ( !isBranchAt(&cores->branches, i, id, outcome) ) {
+    addBranch(&cores->branches, id, outcome);
+    if ( capacity != cores->branches.capacity ) {
+      cores->holders = (CDGCoreList*)realloc(cores->holders, sizeof(CDGCoreList) * cores->branches.capacity);
+      assert(NULL != cores->holders);
+    }
+    memmove(&cores->holders[i + 1], &cores->holders[i], sizeof(CDGCoreList) * (cores->branches.size - i - 1));
+    cores->holders[i].cores = NULL;
+    cores->holders[i].size = 0;
+    cores->holders[i].capacity = 0;
+  }
+  holders = &cores->holders[i];
+  if ( holders->size == holders->capacity ) {
+    holders->capacity = 0 == holders->capacity ? 4 : 2 * holders->capacity;
+    holders->cores = (int*)realloc(holders->cores, sizeof(int) * holders->capacity);
+    assert(NULL != holders->cores);
+  }
+  holders->cores[holders->size++] = core;
+}
+
+int addInfeasibleCore(CDGCores* cores, CDGNode* nodes[], int size) {
+  assert(NULL != cores);
+  assert(0 < size);
+  CDGBranchSet core;
+  CDGCoreTrie* trie = cores->trie;
+  int i;
+  newBranchSet(&core);
+  for ( i = 0; i < size; i++ ) addBranch(&core, getID(nodes[i]), getOutcome(nodes[i]));
+  if ( matchCore(cores->trie, &core, 0) ) {
+    deleteBranchSet(&core);
+    return 0;
+  }
+  for ( i = 0; i < core.size; i++ ) {
+    trie = getCoreChild(trie, &core.branches[i]);
+    addCoreBranch(cores, core.branches[i].id, core.branches[i].outcome, cores->coreCnt);
+  }
+  trie->coreEnds = 1;
+  if ( cores->coreCnt == cores->coreCapacity ) {
+    cores->coreCapacity = 0 == cores->coreCapacity ? 16 : 2 * cores->coreCapacity;
+    cores->list = (CDGBranchSet*)realloc(cores->list, sizeof(CDGBranchSet) * cores->coreCapacity);
+    assert(NULL != cores->list);
+  }
+  cores->list[cores->coreCnt++] = core;
+  return 1;
+}
+
+int getInfeasibleCoreCount(CDGCores* cores) {
+  assert(NULL != cores);
+  return cores->coreCnt;
+}
+
+int completesCore(CDGCores* cores, CDGBranchSet* set, int id, int outcome) {
+  assert(NULL != cores);
+  assert(NULL != set);
+  if ( !hasBranch(&cores->branches, id, outcome) || hasBranch(set, id, outcome) ) return 0;
+  addBranch(set, id, outcome);
+  int completed = matchCore(cores->trie, set, 0);
+  removeBranch(set, id, outcome);
+  return completed;
+}
+
+int isInTrueNodeSet(CDGNode* parent, CDGNode* node) {
+  CDGNode* child;
+  for ( child = getTrueNodeSet(parent); child; child = getNextNode(child) ) {
+    if ( node == child ) return 1;
+  }
+  return 0;
+}
+
+/* Returns 1 if every branch of a core but (id, outcome) is in a chain of branches */
+
+int isCoreInChain(CDGBranchSet* core, CDGBranch* chain, int size, int id, int outcome) {
+  int i, j;
+  for ( i = 0; i < core->size; i++ ) {
+    if ( id == core->branches[i].id && outcome == core->branches[i].outcome ) continue;
+    for ( j = 0; j < size; j++ ) {
+      if ( core->branches[i].id == chain[j].id && core->branches[i].outcome == chain[j].outcome ) break;
+    }
+    if ( j == size ) return 0;
+  }
+  return 1;
+}
+
+int isBranchBlocked(CDGCores* cores, CDGNode* node, int outcome) {
+  assert(NULL != cores);
+  assert(NULL != node);
+  outcome = 0 != outcome;
+  int id = getID(node);
+  int i = findBranch(&cores->branches, 0, id, outcome);
+  if ( !isBranchAt(&cores->branches, i, id, outcome) ) return 0;
+  CDGCoreList* holders = &cores->holders[i];
+  CDGBranch buffer[CDG_CORE_CHAIN];
+  CDGBranch* chain = buffer;
+  CDGNode* parent;
+  int size = 0, capacity = CDG_CORE_CHAIN;
+  int parentId, side, blocked = 0;
+  for ( parent = getParent(node); parent; node = parent, parent = getParent(node) ) {
+    parentId = getID(parent);
+    i = findBranch(&cores->branches, 0, parentId, 0);
+    if ( !isBranchAt(&cores->branches, i, parentId, 0) && !isBranchAt(&cores->branches, i, parentId, 1) ) continue;
+    side = isInTrueNodeSet(parent, node);
+    if ( !hasBranch(&cores->branches, parentId, side) ) continue;
+    if ( size == capacity ) {
+      capacity *= 2;
+      if ( buffer == chain ) {
+        chain = (CDGBranch*)malloc(sizeof(CDGBranch) * capacity);
+        assert(NULL != chain);
+        memcpy(chain, buffer, sizeof(buffer));
+      } else {
+        chain = (CDGBranch*)realloc(chain, sizeof(CDGBranch) * capacity);
+        assert(NULL != chain);
+      }
+    }
+    chain[size].id = parentId;
+    chain[size].outcome = side;
+    size++;
+  }
+  for ( i = 0; i < holders->size && !blocked; i++ ) {
+    blocked = isCoreInChain(&cores->list[holders->cores[i]], chain, size, id, outcome);
+  }
+  if ( buffer != chain ) free(chain);
+  return blocked;
+}
+
+void deleteCoreTrie(CDGCoreTrie* trie) {
+  CDGCoreTrie* next;
+  while ( trie ) {
+    next = trie->next;
+    deleteCoreTrie(trie->children);
+    free(trie);
+    trie = next;
+  }
+}
+
+void deleteInfeasibleCores(CDGCores* cores) {
+  assert(NULL != cores);
+  int i;
+  deleteCoreTrie(cores->trie);
+  for ( i = 0; i < cores->branches.size; i++ ) free(cores->holders[i].cores);
+  for ( i = 0; i < cores->coreCnt; i++ ) deleteBranchSet(&cores->list[i]);
+  deleteBranchSet(&cores->branches);
+  free(cores->holders);
+  free(cores->list);
+  free(cores);
+}
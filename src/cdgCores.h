@@ -0,0 +1,163 @@
+#ifndef CDG_CORES_H
+#define CDG_CORES_H
+
+#include "cdg.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Infeasible cores
+ *
+ * An infeasible core is a set of branches (id, outcome) the solver proved can not be taken
+ * together, e.g. the decisions of the unsat core of a path. Cores are stored in a trie of
+ * their branches sorted by id and outcome, so cores sharing a prefix share its trie nodes,
+ * and a core implied by an already stored smaller one is not stored at all.
+ *
+ * A set of cores belongs to the scoring of a CDG (see CDGScoring), usually that of its handle
+ * (see cdgAddInfeasibleCore). Scored with it, updateScoreWith scores a branch as 0 if it
+ * completes a core together with the branches leading to it from the root. No top path
+ * proposes such a branch and the scores of its ancestors only count reachable blocks.
+ * Within a transaction scored with the cores (see beginTransactionWith), getTopPath also
+ * tracks the branches already on the path it builds and leaves out a decision whose branch
+ * completes a core with decisions of other subtrees, taking the other branch of the
+ * decision instead if that one is free and has a score */
+
+/* CDG_CORE_CHAIN - Number of ancestor branches isBranchBlocked holds on the stack */
+
+#define CDG_CORE_CHAIN 64
+
+/* CDGBranch - A branch of a decision node
+ * @id - Id of the decision node
+ * @outcome - Outcome of the branch, 0 or 1 */
+
+typedef struct CDGBranch {
+  int id;
+  int outcome;
+} CDGBranch;
+
+/* CDGBranchSet - Set of branches kept sorted by id and outcome
+ * @branches - The branches
+ * @size - Number of branches
+ * @capacity - Number of branches allocated */
+
+typedef struct CDGBranchSet {
+  CDGBranch* branches;
+  int size;
+  int capacity;
+} CDGBranchSet;
+
+/* CDGCoreTrie - Trie node of an infeasible core branch
+ * @id - Id of the decision, -1 for the trie root
+ * @outcome - Outcome of the decision
+ * @coreEnds - 1 if a core ends at this branch, 0 otherwise
+ * @children - First branch following this one, in increasing order
+ * @next - Next branch following the same prefix */
+
+typedef struct CDGCoreTrie {
+  int id;
+  int outcome;
+  int coreEnds;
+  struct CDGCoreTrie* children;
+  struct CDGCoreTrie* next;
+} CDGCoreTrie;
+
+/* CDGCoreList - Cores holding a branch
+ * @cores - Indices of the cores, in the order they were stored
+ * @size - Number of cores
+ * @capacity - Number of indices allocated */
+
+typedef struct CDGCoreList {
+  int* cores;
+  int size;
+  int capacity;
+} CDGCoreList;
+
+/* CDGCores - Set of infeasible cores
+ * @trie - Trie of the cores
+ * @branches - Every branch that is part of a core
+ * @holders - Cores holding each branch of branches, in the same order
+ * @list - Branches of each core, in the order they were stored
+ * @coreCnt - Number of cores stored
+ * @coreCapacity - Number of cores allocated in list */
+
+typedef struct CDGCores {
+  CDGCoreTrie* trie;
+  CDGBranchSet branches;
+  CDGCoreList* holders;
+  CDGBranchSet* list;
+  int coreCnt;
+  int coreCapacity;
+} CDGCores;
+
+/* newBranchSet - Initializes an empty branch set
+ * @set - Branch set to initialize */
+
+void newBranchSet(CDGBranchSet* set);
+
+/* addBranch - Adds a branch to the set if it is not in it yet
+ * @set - a branch set
+ * @id - Id of the decision node
+ * @outcome - Outcome of the branch */
+
+void addBranch(CDGBranchSet* set, int id, int outcome);
+
+/* hasBranch - Returns 1 if a branch is in the set, 0 otherwise
+ * @set - a branch set
+ * @id - Id of the decision node
+ * @outcome - Outcome of the branch */
+
+int hasBranch(CDGBranchSet* set, int id, int outcome);
+
+/* deleteBranchSet - Deallocates the branches of a set and empties it
+ * @set - a branch set */
+
+void deleteBranchSet(CDGBranchSet* set);
+
+/* newInfeasibleCores - Creates and returns an empty set of cores */
+
+CDGCores* newInfeasibleCores();
+
+/* addInfeasibleCore - Adds a core. Returns 1 if it was stored, 0 if a stored core implies it.
+ *                     Scores scored with the cores have to be recomputed (see updateCDGWith)
+ * @cores - a set of cores
+ * @nodes - Array of CDGNodes. Will have id and outcome set
+ * @size - Size of array, at least 1 */
+
+int addInfeasibleCore(CDGCores* cores, CDGNode* nodes[], int size);
+
+/* getInfeasibleCoreCount - Returns the number of cores stored
+ * @cores - a set of cores */
+
+int getInfeasibleCoreCount(CDGCores* cores);
+
+/* completesCore - Returns 1 if adding a branch to a set of branches, none of whose subsets
+ *                 is a core, makes a subset of it a core. 0 otherwise
+ * @cores - a set of cores
+ * @set - Branches already taken
+ * @id - Id of the decision node
+ * @outcome - Outcome of the branch */
+
+int completesCore(CDGCores* cores, CDGBranchSet* set, int id, int outcome);
+
+/* isBranchBlocked - Returns 1 if a branch of a decision node completes a core together with
+ *                   the branches leading to the node from the root, 0 otherwise
+ *                 - Only the cores holding the branch are checked, against the ancestors
+ *                   whose branch is part of a core, without allocating unless more than
+ *                   CDG_CORE_CHAIN of them are
+ * @cores - a set of cores
+ * @node - a decision node
+ * @outcome - Outcome of the branch */
+
+int isBranchBlocked(CDGCores* cores, CDGNode* node, int outcome);
+
+/* deleteInfeasibleCores - Deallocates a set of cores. It must not be scored with anymore
+ * @cores - a set of cores */
+
+void deleteInfeasibleCores(CDGCores* cores);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
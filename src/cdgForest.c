@@ -0,0 +1,217 @@
+#include "cdgForest.h"
+
+#define INITIAL_FOREST_CAPACITY 16
+
+CDGFunction* getForestFunction(CDGForest* forest, int function) {
+  assert(NULL != forest);
+  assert(0 <= function && function < forest->size);
+  return &forest->functions[function];
+}
+
+void forestHeapSwap(CDGForest* forest, int i, int j) {
+  int temp = forest->heap[i];
+  forest->heap[i] = forest->heap[j];
+  forest->heap[j] = temp;
+  forest->functions[forest->heap[i]].heapIndex = i;
+  forest->functions[forest->heap[j]].heapIndex = j;
+}
+
+int forestHeapScore(CDGForest* forest, int i) {
+  return forest->functions[forest->heap[i]].score;
+}
+
+void forestHeapSiftUp(CDGForest* forest, int i) {
+  int parent;
+  while ( 0 < i ) {
+    parent = (i - 1) / 2;
+    if ( forestHeapScore(forest, parent) >= forestHeapScore(forest, i) ) return;
+    forestHeapSwap(forest, i, parent);
+    i = parent;
+  }
+}
+
+void forestHeapSiftDown(CDGForest* forest, int i) {
+  int largest, child;
+  while (1) {
+    largest = i;
+    child = 2 * i + 1;
+    if ( child < forest->size && forestHeapScore(forest, child) > forestHeapScore(forest, largest) )
+      largest = child;
+    child++;
+    if ( child < forest->size && forestHeapScore(forest, child) > forestHeapScore(forest, largest) )
+      largest = child;
+    if ( largest == i ) return;
+    forestHeapSwap(forest, i, largest);
+    i = largest;
+  }
+}
+
+void rescoreFunction(CDGForest* forest, int function) {
+  CDGFunction* func = getForestFunction(forest, function);
+  int oldScore = func->score;
+  func->score = getConditionalNodeSum(func->root);
+  if ( func->score > oldScore ) {
+    forestHeapSiftUp(forest, func->heapIndex);
+  } else if ( func->score < oldScore ) {
+    forestHeapSiftDown(forest, func->heapIndex);
+  }
+}
+
+CDGForest* newForest() {
+  CDGForest* forest;
+  forest = (CDGForest*)malloc(sizeof(CDGForest));
+  assert(NULL != forest);
+  forest->size = 0;
+  forest->capacity = INITIAL_FOREST_CAPACITY;
+  forest->functions = (CDGFunction*)malloc(sizeof(CDGFunction) * forest->capacity);
+  forest->heap = (int*)malloc(sizeof(int) * forest->capacity);
+  assert(NULL != forest->functions && NULL != forest->heap);
+  return forest;
+}
+
+int addFunction(CDGForest* forest, CDGNode* root) {
+  assert(NULL != forest);
+  assert(NULL != root);
+  if ( forest->size == forest->capacity ) {
+    forest->capacity *= 2;
+    forest->functions = (CDGFunction*)realloc(forest->functions, sizeof(CDGFunction) * forest->capacity);
+    forest->heap = (int*)realloc(forest->heap, sizeof(int) * forest->capacity);
+    assert(NULL != forest->functions && NULL != forest->heap);
+  }
+  int function = forest->size++;
+  CDGFunction* func = &forest->functions[function];
+  func->root = updateCDG(root);
+  func->score = getConditionalNodeSum(root);
+  func->heapIndex = function;
+  func->calls = NULL;
+  func->callers = NULL;
+  forest->heap[function] = function;
+  forestHeapSiftUp(forest, function);
+  return function;
+}
+
+CDGNode* getFunctionRoot(CDGForest* forest, int function) {
+  return getForestFunction(forest, function)->root;
+}
+
+int getFunctionScore(CDGForest* forest, int function) {
+  return getForestFunction(forest, function)->score;
+}
+
+CDGCallSite* newCallSite(int function, int blockId, CDGCallSite* next) {
+  CDGCallSite* site;
+  site = (CDGCallSite*)malloc(sizeof(CDGCallSite));
+  assert(NULL != site);
+  site->function = function;
+  site->blockId = blockId;
+  site->next = next;
+  return site;
+}
+
+void addCallSite(CDGForest* forest, int caller, int blockId, int callee) {
+  CDGFunction* callerFunc = getForestFunction(forest, caller);
+  CDGFunction* calleeFunc = getForestFunction(forest, callee);
+  callerFunc->calls = newCallSite(callee, blockId, callerFunc->calls);
+  calleeFunc->callers = newCallSite(caller, blockId, calleeFunc->callers);
+}
+
+CDGCallSite* getCallSites(CDGForest* forest, int function) {
+  return getForestFunction(forest, function)->calls;
+}
+
+CDGCallSite* getCallers(CDGForest* forest, int function) {
+  return getForestFunction(forest, function)->callers;
+}
+
+int getBestFunction(CDGForest* forest) {
+  assert(NULL != forest);
+  if ( 0 == forest->size ) return -1;
+  return forest->heap[0];
+}
+
+void forestCoverNodes(CDGForest* forest, int function, CDGNode* nodes[], int size) {
+  coverNodes(getForestFunction(forest, function)->root, nodes, size);
+  rescoreFunction(forest, function);
+}
+
+CDGForestPath* newForestPath(int function, CDGNode* node) {
+  CDGForestPath* path;
+  path = (CDGForestPath*)malloc(sizeof(CDGForestPath));
+  assert(NULL != path);
+  path->function = function;
+  path->node = node;
+  path->next = NULL;
+  return path;
+}
+
+CDGForestPath* forestGetTopPaths(CDGForest* forest, int numberOfPaths) {
+  assert(NULL != forest);
+  if ( 0 == forest->size ) return NULL;
+  CDGTransaction** txns = (CDGTransaction**)calloc(forest->size, sizeof(CDGTransaction*));
+  int* touched = (int*)malloc(sizeof(int) * forest->size);
+  assert(NULL != txns && NULL != touched);
+  int touchedCnt = 0;
+  CDGForestPath* pathHead = NULL;
+  CDGForestPath* currPath = NULL;
+  CDGNode* node;
+  int function;
+  while ( numberOfPaths-- ) {
+    function = forest->heap[0];
+    if ( 0 == forest->functions[function].score ) break;
+    if ( NULL == txns[function] ) {
+      txns[function] = beginTransaction();
+      touched[touchedCnt++] = function;
+    }
+    node = getTopPath(forest->functions[function].root, txns[function]);
+    if ( NULL != node ) {
+      if ( NULL == pathHead ) {
+        pathHead = newForestPath(function, node);
+        currPath = pathHead;
+      } else {
+        currPath->next = newForestPath(function, node);
+        currPath = currPath->next;
+      }
+    }
+    rescoreFunction(forest, function);
+  }
+  while ( touchedCnt-- ) {
+    function = touched[touchedCnt];
+    rollbackTransaction(txns[function]);
+    rescoreFunction(forest, function);
+  }
+  free(touched);
+  free(txns);
+  return pathHead;
+}
+
+void deleteForestPaths(CDGForestPath* path) {
+  CDGForestPath* next;
+  while ( path ) {
+    next = path->next;
+    deleteCDG(path->node);
+    free(path);
+    path = next;
+  }
+}
+
+void deleteCallSites(CDGCallSite* site) {
+  CDGCallSite* next;
+  while ( site ) {
+    next = site->next;
+    free(site);
+    site = next;
+  }
+}
+
+void deleteForest(CDGForest* forest) {
+  assert(NULL != forest);
+  int i;
+  for ( i = 0; i < forest->size; i++ ) {
+    deleteCDG(forest->functions[i].root);
+    deleteCallSites(forest->functions[i].calls);
+    deleteCallSites(forest->functions[i].callers);
+  }
+  free(forest->functions);
+  free(forest->heap);
+  free(forest);
+}
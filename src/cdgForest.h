@@ -0,0 +1,140 @@
+#ifndef CDG_FOREST_H
+#define CDG_FOREST_H
+
+#include "cdg.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* CDGCallSite - Interprocedural link between two functions of a forest
+ * @function - Callee (in the calls list) or caller (in the callers list) function
+ * @blockId - Id of the basic block in the caller which contains the call
+ * @next - Next call site in the list */
+
+typedef struct CDGCallSite {
+  int function;
+  int blockId;
+  struct CDGCallSite* next;
+} CDGCallSite;
+
+/* CDGFunction - A per-function CDG held by a forest
+ * @root - Root of the CDG of the function
+ * @score - Score of the top path of the function, key of the forest heap
+ * @heapIndex - Position of the function in the forest heap
+ * @calls - Call sites in this function
+ * @callers - Call sites of other functions calling this function */
+
+typedef struct CDGFunction {
+  CDGNode* root;
+  int score;
+  int heapIndex;
+  CDGCallSite* calls;
+  CDGCallSite* callers;
+} CDGFunction;
+
+/* CDGForest - Registry of the CDGs of all functions of a program
+ * @functions - Functions indexed by function id
+ * @size - Number of functions
+ * @capacity - Allocated size of functions and heap
+ * @heap - Function ids ordered as a max-heap on their score */
+
+typedef struct CDGForest {
+  CDGFunction* functions;
+  int size;
+  int capacity;
+  int* heap;
+} CDGForest;
+
+/* CDGForestPath - List of top paths across the functions of a forest
+ * @function - Function id the path belongs to
+ * @node - Head of the path, as returned by getTopPaths
+ * @next - Next path of the list */
+
+typedef struct CDGForestPath {
+  int function;
+  CDGNode* node;
+  struct CDGForestPath* next;
+} CDGForestPath;
+
+/* newForest - Creates and returns an empty forest */
+
+CDGForest* newForest();
+
+/* addFunction - Adds the CDG of a function to the forest, updates its scores and returns
+ *               the id of the function. The forest takes ownership of the CDG
+ * @forest - a forest
+ * @root - Root of the CDG of the function */
+
+int addFunction(CDGForest* forest, CDGNode* root);
+
+/* getFunctionRoot - Returns the root of the CDG of a function
+ * @forest - a forest
+ * @function - Function id */
+
+CDGNode* getFunctionRoot(CDGForest* forest, int function);
+
+/* getFunctionScore - Returns the score of the top path of a function
+ * @forest - a forest
+ * @function - Function id */
+
+int getFunctionScore(CDGForest* forest, int function);
+
+/* addCallSite - Links a basic block of the caller to the function it calls
+ * @forest - a forest
+ * @caller - Function id of the caller
+ * @blockId - Id of the basic block containing the call
+ * @callee - Function id of the callee */
+
+void addCallSite(CDGForest* forest, int caller, int blockId, int callee);
+
+/* getCallSites - Returns the list of call sites in a function
+ * @forest - a forest
+ * @function - Function id */
+
+CDGCallSite* getCallSites(CDGForest* forest, int function);
+
+/* getCallers - Returns the list of call sites calling a function
+ * @forest - a forest
+ * @function - Function id */
+
+CDGCallSite* getCallers(CDGForest* forest, int function);
+
+/* getBestFunction - Returns the id of the function with the highest scoring top path,
+ *                   -1 if the forest is empty. Runs in O(1)
+ * @forest - a forest */
+
+int getBestFunction(CDGForest* forest);
+
+/* forestCoverNodes - Covers nodes of a single function (see coverNodes) and repositions
+ *                    only that function in the forest heap
+ * @forest - a forest
+ * @function - Function id the nodes belong to
+ * @nodes - Array of CDGNodes. Will have id and outcome set
+ * @size - Size of array */
+
+void forestCoverNodes(CDGForest* forest, int function, CDGNode* nodes[], int size);
+
+/* forestGetTopPaths - Returns list of score-wise top paths across all the functions
+ *                   - Only the functions a path is taken from are visited, every other
+ *                     function is skipped through the heap
+ * @forest - a forest
+ * @numberOfPaths - Maximum number of paths to be returned */
+
+CDGForestPath* forestGetTopPaths(CDGForest* forest, int numberOfPaths);
+
+/* deleteForestPaths - Deallocates memory allocated to forest path list
+ * @path - a forest path head */
+
+void deleteForestPaths(CDGForestPath* path);
+
+/* deleteForest - Deletes the forest along with the CDGs of all its functions
+ * @forest - a forest */
+
+void deleteForest(CDGForest* forest);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,519 @@
+#include "cdgGraph.h"
+#include "cdgTrace.h"
+
+CDG* cdgNew(CDGNode* root) {
+  assert(NULL != root);
+  CDG* cdg;
+  int i;
+  cdg = (CDG*)malloc(sizeof(CDG));
+  assert(NULL != cdg);
+  cdg->scoring.hits = NULL;
+  cdg->scoring.cores = NULL;
+  cdg->root = updateCDG(root);
+  cdg->epoch = 0;
+  cdg->topPaths = NULL;
+  for ( i = 0; i < CDG_FEASIBLE_CACHE_SIZE; i++ ) {
+    cdg->feasible[i].fingerprint = 0;
+    cdg->feasible[i].path = NULL;
+    cdg->feasible[i].pathSize = 0;
+    cdg->feasible[i].ids = NULL;
+    cdg->feasible[i].size = 0;
+    cdg->feasible[i].result = NULL;
+  }
+  cdg->nextFeasible = 0;
+  cdg->index = NULL;
+  cdg->seen = NULL;
+  return cdg;
+}
+
+CDGNode* cdgRoot(CDG* cdg) {
+  assert(NULL != cdg);
+  return cdg->root;
+}
+
+unsigned long cdgEpoch(CDG* cdg) {
+  assert(NULL != cdg);
+  return cdg->epoch;
+}
+
+void clearFeasibleEntry(CDGFeasibleEntry* entry) {
+  if ( NULL == entry->result ) return;
+  releasePathSet(entry->result);
+  free(entry->path);
+  free(entry->ids);
+  entry->fingerprint = 0;
+  entry->path = NULL;
+  entry->pathSize = 0;
+  entry->ids = NULL;
+  entry->size = 0;
+  entry->result = NULL;
+}
+
+void deleteIdIndex(CDGIdIndex* index) {
+  free(index->slots);
+  free(index);
+}
+
+void clearFeasibleCache(CDG* cdg) {
+  int i;
+  for ( i = 0; i < CDG_FEASIBLE_CACHE_SIZE; i++ ) {
+    clearFeasibleEntry(&cdg->feasible[i]);
+  }
+}
+
+void startEpoch(CDG* cdg) {
+  cdg->epoch++;
+  if ( NULL != cdg->topPaths ) {
+    releasePathSet(cdg->topPaths);
+    cdg->topPaths = NULL;
+  }
+}
+
+void cdgTouch(CDG* cdg) {
+  assert(NULL != cdg);
+  startEpoch(cdg);
+  if ( NULL != cdg->index ) {
+    deleteIdIndex(cdg->index);
+    cdg->index = NULL;
+  }
+}
+
+int cdgCoverNodes(CDG* cdg, CDGNode* nodes[], int size) {
+  assert(NULL != cdg);
+  int count = coverNodesWithChanges(cdg->root, nodes, size, NULL, 0, &cdg->scoring);
+  if ( 0 < count ) startEpoch(cdg);
+  return count;
+}
+
+unsigned int hashId(int id) {
+  return (unsigned int)id * 2654435761u;
+}
+
+CDGIndexEntry* findIndexSlot(CDGIdIndex* index, int id) {
+  unsigned int mask = index->slotCnt - 1;
+  unsigned int i = hashId(id) & mask;
+  while ( NULL != index->slots[i].node && id != getID(index->slots[i].node) ) {
+    i = (i + 1) & mask;
+  }
+  return &index->slots[i];
+}
+
+void growIdIndex(CDGIdIndex* index) {
+  CDGIndexEntry* slots = index->slots;
+  int slotCnt = index->slotCnt;
+  int i;
+  index->slotCnt = 0 == slotCnt ? 64 : 2 * slotCnt;
+  index->slots = (CDGIndexEntry*)calloc(index->slotCnt, sizeof(CDGIndexEntry));
+  assert(NULL != index->slots);
+  for ( i = 0; i < slotCnt; i++ ) {
+    if ( NULL != slots[i].node ) *findIndexSlot(index, getID(slots[i].node)) = slots[i];
+  }
+  free(slots);
+}
+
+void indexNode(CDGIdIndex* index, CDGNode* node, int side) {
+  if ( 2 * (index->size + 1) > index->slotCnt ) growIdIndex(index);
+  CDGIndexEntry* slot = findIndexSlot(index, getID(node));
+  if ( NULL != slot->node ) {
+    if ( node != slot->node ) index->shadowed++;
+    return;
+  }
+  slot->node = node;
+  slot->side = side;
+  index->size++;
+}
+
+/* Indexes a node list in the order of findNode: node, trueNodeSet, falseNodeSet, next */
+
+void indexNodeList(CDGIdIndex* index, CDGNode* node, int side) {
+  while ( node ) {
+    indexNode(index, node, side);
+    indexNodeList(index, getTrueNodeSet(node), 1);
+    indexNodeList(index, getFalseNodeSet(node), 0);
+    node = getNextNode(node);
+  }
+}
+
+CDGIdIndex* getIdIndex(CDG* cdg) {
+  if ( NULL != cdg->index ) return cdg->index;
+  cdg->index = (CDGIdIndex*)malloc(sizeof(CDGIdIndex));
+  assert(NULL != cdg->index);
+  cdg->index->slots = NULL;
+  cdg->index->slotCnt = 0;
+  cdg->index->size = 0;
+  cdg->index->shadowed = 0;
+  growIdIndex(cdg->index);
+  indexNodeList(cdg->index, cdg->root, 0);
+  return cdg->index;
+}
+
+/* Rescores the ancestors of a changed node set from its parent up. Stops at the first ancestor
+   whose score and leaf state, the only things its own parent reads, did not change */
+
+void rescoreAncestors(CDG* cdg, CDGNode* node, int wasLeaf) {
+  int oldScore;
+  while ( node ) {
+    oldScore = getScore(node);
+    updateScoreWith(node, &cdg->scoring);
+    if ( oldScore == getScore(node) && wasLeaf == isLeaf(node) ) break;
+    node = getParent(node);
+    wasLeaf = 0;
+  }
+}
+
+void rescoreAddedNode(CDG* cdg, CDGNode* node, CDGNode* child, int wasLeaf) {
+  if ( getTrueNodeSet(child) ) updateCDGWith(getTrueNodeSet(child), &cdg->scoring);
+  if ( getFalseNodeSet(child) ) updateCDGWith(getFalseNodeSet(child), &cdg->scoring);
+  updateScoreWith(child, &cdg->scoring);
+  rescoreAncestors(cdg, node, wasLeaf);
+  startEpoch(cdg);
+  if ( getTraceRecorder() ) traceBuild(getTraceRecorder(), cdg->root);
+}
+
+void cdgAddTrueNode(CDG* cdg, CDGNode* node, CDGNode* trueNode) {
+  assert(NULL != cdg);
+  if ( NULL == trueNode ) return;
+  int wasLeaf = isLeaf(node);
+  addTrueNode(node, trueNode);
+  if ( NULL != cdg->index ) {
+    indexNode(cdg->index, trueNode, 1);
+    indexNodeList(cdg->index, getTrueNodeSet(trueNode), 1);
+    indexNodeList(cdg->index, getFalseNodeSet(trueNode), 0);
+  }
+  rescoreAddedNode(cdg, node, trueNode, wasLeaf);
+}
+
+void cdgAddFalseNode(CDG* cdg, CDGNode* node, CDGNode* falseNode) {
+  assert(NULL != cdg);
+  if ( NULL == falseNode ) return;
+  int wasLeaf = isLeaf(node);
+  addFalseNode(node, falseNode);
+  if ( NULL != cdg->index ) {
+    indexNode(cdg->index, falseNode, 0);
+    indexNodeList(cdg->index, getTrueNodeSet(falseNode), 1);
+    indexNodeList(cdg->index, getFalseNodeSet(falseNode), 0);
+  }
+  rescoreAddedNode(cdg, node, falseNode, wasLeaf);
+}
+
+/* Empties a slot of the id index, moving back the entries probed past it */
+
+void removeIndexSlot(CDGIdIndex* index, CDGIndexEntry* slot) {
+  unsigned int mask = index->slotCnt - 1;
+  unsigned int i = slot - index->slots;
+  unsigned int j = i;
+  unsigned int home;
+  while ( 1 ) {
+    j = (j + 1) & mask;
+    if ( NULL == index->slots[j].node ) break;
+    home = hashId(getID(index->slots[j].node)) & mask;
+    if ( ((i - home) & mask) < ((j - home) & mask) ) {
+      index->slots[i] = index->slots[j];
+      i = j;
+    }
+  }
+  index->slots[i].node = NULL;
+  index->size--;
+}
+
+/* Counts the nodes of a subtree the index does not hold */
+
+int countShadowed(CDGIdIndex* index, CDGNode* node, int subtree) {
+  int count = 0;
+  while ( node ) {
+    if ( node != findIndexSlot(index, getID(node))->node ) count++;
+    count += countShadowed(index, getTrueNodeSet(node), 0);
+    count += countShadowed(index, getFalseNodeSet(node), 0);
+    node = subtree ? NULL : getNextNode(node);
+  }
+  return count;
+}
+
+void unindexSubtree(CDGIdIndex* index, CDGNode* node, int subtree) {
+  CDGIndexEntry* slot;
+  while ( node ) {
+    slot = findIndexSlot(index, getID(node));
+    if ( node == slot->node ) {
+      removeIndexSlot(index, slot);
+    } else {
+      index->shadowed--;
+    }
+    unindexSubtree(index, getTrueNodeSet(node), 0);
+    unindexSubtree(index, getFalseNodeSet(node), 0);
+    node = subtree ? NULL : getNextNode(node);
+  }
+}
+
+/* Unlinks a node from a node set. Returns 0 if the set does not hold it */
+
+int unlinkNode(CDGNode** set, CDGNode* node) {
+  CDGNode* prev;
+  if ( node == *set ) {
+    *set = getNextNode(node);
+    return 1;
+  }
+  for ( prev = *set; prev && node != getNextNode(prev); prev = getNextNode(prev) );
+  if ( NULL == prev ) return 0;
+  setNextNode(prev, getNextNode(node));
+  return 1;
+}
+
+void cdgRemoveNode(CDG* cdg, CDGNode* node) {
+  assert(NULL != cdg);
+  assert(NULL != node);
+  CDGNode* parent = getParent(node);
+  CDGNode* set;
+  int unlinked, outcome = 1;
+  if ( NULL != cdg->index ) {
+    if ( cdg->index->shadowed == countShadowed(cdg->index, node, 1) ) {
+      unindexSubtree(cdg->index, node, 1);
+    } else {
+      /* A node left in the CDG may take over an id of the subtree, rebuild on next use */
+      deleteIdIndex(cdg->index);
+      cdg->index = NULL;
+    }
+  }
+  if ( NULL == parent ) {
+    assert(node != cdg->root || NULL != getNextNode(node));
+    unlinked = unlinkNode(&cdg->root, node);
+    assert(unlinked);
+  } else {
+    set = getTrueNodeSet(parent);
+    if ( unlinkNode(&set, node) ) {
+      setTrueNodeSet(parent, set);
+    } else {
+      set = getFalseNodeSet(parent);
+      unlinked = unlinkNode(&set, node);
+      assert(unlinked);
+      setFalseNodeSet(parent, set);
+      outcome = 0;
+    }
+    if ( isLeaf(parent) ) {
+      /* A new leaf is uncovered, like the leaves of a new CDG */
+      setFlags(parent, 0);
+      setScore(parent, 1);
+    } else if ( NULL == (outcome ? getTrueNodeSet(parent) : getFalseNodeSet(parent)) ) {
+      /* The emptied side becomes an implicit empty block, as in addDummyNodes */
+      setFlags(parent, getFlags(parent) | CDG_IMPLICIT(outcome));
+    }
+  }
+  setNextNode(node, NULL);
+  deleteCDG(node);
+  rescoreAncestors(cdg, parent, 0);
+  startEpoch(cdg);
+  if ( getTraceRecorder() ) traceBuild(getTraceRecorder(), cdg->root);
+}
+
+CDGPathSet* cdgGetTopPaths(CDG* cdg, int numberOfPaths) {
+  assert(NULL != cdg);
+  if ( NULL != cdg->topPaths && numberOfPaths == cdg->topPaths->numberOfPaths ) {
+    return retainPathSet(cdg->topPaths);
+  }
+  if ( NULL != cdg->topPaths ) releasePathSet(cdg->topPaths);
+  cdg->topPaths = newPathSet(getTopPathsWith(cdg->root, numberOfPaths, &cdg->scoring), numberOfPaths, cdg->epoch);
+  return retainPathSet(cdg->topPaths);
+}
+
+/* Content of a path and the nodes after it, as cached: 1, the id and the outcome of each node,
+   then its trueNodeSet and its falseNodeSet, each closed by a 0. Unlike getPathFingerprint it
+   tells apart paths whose nodes have both sets, like caller built ones */
+
+int countFeasibleKey(CDGNode* path) {
+  int size = 0;
+  for ( ; path; path = getNextNode(path) ) {
+    size += 5 + countFeasibleKey(getTrueNodeSet(path)) + countFeasibleKey(getFalseNodeSet(path));
+  }
+  return size;
+}
+
+int* writeFeasibleKey(int* key, CDGNode* path) {
+  for ( ; path; path = getNextNode(path) ) {
+    *key++ = 1;
+    *key++ = getID(path);
+    *key++ = getOutcome(path);
+    key = writeFeasibleKey(key, getTrueNodeSet(path));
+    *key++ = 0;
+    key = writeFeasibleKey(key, getFalseNodeSet(path));
+    *key++ = 0;
+  }
+  return key;
+}
+
+int compareSatisfiedIds(const void* a, const void* b) {
+  int x = *(const int*)a;
+  int y = *(const int*)b;
+  return (x > y) - (x < y);
+}
+
+CDGPathSet* cdgGetFeasiblePath(CDG* cdg, CDGNode* path, CDGNode* nodeList) {
+  assert(NULL != cdg);
+  int size = 0, i;
+  CDGNode* node;
+  for ( node = nodeList; node; node = getNextNode(node) ) size++;
+  int* ids = (int*)malloc(sizeof(int) * (size + 1));
+  assert(NULL != ids);
+  for ( node = nodeList, i = 0; node; node = getNextNode(node) ) ids[i++] = getID(node);
+  qsort(ids, size, sizeof(int), compareSatisfiedIds);
+  int pathSize = countFeasibleKey(path);
+  int* key = (int*)malloc(sizeof(int) * (pathSize + 1));
+  assert(NULL != key);
+  writeFeasibleKey(key, path);
+  unsigned long long fingerprint = CDG_FINGERPRINT_BASIS;
+  for ( i = 0; i < pathSize; i++ ) fingerprint = (fingerprint ^ (unsigned int)key[i]) * 0x100000001b3ULL;
+
+  CDGFeasibleEntry* entry;
+  for ( i = 0; i < CDG_FEASIBLE_CACHE_SIZE; i++ ) {
+    entry = &cdg->feasible[i];
+    if ( NULL != entry->result && fingerprint == entry->fingerprint && pathSize == entry->pathSize
+         && size == entry->size && 0 == memcmp(key, entry->path, sizeof(int) * pathSize)
+         && 0 == memcmp(ids, entry->ids, sizeof(int) * size) ) {
+      free(key);
+      free(ids);
+      return retainPathSet(entry->result);
+    }
+  }
+
+  CDGPath* result = NULL;
+  CDGNode* feasiblePath = getFeasiblePath(path, nodeList);
+  if ( NULL != feasiblePath ) {
+    result = (CDGPath*)malloc(sizeof(CDGPath));
+    assert(NULL != result);
+    result->node = feasiblePath;
+    result->next = NULL;
+  }
+  entry = &cdg->feasible[cdg->nextFeasible];
+  cdg->nextFeasible = (cdg->nextFeasible + 1) % CDG_FEASIBLE_CACHE_SIZE;
+  clearFeasibleEntry(entry);
+  entry->fingerprint = fingerprint;
+  entry->path = key;
+  entry->pathSize = pathSize;
+  entry->ids = ids;
+  entry->size = size;
+  entry->result = newPathSet(result, 1, cdg->epoch);
+  return retainPathSet(entry->result);
+}
+
+CDGNode* cdgFindNode(CDG* cdg, int id) {
+  assert(NULL != cdg);
+  return findIndexSlot(getIdIndex(cdg), id)->node;
+}
+
+/* Side of a node within its parent, from the index unless another node holds its id */
+
+int getNodeSide(CDG* cdg, CDGNode* node) {
+  CDGIndexEntry* slot = findIndexSlot(getIdIndex(cdg), getID(node));
+  if ( node == slot->node ) return slot->side;
+  CDGNode* sibling;
+  for ( sibling = getTrueNodeSet(getParent(node)); sibling; sibling = getNextNode(sibling) ) {
+    if ( node == sibling ) return 1;
+  }
+  return 0;
+}
+
+CDGNode* cdgGetDirectedPath(CDG* cdg, int target, int extend) {
+  assert(NULL != cdg);
+  CDGIndexEntry* slot = findIndexSlot(getIdIndex(cdg), target);
+  CDGNode* node = slot->node;
+  if ( NULL == node ) return NULL;
+  CDGNode* path = NULL;
+  CDGNode* step;
+  CDGNode* parent;
+  CDGTransaction* txn;
+  int side = slot->side;
+  if ( extend && !isLeaf(node) ) {
+    path = copyToPathNode(newBlankNode(), node);
+    txn = beginTransactionWith(&cdg->scoring);
+    if ( getOutcome(node) ) {
+      setTrueNodeSet(path, getTopPath(getTrueNodeSet(node), txn));
+    } else {
+      setFalseNodeSet(path, getTopPath(getFalseNodeSet(node), txn));
+    }
+    rollbackTransaction(txn);
+  }
+  for ( parent = getParent(node); parent; node = parent, parent = getParent(node) ) {
+    step = copyToPathNode(newBlankNode(), parent);
+    setOutcome(step, side);
+    if ( side ) {
+      setTrueNodeSet(step, path);
+    } else {
+      setFalseNodeSet(step, path);
+    }
+    path = step;
+    if ( getParent(parent) ) side = getNodeSide(cdg, parent);
+  }
+  return path;
+}
+
+CDGPathSet* cdgGetDistinctTopPaths(CDG* cdg, int numberOfPaths) {
+  assert(NULL != cdg);
+  if ( NULL == cdg->seen ) cdg->seen = newSeenSet();
+  return newPathSet(getDistinctTopPathsWith(cdg->root, numberOfPaths, cdg->seen, &cdg->scoring), numberOfPaths, cdg->epoch);
+}
+
+void cdgClearSeenPaths(CDG* cdg) {
+  assert(NULL != cdg);
+  if ( NULL != cdg->seen ) clearSeenSet(cdg->seen);
+}
+
+int cdgAddInfeasibleCore(CDG* cdg, CDGNode* nodes[], int size) {
+  assert(NULL != cdg);
+  if ( NULL == cdg->scoring.cores ) cdg->scoring.cores = newInfeasibleCores();
+  if ( !addInfeasibleCore(cdg->scoring.cores, nodes, size) ) return 0;
+  updateCDGWith(cdg->root, &cdg->scoring);
+  startEpoch(cdg);
+  return 1;
+}
+
+void cdgSetHitCounts(CDG* cdg, CDGHitCounts* hits) {
+  assert(NULL != cdg);
+  if ( hits == cdg->scoring.hits ) return;
+  if ( NULL != cdg->scoring.hits ) deleteHitCounts(cdg->scoring.hits);
+  cdg->scoring.hits = hits;
+  updateCDGWith(cdg->root, &cdg->scoring);
+  startEpoch(cdg);
+}
+
+CDGHitCounts* cdgGetHitCounts(CDG* cdg) {
+  assert(NULL != cdg);
+  return cdg->scoring.hits;
+}
+
+void cdgDelete(CDG* cdg) {
+  assert(NULL != cdg);
+  cdgTouch(cdg);
+  clearFeasibleCache(cdg);
+  if ( NULL != cdg->scoring.hits ) deleteHitCounts(cdg->scoring.hits);
+  if ( NULL != cdg->scoring.cores ) deleteInfeasibleCores(cdg->scoring.cores);
+  if ( NULL != cdg->seen ) deleteSeenSet(cdg->seen);
+  deleteCDG(cdg->root);
+  free(cdg);
+}
+
+CDGPathSet* newPathSet(CDGPath* paths, int numberOfPaths, unsigned long epoch) {
+  CDGPathSet* set;
+  set = (CDGPathSet*)malloc(sizeof(CDGPathSet));
+  assert(NULL != set);
+  set->refs = 1;
+  set->paths = paths;
+  set->numberOfPaths = numberOfPaths;
+  set->epoch = epoch;
+  return set;
+}
+
+CDGPathSet* retainPathSet(CDGPathSet* set) {
+  assert(NULL != set);
+  __sync_fetch_and_add(&set->refs, 1);
+  return set;
+}
+
+void releasePathSet(CDGPathSet* set) {
+  assert(NULL != set);
+  if ( 0 != __sync_sub_and_fetch(&set->refs, 1) ) return;
+  if ( NULL != set->paths ) deletePaths(set->paths);
+  free(set);
+}
+
+CDGPath* getPathSetPaths(CDGPathSet* set) {
+  assert(NULL != set);
+  return set->paths;
+}
@@ -0,0 +1,261 @@
+#ifndef CDG_GRAPH_H
+#define CDG_GRAPH_H
+
+#include "cdg.h"
+#include "cdgHits.h"
+#include "cdgCores.h"
+#include "cdgSeen.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define CDG_FEASIBLE_CACHE_SIZE 16
+
+/* CDGPathSet - Reference counted, immutable query result shared between callers
+ * @refs - Number of references held
+ * @paths - The paths. Must not be modified or deleted
+ * @numberOfPaths - Number of paths requested
+ * @epoch - Coverage epoch of the CDG the paths were computed in */
+
+typedef struct CDGPathSet {
+  int refs;
+  CDGPath* paths;
+  int numberOfPaths;
+  unsigned long epoch;
+} CDGPathSet;
+
+/* CDGFeasibleEntry - Cached getFeasiblePath result, found by the content of the path rather than
+ *                    its address, so that a path freed and another one allocated at its
+ *                    address do not share the entry
+ * @fingerprint - Hash of path, to skip most entries without comparing them
+ * @path - Content of the path the conditions were extracted from: the id and outcome of every
+ *         node, both sets included
+ * @pathSize - Number of ints of path
+ * @ids - Sorted ids of the satisfied nodes
+ * @size - Number of satisfied ids
+ * @result - Path set holding the feasible path, NULL for an unused entry */
+
+typedef struct CDGFeasibleEntry {
+  unsigned long long fingerprint;
+  int* path;
+  int pathSize;
+  int* ids;
+  int size;
+  CDGPathSet* result;
+} CDGFeasibleEntry;
+
+/* CDGIndexEntry - Slot of the id index
+ * @node - Node with the id, NULL for an empty slot
+ * @side - 1 if the node is in the trueNodeSet of its parent, 0 otherwise */
+
+typedef struct CDGIndexEntry {
+  CDGNode* node;
+  int side;
+} CDGIndexEntry;
+
+/* CDGIdIndex - Open addressing hash table from id to node. When built it holds the first node
+ *              with a given id in the order of findNode, nodes added later are only indexed
+ *              if their id is new
+ * @slots - Slots, a power of two of them
+ * @slotCnt - Number of slots
+ * @size - Number of ids held
+ * @shadowed - Number of nodes not held because another node holds their id */
+
+typedef struct CDGIdIndex {
+  CDGIndexEntry* slots;
+  int slotCnt;
+  int size;
+  int shadowed;
+} CDGIdIndex;
+
+/* CDG - Handle owning a CDG along with the state derived from it
+ * @root - Root of the CDG
+ * @epoch - Coverage epoch, bumped by every coverage or structure change
+ * @topPaths - Most recent getTopPaths result, NULL if none
+ * @feasible - Most recent getFeasiblePath results, replaced round robin
+ * @nextFeasible - Entry of feasible to be replaced next
+ * @index - Id index, built on first use. NULL if not built
+ * @scoring - Scoring of the CDG. Its hit counters and infeasible cores, NULL if none, belong to
+ *            the handle
+ * @seen - Fingerprints of the paths handed out by cdgGetDistinctTopPaths, NULL if none */
+
+typedef struct CDG {
+  CDGNode* root;
+  unsigned long epoch;
+  CDGPathSet* topPaths;
+  CDGFeasibleEntry feasible[CDG_FEASIBLE_CACHE_SIZE];
+  int nextFeasible;
+  CDGIdIndex* index;
+  CDGScoring scoring;
+  CDGSeenSet* seen;
+} CDG;
+
+/* cdgNew - Creates a handle taking ownership of a CDG, updates its scores and returns it
+ * @root - Root of CDG */
+
+CDG* cdgNew(CDGNode* root);
+
+/* cdgRoot - Returns the root of the CDG of a handle
+ * @cdg - a CDG handle */
+
+CDGNode* cdgRoot(CDG* cdg);
+
+/* cdgEpoch - Returns the current coverage epoch of a CDG
+ * @cdg - a CDG handle */
+
+unsigned long cdgEpoch(CDG* cdg);
+
+/* cdgTouch - Starts a new epoch and drops the id index. To be called after changing scores
+ *            or structure of the CDG without going through the handle
+ * @cdg - a CDG handle */
+
+void cdgTouch(CDG* cdg);
+
+/* cdgCoverNodes - Covers nodes (see coverNodesWithChanges) and starts a new epoch if anything
+ *                 changed. Returns the number of changed nodes. Records a hit for each node
+ *                 if the handle has hit counters
+ * @cdg - a CDG handle
+ * @nodes - Array of CDGNodes. Will have id and outcome set
+ * @size - Size of array */
+
+int cdgCoverNodes(CDG* cdg, CDGNode* nodes[], int size);
+
+/* cdgAddTrueNode - Adds a node (and the CDG below it) to the trueNodeSet of a node of the CDG,
+ *                  rescores the new nodes and the ancestors and starts a new epoch
+ *                - Only the ancestors whose score or leaf state changes are rescored, and the
+ *                  new nodes are added to the id index if it is built, so the cost is that of
+ *                  the added CDG plus the changed part of the ancestor chain
+ * @cdg - a CDG handle
+ * @node - CDG Node to whose trueNodeSet the node is to be added
+ * @trueNode - The CDG node to be added */
+
+void cdgAddTrueNode(CDG* cdg, CDGNode* node, CDGNode* trueNode);
+
+/* cdgAddFalseNode - Same as cdgAddTrueNode for the falseNodeSet
+ * @cdg - a CDG handle
+ * @node - CDG Node to whose falseNodeSet the node is to be added
+ * @falseNode - The CDG node to be added */
+
+void cdgAddFalseNode(CDG* cdg, CDGNode* node, CDGNode* falseNode);
+
+/* cdgRemoveNode - Unlinks a node of the CDG from its node set and deletes it along with the CDG
+ *                 below it, rescores the changed part of the ancestor chain (see
+ *                 cdgAddTrueNode) and starts a new epoch. A parent left without children
+ *                 becomes an uncovered leaf, dropping its implicit branches. A parent left
+ *                 with one empty side gets an implicit empty block there (see addDummyNodes)
+ *               - The nodes are dropped from the id index. If a node left in the CDG shares an
+ *                 id with them, the index is rebuilt on next use instead
+ * @cdg - a CDG handle
+ * @node - Node to remove. Must not be the only node of the root set */
+
+void cdgRemoveNode(CDG* cdg, CDGNode* node);
+
+/* cdgGetTopPaths - Returns the score-wise top paths of the CDG (see getTopPaths). Repeated
+ *                  queries for the same number of paths within an epoch return the same set
+ *                  in O(1). The caller owns one reference to the set. Querying another number
+ *                  of paths replaces the set
+ * @cdg - a CDG handle
+ * @numberOfPaths - Maximum number of paths to be returned */
+
+CDGPathSet* cdgGetTopPaths(CDG* cdg, int numberOfPaths);
+
+/* cdgGetFeasiblePath - Returns a set holding the single path getFeasiblePath returns, NULL
+ *                      paths if nothing is satisfied. Repeated queries for a path with the
+ *                      same content and the same satisfied ids return the same set, across
+ *                      epochs too since feasible paths do not depend on coverage. The caller
+ *                      owns one reference to the set
+ * @cdg - a CDG handle
+ * @path - Path from which the conditions were extracted
+ * @nodeList - List of nodes which were satfisfied (Necessary Params : id, next ) */
+
+CDGPathSet* cdgGetFeasiblePath(CDG* cdg, CDGNode* path, CDGNode* nodeList);
+
+/* cdgFindNode - Returns the node with an id, the same node findNode returns, in O(1) through
+ *               the id index. NULL if there is none
+ * @cdg - a CDG handle
+ * @id - Id to look up */
+
+CDGNode* cdgFindNode(CDG* cdg, int id);
+
+/* cdgGetDirectedPath - Returns the path of decisions leading from the root to a target node,
+ *                      each with the outcome on the side of the target. NULL if the target
+ *                      is not in the CDG, or is in the root set and the path is not extended.
+ *                      Runs in O(depth) through the id index and the parent links. Delete the
+ *                      path with deleteCDG
+ *                    - With extend, a decision target is added to the path with the outcome
+ *                      of its best branch, followed by the top path below it (see getTopPath)
+ * @cdg - a CDG handle
+ * @target - Id of the target block or decision
+ * @extend - Non zero to extend the path beyond the target */
+
+CDGNode* cdgGetDirectedPath(CDG* cdg, int target, int extend);
+
+/* cdgGetDistinctTopPaths - Returns the score-wise top paths of the CDG that were not handed
+ *                          out by an earlier call (see getDistinctTopPaths), across epochs.
+ *                          The caller owns the only reference to the set
+ * @cdg - a CDG handle
+ * @numberOfPaths - Maximum number of paths to be returned */
+
+CDGPathSet* cdgGetDistinctTopPaths(CDG* cdg, int numberOfPaths);
+
+/* cdgClearSeenPaths - Forgets the paths handed out by cdgGetDistinctTopPaths
+ * @cdg - a CDG handle */
+
+void cdgClearSeenPaths(CDG* cdg);
+
+/* cdgAddInfeasibleCore - Registers an infeasible core with the scoring of the handle, rescores
+ *                        the CDG and starts a new epoch. Returns 1 if the core was new, 0 if
+ *                        already implied. The cores of a handle only block branches of its
+ *                        own CDG
+ * @cdg - a CDG handle
+ * @nodes - Array of CDGNodes. Will have id and outcome set
+ * @size - Size of array, at least 1 */
+
+int cdgAddInfeasibleCore(CDG* cdg, CDGNode* nodes[], int size);
+
+/* cdgSetHitCounts - Makes the handle weigh branches by hit counts (see cdgHits.h), taking
+ *                   ownership of the counters and deleting the ones it had, rescores the CDG
+ *                   and starts a new epoch. The counters of a handle only weigh its own CDG
+ * @cdg - a CDG handle
+ * @hits - Hit counters, or NULL to weigh every branch 1 again */
+
+void cdgSetHitCounts(CDG* cdg, CDGHitCounts* hits);
+
+/* cdgGetHitCounts - Returns the hit counters of a handle, NULL if none
+ * @cdg - a CDG handle */
+
+CDGHitCounts* cdgGetHitCounts(CDG* cdg);
+
+/* cdgDelete - Releases the cached results of a handle and deletes it along with its CDG
+ * @cdg - a CDG handle */
+
+void cdgDelete(CDG* cdg);
+
+/* newPathSet - Creates a path set with one reference, taking ownership of the paths
+ * @paths - a path head. May be NULL
+ * @numberOfPaths - Number of paths requested
+ * @epoch - Epoch the paths were computed in */
+
+CDGPathSet* newPathSet(CDGPath* paths, int numberOfPaths, unsigned long epoch);
+
+/* retainPathSet - Takes a reference to a path set and returns it. Thread safe
+ * @set - a path set */
+
+CDGPathSet* retainPathSet(CDGPathSet* set);
+
+/* releasePathSet - Drops a reference to a path set, deleting it with the last one. Thread safe
+ * @set - a path set */
+
+void releasePathSet(CDGPathSet* set);
+
+/* getPathSetPaths - Returns the paths of a path set
+ * @set - a path set */
+
+CDGPath* getPathSetPaths(CDGPathSet* set);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
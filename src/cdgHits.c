@@ -0,0 +1,71 @@
+#include <string.h>
+#include "cdgHits.h"
+
+const unsigned char hitBuckets[256] = {
+  0, 1, 2, 3, 4, 4, 4, 4, 5, 5, 5, 5, 5, 5, 5, 5,
+  6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6,
+  7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7,
+  7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7,
+  7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7,
+  7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7,
+  7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7,
+  7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7,
+  8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8,
+  8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8,
+  8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8,
+  8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8,
+  8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8,
+  8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8,
+  8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8,
+  8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8
+};
+
+CDGHitCounts* newHitCounts(int maxId) {
+  assert(0 <= maxId);
+  CDGHitCounts* hits;
+  hits = (CDGHitCounts*)malloc(sizeof(CDGHitCounts));
+  assert(NULL != hits);
+  hits->size = maxId + 1;
+  hits->counts = (unsigned char*)calloc(2 * hits->size, sizeof(unsigned char));
+  assert(NULL != hits->counts);
+  return hits;
+}
+
+void recordHits(CDGHitCounts* hits, CDGNode* nodes[], int size) {
+  assert(NULL != hits);
+  int i;
+  for ( i = 0; i < size; i++ ) {
+    assert(0 <= getID(nodes[i]) && getID(nodes[i]) < hits->size);
+    recordHit(hits, getID(nodes[i]), getOutcome(nodes[i]));
+  }
+}
+
+int getHitCount(CDGHitCounts* hits, int id, int outcome) {
+  assert(NULL != hits);
+  assert(0 <= id && id < hits->size);
+  return hits->counts[2 * id + (0 != outcome)];
+}
+
+int getHitBucket(CDGHitCounts* hits, int id, int outcome) {
+  return hitBuckets[getHitCount(hits, id, outcome)];
+}
+
+void clearHitCounts(CDGHitCounts* hits) {
+  assert(NULL != hits);
+  memset(hits->counts, 0, 2 * hits->size);
+}
+
+/* Ids outside of the counters were never recorded and weigh as never exercised */
+
+int getBranchWeight(CDGHitCounts* hits, CDGNode* node, int outcome) {
+  if ( NULL == hits ) return 1;
+  int id = getID(node);
+  if ( id < 0 || id >= hits->size ) return CDG_HIT_BUCKETS;
+  return CDG_HIT_BUCKETS - hitBuckets[hits->counts[2 * id + (0 != outcome)]];
+}
+
+void deleteHitCounts(CDGHitCounts* hits) {
+  assert(NULL != hits);
+  free(hits->counts);
+  free(hits);
+}
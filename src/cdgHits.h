@@ -0,0 +1,94 @@
+#ifndef CDG_HITS_H
+#define CDG_HITS_H
+
+#include "cdg.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Hit counts
+ *
+ * Every branch (id, outcome) of a CDG has a saturating 8 bit counter of the number of times
+ * it was exercised. Counts are grouped into logarithmic buckets (0, 1, 2, 3, 4-7, 8-15,
+ * 16-31, 32-127, 128+) so that only a change of the order of magnitude of the count matters.
+ *
+ * Counters belong to the scoring of a CDG (see CDGScoring), usually that of its handle (see
+ * cdgSetHitCounts). Scored with them, updateScoreWith weights each branch by
+ * CDG_HIT_BUCKETS - bucket instead of 1, so the top paths prefer rarely exercised branches
+ * over often exercised ones, and not only over never exercised ones. coverNodesWith and
+ * coverNodesWithChanges record a hit for each node they are given */
+
+#define CDG_HIT_BUCKETS 9
+
+/* CDGHitCounts - Hit counters of the branches of a CDG
+ * @counts - Counter of branch (id, outcome) at 2 * id + outcome
+ * @size - Number of ids, valid ids are 0 to size - 1 */
+
+typedef struct CDGHitCounts {
+  unsigned char* counts;
+  int size;
+} CDGHitCounts;
+
+/* hitBuckets - Bucket of every counter value */
+
+extern const unsigned char hitBuckets[256];
+
+/* newHitCounts - Creates counters, all 0, for ids 0 to maxId
+ * @maxId - Largest id of the CDG */
+
+CDGHitCounts* newHitCounts(int maxId);
+
+/* recordHit - Counts one execution of a branch. Saturates at 255 without branching
+ * @hits - Hit counters
+ * @id - Id of the decision node
+ * @outcome - Outcome taken */
+
+static inline void recordHit(CDGHitCounts* hits, int id, int outcome) {
+  unsigned char* count = &hits->counts[2 * id + (0 != outcome)];
+  *count += (*count != 255);
+}
+
+/* recordHits - Counts one execution of every branch of an array of nodes
+ * @hits - Hit counters
+ * @nodes - Array of CDGNodes. Will have id and outcome set
+ * @size - Size of array */
+
+void recordHits(CDGHitCounts* hits, CDGNode* nodes[], int size);
+
+/* getHitCount - Returns the counter of a branch
+ * @hits - Hit counters
+ * @id - Id of the decision node
+ * @outcome - Outcome */
+
+int getHitCount(CDGHitCounts* hits, int id, int outcome);
+
+/* getHitBucket - Returns the bucket, 0 to CDG_HIT_BUCKETS - 1, of the counter of a branch
+ * @hits - Hit counters
+ * @id - Id of the decision node
+ * @outcome - Outcome */
+
+int getHitBucket(CDGHitCounts* hits, int id, int outcome);
+
+/* clearHitCounts - Resets all the counters to 0
+ * @hits - Hit counters */
+
+void clearHitCounts(CDGHitCounts* hits);
+
+/* getBranchWeight - Returns the weight of a branch scored with hit counters
+ * @hits - Hit counters, or NULL for coverage scoring where every branch weighs 1
+ * @node - a decision node
+ * @outcome - Outcome of the branch */
+
+int getBranchWeight(CDGHitCounts* hits, CDGNode* node, int outcome);
+
+/* deleteHitCounts - Deallocates hit counters. They must not be scored with anymore
+ * @hits - Hit counters */
+
+void deleteHitCounts(CDGHitCounts* hits);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,362 @@
+#include "cdgLevels.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#define CDG_X86_KERNELS
+#include <immintrin.h>
+#endif
+
+int levelKernel = CDG_KERNEL_AUTO;
+
+/* Scalar kernels. Every kernel works on the ranges of one level:
+ * scan - condSum/uncovSum[j + 1] - [a] are the number of scores of decision nodes and of
+ *        uncovered leaves in [a, j]
+ * combine - updateScore of the nodes in [c, d) from the prefix sums of their children */
+
+void scanLevelScalar(CDGLevelGraph* g, int a, int b) {
+  int j, cond = 0, uncov = 0;
+  g->condSum[a] = 0;
+  g->uncovSum[a] = 0;
+  for ( j = a; j < b; j++ ) {
+    cond += g->score[j] & ~g->leaf[j];
+    uncov += g->leaf[j] & (0 < g->score[j]);
+    g->condSum[j + 1] = cond;
+    g->uncovSum[j + 1] = uncov;
+  }
+}
+
+void combineLevelScalar(CDGLevelGraph* g, int c, int d) {
+  int i, trueScore, falseScore, trueUncov, falseUncov;
+  for ( i = c; i < d; i++ ) {
+    if ( g->leaf[i] ) continue;
+    trueScore = g->condSum[g->childMid[i]] - g->condSum[g->childStart[i]];
+    falseScore = g->condSum[g->childEnd[i]] - g->condSum[g->childMid[i]];
+    if ( 0 == trueScore && 0 == falseScore ) {
+      trueUncov = g->uncovSum[g->childMid[i]] - g->uncovSum[g->childStart[i]] + (g->implicit[i] & CDG_IMPLICIT_TRUE);
+      falseUncov = g->uncovSum[g->childEnd[i]] - g->uncovSum[g->childMid[i]] + (g->implicit[i] >> 1);
+      g->score[i] = 0 < trueUncov || 0 < falseUncov;
+      g->outcome[i] = 0 < trueUncov || 0 == falseUncov;
+    } else if ( trueScore >= falseScore ) {
+      g->score[i] = trueScore + 1;
+      g->outcome[i] = 1;
+    } else {
+      g->score[i] = falseScore + 1;
+      g->outcome[i] = 0;
+    }
+  }
+}
+
+#ifdef CDG_X86_KERNELS
+
+void scanLevelSSE2(CDGLevelGraph* g, int a, int b) {
+  __m128i condCarry = _mm_setzero_si128();
+  __m128i uncovCarry = _mm_setzero_si128();
+  __m128i zero = _mm_setzero_si128();
+  __m128i one = _mm_set1_epi32(1);
+  __m128i score, leaf, cond, uncov;
+  int j = a;
+  g->condSum[a] = 0;
+  g->uncovSum[a] = 0;
+  for ( ; j + 4 <= b; j += 4 ) {
+    score = _mm_loadu_si128((__m128i*)(g->score + j));
+    leaf = _mm_loadu_si128((__m128i*)(g->leaf + j));
+    cond = _mm_andnot_si128(leaf, score);
+    uncov = _mm_and_si128(_mm_and_si128(leaf, _mm_cmpgt_epi32(score, zero)), one);
+    cond = _mm_add_epi32(cond, _mm_slli_si128(cond, 4));
+    cond = _mm_add_epi32(cond, _mm_slli_si128(cond, 8));
+    cond = _mm_add_epi32(cond, condCarry);
+    uncov = _mm_add_epi32(uncov, _mm_slli_si128(uncov, 4));
+    uncov = _mm_add_epi32(uncov, _mm_slli_si128(uncov, 8));
+    uncov = _mm_add_epi32(uncov, uncovCarry);
+    _mm_storeu_si128((__m128i*)(g->condSum + j + 1), cond);
+    _mm_storeu_si128((__m128i*)(g->uncovSum + j + 1), uncov);
+    condCarry = _mm_shuffle_epi32(cond, 0xff);
+    uncovCarry = _mm_shuffle_epi32(uncov, 0xff);
+  }
+  for ( ; j < b; j++ ) {
+    g->condSum[j + 1] = g->condSum[j] + (g->score[j] & ~g->leaf[j]);
+    g->uncovSum[j + 1] = g->uncovSum[j] + (g->leaf[j] & (0 < g->score[j]));
+  }
+}
+
+/* Segment sums of 4 nodes of a level and the resulting scores and outcomes, all lanes are
+ * computed as decision nodes and leaves are blended back afterwards */
+
+void combineLanesSSE2(CDGLevelGraph* g, int i, __m128i trueScore, __m128i falseScore,
+                      __m128i trueUncov, __m128i falseUncov) {
+  __m128i zero = _mm_setzero_si128();
+  __m128i one = _mm_set1_epi32(1);
+  __m128i leaf = _mm_loadu_si128((__m128i*)(g->leaf + i));
+  __m128i implicit = _mm_loadu_si128((__m128i*)(g->implicit + i));
+  trueUncov = _mm_add_epi32(trueUncov, _mm_and_si128(implicit, one));
+  falseUncov = _mm_add_epi32(falseUncov, _mm_srli_epi32(implicit, 1));
+  __m128i noCond = _mm_and_si128(_mm_cmpeq_epi32(trueScore, zero), _mm_cmpeq_epi32(falseScore, zero));
+  __m128i hasTrueUncov = _mm_cmpgt_epi32(trueUncov, zero);
+  __m128i hasFalseUncov = _mm_cmpgt_epi32(falseUncov, zero);
+  __m128i condScore = _mm_and_si128(_mm_or_si128(hasTrueUncov, hasFalseUncov), one);
+  __m128i condOutcome = _mm_and_si128(_mm_or_si128(hasTrueUncov, _mm_cmpeq_epi32(hasFalseUncov, zero)), one);
+  __m128i falseWins = _mm_cmpgt_epi32(falseScore, trueScore);
+  __m128i best = _mm_or_si128(_mm_and_si128(falseWins, falseScore), _mm_andnot_si128(falseWins, trueScore));
+  __m128i sumScore = _mm_add_epi32(best, one);
+  __m128i sumOutcome = _mm_andnot_si128(falseWins, one);
+  __m128i score = _mm_or_si128(_mm_and_si128(noCond, condScore), _mm_andnot_si128(noCond, sumScore));
+  __m128i outcome = _mm_or_si128(_mm_and_si128(noCond, condOutcome), _mm_andnot_si128(noCond, sumOutcome));
+  __m128i oldScore = _mm_loadu_si128((__m128i*)(g->score + i));
+  __m128i oldOutcome = _mm_loadu_si128((__m128i*)(g->outcome + i));
+  score = _mm_or_si128(_mm_and_si128(leaf, oldScore), _mm_andnot_si128(leaf, score));
+  outcome = _mm_or_si128(_mm_and_si128(leaf, oldOutcome), _mm_andnot_si128(leaf, outcome));
+  _mm_storeu_si128((__m128i*)(g->score + i), score);
+  _mm_storeu_si128((__m128i*)(g->outcome + i), outcome);
+}
+
+#define GATHER4(sum, index, i) _mm_setr_epi32(sum[index[i]], sum[index[i + 1]], sum[index[i + 2]], sum[index[i + 3]])
+
+void combineLevelSSE2(CDGLevelGraph* g, int c, int d) {
+  int i = c;
+  __m128i condStart, condMid, condEnd, uncovStart, uncovMid, uncovEnd;
+  for ( ; i + 4 <= d; i += 4 ) {
+    condStart = GATHER4(g->condSum, g->childStart, i);
+    condMid = GATHER4(g->condSum, g->childMid, i);
+    condEnd = GATHER4(g->condSum, g->childEnd, i);
+    uncovStart = GATHER4(g->uncovSum, g->childStart, i);
+    uncovMid = GATHER4(g->uncovSum, g->childMid, i);
+    uncovEnd = GATHER4(g->uncovSum, g->childEnd, i);
+    combineLanesSSE2(g, i, _mm_sub_epi32(condMid, condStart), _mm_sub_epi32(condEnd, condMid),
+                     _mm_sub_epi32(uncovMid, uncovStart), _mm_sub_epi32(uncovEnd, uncovMid));
+  }
+  combineLevelScalar(g, i, d);
+}
+
+__attribute__((target("avx2")))
+void scanLevelAVX2(CDGLevelGraph* g, int a, int b) {
+  __m256i condCarry = _mm256_setzero_si256();
+  __m256i uncovCarry = _mm256_setzero_si256();
+  __m256i zero = _mm256_setzero_si256();
+  __m256i one = _mm256_set1_epi32(1);
+  __m256i last = _mm256_set1_epi32(7);
+  __m256i score, leaf, cond, uncov;
+  int j = a;
+  g->condSum[a] = 0;
+  g->uncovSum[a] = 0;
+  for ( ; j + 8 <= b; j += 8 ) {
+    score = _mm256_loadu_si256((__m256i*)(g->score + j));
+    leaf = _mm256_loadu_si256((__m256i*)(g->leaf + j));
+    cond = _mm256_andnot_si256(leaf, score);
+    uncov = _mm256_and_si256(_mm256_and_si256(leaf, _mm256_cmpgt_epi32(score, zero)), one);
+    cond = _mm256_add_epi32(cond, _mm256_slli_si256(cond, 4));
+    cond = _mm256_add_epi32(cond, _mm256_slli_si256(cond, 8));
+    cond = _mm256_add_epi32(cond, _mm256_permute2x128_si256(_mm256_shuffle_epi32(cond, 0xff), cond, 0x08));
+    cond = _mm256_add_epi32(cond, condCarry);
+    uncov = _mm256_add_epi32(uncov, _mm256_slli_si256(uncov, 4));
+    uncov = _mm256_add_epi32(uncov, _mm256_slli_si256(uncov, 8));
+    uncov = _mm256_add_epi32(uncov, _mm256_permute2x128_si256(_mm256_shuffle_epi32(uncov, 0xff), uncov, 0x08));
+    uncov = _mm256_add_epi32(uncov, uncovCarry);
+    _mm256_storeu_si256((__m256i*)(g->condSum + j + 1), cond);
+    _mm256_storeu_si256((__m256i*)(g->uncovSum + j + 1), uncov);
+    condCarry = _mm256_permutevar8x32_epi32(cond, last);
+    uncovCarry = _mm256_permutevar8x32_epi32(uncov, last);
+  }
+  for ( ; j < b; j++ ) {
+    g->condSum[j + 1] = g->condSum[j] + (g->score[j] & ~g->leaf[j]);
+    g->uncovSum[j + 1] = g->uncovSum[j] + (g->leaf[j] & (0 < g->score[j]));
+  }
+}
+
+__attribute__((target("avx2")))
+void combineLevelAVX2(CDGLevelGraph* g, int c, int d) {
+  __m256i zero = _mm256_setzero_si256();
+  __m256i one = _mm256_set1_epi32(1);
+  __m256i start, mid, end, leaf, implicit, trueScore, falseScore, trueUncov, falseUncov;
+  __m256i noCond, hasTrueUncov, hasFalseUncov, condScore, condOutcome, falseWins, sumScore, sumOutcome;
+  __m256i score, outcome;
+  int i = c;
+  for ( ; i + 8 <= d; i += 8 ) {
+    start = _mm256_loadu_si256((__m256i*)(g->childStart + i));
+    mid = _mm256_loadu_si256((__m256i*)(g->childMid + i));
+    end = _mm256_loadu_si256((__m256i*)(g->childEnd + i));
+    leaf = _mm256_loadu_si256((__m256i*)(g->leaf + i));
+    trueScore = _mm256_sub_epi32(_mm256_i32gather_epi32(g->condSum, mid, 4), _mm256_i32gather_epi32(g->condSum, start, 4));
+    falseScore = _mm256_sub_epi32(_mm256_i32gather_epi32(g->condSum, end, 4), _mm256_i32gather_epi32(g->condSum, mid, 4));
+    trueUncov = _mm256_sub_epi32(_mm256_i32gather_epi32(g->uncovSum, mid, 4), _mm256_i32gather_epi32(g->uncovSum, start, 4));
+    falseUncov = _mm256_sub_epi32(_mm256_i32gather_epi32(g->uncovSum, end, 4), _mm256_i32gather_epi32(g->uncovSum, mid, 4));
+    implicit = _mm256_loadu_si256((__m256i*)(g->implicit + i));
+    trueUncov = _mm256_add_epi32(trueUncov, _mm256_and_si256(implicit, one));
+    falseUncov = _mm256_add_epi32(falseUncov, _mm256_srli_epi32(implicit, 1));
+    noCond = _mm256_and_si256(_mm256_cmpeq_epi32(trueScore, zero), _mm256_cmpeq_epi32(falseScore, zero));
+    hasTrueUncov = _mm256_cmpgt_epi32(trueUncov, zero);
+    hasFalseUncov = _mm256_cmpgt_epi32(falseUncov, zero);
+    condScore = _mm256_and_si256(_mm256_or_si256(hasTrueUncov, hasFalseUncov), one);
+    condOutcome = _mm256_and_si256(_mm256_or_si256(hasTrueUncov, _mm256_cmpeq_epi32(hasFalseUncov, zero)), one);
+    falseWins = _mm256_cmpgt_epi32(falseScore, trueScore);
+    sumScore = _mm256_add_epi32(_mm256_max_epi32(trueScore, falseScore), one);
+    sumOutcome = _mm256_andnot_si256(falseWins, one);
+    score = _mm256_blendv_epi8(sumScore, condScore, noCond);
+    outcome = _mm256_blendv_epi8(sumOutcome, condOutcome, noCond);
+    score = _mm256_blendv_epi8(score, _mm256_loadu_si256((__m256i*)(g->score + i)), leaf);
+    outcome = _mm256_blendv_epi8(outcome, _mm256_loadu_si256((__m256i*)(g->outcome + i)), leaf);
+    _mm256_storeu_si256((__m256i*)(g->score + i), score);
+    _mm256_storeu_si256((__m256i*)(g->outcome + i), outcome);
+  }
+  combineLevelScalar(g, i, d);
+}
+
+#endif
+
+int setLevelKernel(int kernel) {
+#ifdef CDG_X86_KERNELS
+  int hasAVX2 = __builtin_cpu_supports("avx2");
+  if ( CDG_KERNEL_AUTO == kernel ) kernel = hasAVX2 ? CDG_KERNEL_AVX2 : CDG_KERNEL_SSE2;
+  if ( CDG_KERNEL_AVX2 == kernel && !hasAVX2 ) kernel = CDG_KERNEL_SSE2;
+#else
+  kernel = CDG_KERNEL_SCALAR;
+#endif
+  levelKernel = kernel;
+  return kernel;
+}
+
+int getLevelKernel() {
+  if ( CDG_KERNEL_AUTO == levelKernel ) setLevelKernel(CDG_KERNEL_AUTO);
+  return levelKernel;
+}
+
+void scanLevel(CDGLevelGraph* g, int kernel, int a, int b) {
+#ifdef CDG_X86_KERNELS
+  if ( CDG_KERNEL_AVX2 == kernel ) {
+    scanLevelAVX2(g, a, b);
+    return;
+  }
+  if ( CDG_KERNEL_SSE2 == kernel ) {
+    scanLevelSSE2(g, a, b);
+    return;
+  }
+#endif
+  scanLevelScalar(g, a, b);
+}
+
+void combineLevel(CDGLevelGraph* g, int kernel, int c, int d) {
+#ifdef CDG_X86_KERNELS
+  if ( CDG_KERNEL_AVX2 == kernel ) {
+    combineLevelAVX2(g, c, d);
+    return;
+  }
+  if ( CDG_KERNEL_SSE2 == kernel ) {
+    combineLevelSSE2(g, c, d);
+    return;
+  }
+#endif
+  combineLevelScalar(g, c, d);
+}
+
+int* newLevelArray(int size) {
+  int* array = (int*)calloc(size, sizeof(int));
+  assert(NULL != array);
+  return array;
+}
+
+int placeLevelSet(CDGLevelGraph* g, CDGNode* node) {
+  while ( node ) {
+    g->nodes[g->size] = node;
+    g->score[g->size] = getScore(node);
+    g->outcome[g->size] = getOutcome(node);
+    g->leaf[g->size] = isLeaf(node) ? -1 : 0;
+    g->implicit[g->size] = getFlags(node);
+    g->childStart[g->size] = 0;
+    g->childMid[g->size] = 0;
+    g->childEnd[g->size] = 0;
+    g->size++;
+    node = getNextNode(node);
+  }
+  return g->size;
+}
+
+CDGLevelGraph* newLevelGraph(CDGNode* root) {
+  assert(NULL != root);
+  int size = getPathLength(root);
+  CDGLevelGraph* g = (CDGLevelGraph*)malloc(sizeof(CDGLevelGraph));
+  assert(NULL != g);
+  g->nodes = (CDGNode**)malloc(sizeof(CDGNode*) * size);
+  assert(NULL != g->nodes);
+  g->score = newLevelArray(size);
+  g->outcome = newLevelArray(size);
+  g->leaf = newLevelArray(size);
+  g->implicit = newLevelArray(size);
+  g->childStart = newLevelArray(size);
+  g->childMid = newLevelArray(size);
+  g->childEnd = newLevelArray(size);
+  g->condSum = newLevelArray(size + 1);
+  g->uncovSum = newLevelArray(size + 1);
+  g->levelStart = newLevelArray(size + 1);
+  g->size = 0;
+  g->levelCnt = 0;
+
+  int i, levelEnd;
+  g->levelStart[0] = 0;
+  levelEnd = placeLevelSet(g, root);
+  for ( i = 0; i < g->size; i++ ) {
+    if ( i == levelEnd ) {
+      g->levelStart[++g->levelCnt] = i;
+      levelEnd = g->size;
+    }
+    if ( g->leaf[i] ) continue;
+    g->childStart[i] = g->size;
+    g->childMid[i] = placeLevelSet(g, getTrueNodeSet(g->nodes[i]));
+    g->childEnd[i] = placeLevelSet(g, getFalseNodeSet(g->nodes[i]));
+  }
+  g->levelStart[++g->levelCnt] = g->size;
+  assert(size == g->size);
+  return g;
+}
+
+void loadLevelScores(CDGLevelGraph* graph) {
+  assert(NULL != graph);
+  int i;
+  for ( i = 0; i < graph->size; i++ ) {
+    if ( graph->leaf[i] ) {
+      graph->score[i] = getScore(graph->nodes[i]);
+    } else {
+      graph->implicit[i] = getFlags(graph->nodes[i]);
+    }
+  }
+}
+
+void rescoreLevelGraph(CDGLevelGraph* graph) {
+  assert(NULL != graph);
+  int kernel = getLevelKernel();
+  int level;
+  for ( level = graph->levelCnt - 2; level >= 0; level-- ) {
+    scanLevel(graph, kernel, graph->levelStart[level + 1], graph->levelStart[level + 2]);
+    combineLevel(graph, kernel, graph->levelStart[level], graph->levelStart[level + 1]);
+  }
+}
+
+void storeLevelScores(CDGLevelGraph* graph) {
+  assert(NULL != graph);
+  int i;
+  for ( i = 0; i < graph->size; i++ ) {
+    if ( graph->leaf[i] ) continue;
+    setScore(graph->nodes[i], graph->score[i]);
+    setOutcome(graph->nodes[i], graph->outcome[i]);
+  }
+}
+
+CDGNode* updateCDGLevels(CDGLevelGraph* graph) {
+  loadLevelScores(graph);
+  rescoreLevelGraph(graph);
+  storeLevelScores(graph);
+  return graph->nodes[0];
+}
+
+void deleteLevelGraph(CDGLevelGraph* graph) {
+  assert(NULL != graph);
+  free(graph->nodes);
+  free(graph->score);
+  free(graph->outcome);
+  free(graph->leaf);
+  free(graph->implicit);
+  free(graph->childStart);
+  free(graph->childMid);
+  free(graph->childEnd);
+  free(graph->condSum);
+  free(graph->uncovSum);
+  free(graph->levelStart);
+  free(graph);
+}
@@ -0,0 +1,105 @@
+#ifndef CDG_LEVELS_H
+#define CDG_LEVELS_H
+
+#include "cdg.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Level-ordered rescoring
+ *
+ * A CDGLevelGraph is a snapshot of the structure of a CDG in which the nodes are numbered
+ * level by level and the trueNodeSet of every node is immediately followed by its
+ * falseNodeSet, so that the children of a node are one contiguous range of the score
+ * arrays. updateScore then reduces to segmented sums and any-nonzero tests over the
+ * children, which rescoreLevelGraph evaluates for a whole level at a time with SIMD
+ * kernels selected at runtime */
+
+#define CDG_KERNEL_AUTO 0
+#define CDG_KERNEL_SCALAR 1
+#define CDG_KERNEL_SSE2 2
+#define CDG_KERNEL_AVX2 3
+
+/* CDGLevelGraph - Level ordered scores of a CDG
+ * @nodes - CDG node of each index
+ * @score - Score of each node
+ * @outcome - Outcome of each node
+ * @leaf - -1 for leaves, 0 for decision nodes
+ * @implicit - Implicit empty blocks of each node, see CDG_IMPLICIT
+ * @childStart - Index of the first node of the trueNodeSet
+ * @childMid - Index of the first node of the falseNodeSet (end of the trueNodeSet)
+ * @childEnd - End of the falseNodeSet
+ * @condSum - Scratch prefix sums of the scores of decision children
+ * @uncovSum - Scratch prefix sums of the uncovered leaf children
+ * @levelStart - Index of the first node of each level, levelCnt + 1 entries
+ * @levelCnt - Number of levels
+ * @size - Number of nodes */
+
+typedef struct CDGLevelGraph {
+  CDGNode** nodes;
+  int* score;
+  int* outcome;
+  int* leaf;
+  int* implicit;
+  int* childStart;
+  int* childMid;
+  int* childEnd;
+  int* condSum;
+  int* uncovSum;
+  int* levelStart;
+  int levelCnt;
+  int size;
+} CDGLevelGraph;
+
+/* newLevelGraph - Creates the level ordered snapshot of a CDG, reading its current scores
+ * @root - Root of CDG */
+
+CDGLevelGraph* newLevelGraph(CDGNode* root);
+
+/* loadLevelScores - Reads the scores of the leaves and the implicit blocks of the decision
+ *                   nodes from the CDG nodes, e.g. after coverNodes
+ * @graph - a level graph */
+
+void loadLevelScores(CDGLevelGraph* graph);
+
+/* rescoreLevelGraph - Recomputes the scores and outcomes of all the decision nodes from the
+ *                     scores of the leaves, giving the same result as updateCDG. Only
+ *                     supports plain coverage, without a scoring (see CDGScoring)
+ * @graph - a level graph */
+
+void rescoreLevelGraph(CDGLevelGraph* graph);
+
+/* storeLevelScores - Writes the scores and outcomes of the decision nodes back to the CDG nodes
+ * @graph - a level graph */
+
+void storeLevelScores(CDGLevelGraph* graph);
+
+/* updateCDGLevels - Loads the leaf scores, rescores and stores the result back. Replaces
+ *                   updateCDG for a CDG whose structure did not change since the snapshot
+ *                 - Returns the root of the CDG
+ * @graph - a level graph */
+
+CDGNode* updateCDGLevels(CDGLevelGraph* graph);
+
+/* setLevelKernel - Selects the rescoring kernel. CDG_KERNEL_AUTO (the default) picks the
+ *                  widest kernel supported by the processor. Returns the selected kernel,
+ *                  which falls back to a narrower one if the requested is not supported
+ * @kernel - One of CDG_KERNEL_* */
+
+int setLevelKernel(int kernel);
+
+/* getLevelKernel - Returns the kernel used by rescoreLevelGraph (never CDG_KERNEL_AUTO) */
+
+int getLevelKernel();
+
+/* deleteLevelGraph - Deallocates a level graph. The CDG is left untouched
+ * @graph - a level graph */
+
+void deleteLevelGraph(CDGLevelGraph* graph);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,383 @@
+#define _GNU_SOURCE
+#include <sched.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <stdio.h>
+#include <string.h>
+#include <dirent.h>
+#include "cdgNuma.h"
+
+/* Scores, outcomes and implicit blocks changed by a getReplicatedTopPaths call, an open
+   addressing hash table over node indices. Nodes not in it read the shared region */
+
+typedef struct ReplicaOverlay {
+  int* keys;
+  int* state;
+  int slotCnt;
+  int count;
+} ReplicaOverlay;
+
+/* Marks the CPUs of a cpulist such as "0-3,8-11" as belonging to a replica */
+
+void readCpuList(const char* list, int replica, int* cpuNode, int cpuCnt) {
+  int first, last, cpu, used;
+  while ( 1 == sscanf(list, "%d%n", &first, &used) ) {
+    list += used;
+    last = first;
+    if ( '-' == *list && 1 == sscanf(list + 1, "%d%n", &last, &used) ) list += 1 + used;
+    for ( cpu = first; cpu <= last && cpu < cpuCnt; cpu++ ) cpuNode[cpu] = replica;
+    if ( ',' != *list ) break;
+    list++;
+  }
+}
+
+int compareNumaNodes(const void* a, const void* b) {
+  return *(const int*)a - *(const int*)b;
+}
+
+/* Sets the replica of each CPU from the NUMA nodes of the host, numbered densely in node
+   order, and returns the number of nodes. 1 if the topology cannot be read */
+
+int readNumaTopology(int* cpuNode, int cpuCnt) {
+  DIR* dir = opendir("/sys/devices/system/node");
+  struct dirent* entry;
+  char path[64];
+  char list[4096];
+  int nodes[256];
+  int nodeCnt = 0;
+  int i, id;
+  FILE* in;
+  if ( NULL != dir ) {
+    while ( NULL != (entry = readdir(dir)) && nodeCnt < 256 ) {
+      if ( 1 == sscanf(entry->d_name, "node%d", &id) ) nodes[nodeCnt++] = id;
+    }
+    closedir(dir);
+  }
+  if ( 0 == nodeCnt ) return 1;
+  qsort(nodes, nodeCnt, sizeof(int), compareNumaNodes);
+  for ( i = 0; i < nodeCnt; i++ ) {
+    sprintf(path, "/sys/devices/system/node/node%d/cpulist", nodes[i]);
+    in = fopen(path, "r");
+    if ( NULL == in ) continue;
+    if ( NULL != fgets(list, sizeof(list), in) ) readCpuList(list, i, cpuNode, cpuCnt);
+    fclose(in);
+  }
+  return nodeCnt;
+}
+
+/* Copies the structure of the shared level graph into a replica from a thread pinned to the
+   CPUs of its NUMA node, so that the first touch allocates the pages there */
+
+typedef struct ReplicaBuild {
+  CDGReplicatedGraph* graph;
+  CDGReplica* replica;
+} ReplicaBuild;
+
+int* copyReplicaArray(int* from, int size) {
+  int* to = (int*)malloc(sizeof(int) * size);
+  assert(NULL != to);
+  memcpy(to, from, sizeof(int) * size);
+  return to;
+}
+
+/* Copies the id and the expr of every node into a replica, the exprs into one block */
+
+void copyReplicaExprs(CDGReplica* replica, CDGLevelGraph* shared) {
+  size_t total = 0, len;
+  char* data;
+  int i;
+  for ( i = 0; i < shared->size; i++ ) {
+    if ( NULL != getExpr(shared->nodes[i]) ) total += strlen(getExpr(shared->nodes[i])) + 1;
+  }
+  replica->id = (int*)malloc(sizeof(int) * shared->size);
+  replica->expr = (const char**)malloc(sizeof(const char*) * shared->size);
+  replica->exprData = (char*)malloc(total + 1);
+  assert(NULL != replica->id && NULL != replica->expr && NULL != replica->exprData);
+  data = replica->exprData;
+  for ( i = 0; i < shared->size; i++ ) {
+    replica->id[i] = getID(shared->nodes[i]);
+    replica->expr[i] = NULL;
+    if ( NULL == getExpr(shared->nodes[i]) ) continue;
+    len = strlen(getExpr(shared->nodes[i])) + 1;
+    memcpy(data, getExpr(shared->nodes[i]), len);
+    replica->expr[i] = data;
+    data += len;
+  }
+}
+
+void* buildReplica(void* arg) {
+  ReplicaBuild* build = (ReplicaBuild*)arg;
+  CDGReplicatedGraph* graph = build->graph;
+  CDGLevelGraph* shared = graph->shared;
+  CDGLevelGraph* view = &build->replica->view;
+  cpu_set_t cpus;
+  int cpu, pinned = 0, i, j;
+  CPU_ZERO(&cpus);
+  for ( cpu = 0; cpu < graph->cpuCnt && cpu < CPU_SETSIZE; cpu++ ) {
+    if ( build->replica->numaNode != graph->cpuNode[cpu] ) continue;
+    CPU_SET(cpu, &cpus);
+    pinned++;
+  }
+  if ( 0 < pinned ) pthread_setaffinity_np(pthread_self(), sizeof(cpu_set_t), &cpus);
+  *view = *shared;
+  view->nodes = (CDGNode**)malloc(sizeof(CDGNode*) * shared->size);
+  assert(NULL != view->nodes);
+  memcpy(view->nodes, shared->nodes, sizeof(CDGNode*) * shared->size);
+  view->leaf = copyReplicaArray(shared->leaf, shared->size);
+  view->childStart = copyReplicaArray(shared->childStart, shared->size);
+  view->childMid = copyReplicaArray(shared->childMid, shared->size);
+  view->childEnd = copyReplicaArray(shared->childEnd, shared->size);
+  view->levelStart = copyReplicaArray(shared->levelStart, shared->levelCnt + 1);
+  view->condSum = copyReplicaArray(shared->condSum, shared->size + 1);
+  view->uncovSum = copyReplicaArray(shared->uncovSum, shared->size + 1);
+  build->replica->parent = (int*)malloc(sizeof(int) * shared->size);
+  assert(NULL != build->replica->parent);
+  for ( i = 0; i < shared->size; i++ ) {
+    if ( i < view->levelStart[1] ) build->replica->parent[i] = -1;
+    if ( view->leaf[i] ) continue;
+    for ( j = view->childStart[i]; j < view->childEnd[i]; j++ ) build->replica->parent[j] = i;
+  }
+  copyReplicaExprs(build->replica, shared);
+  return NULL;
+}
+
+CDGReplicatedGraph* newReplicatedGraph(CDGNode* root, int numaNodes) {
+  assert(NULL != root);
+  assert(0 <= numaNodes);
+  CDGReplicatedGraph* graph = (CDGReplicatedGraph*)malloc(sizeof(CDGReplicatedGraph));
+  const char* simulated = getenv("CDG_NUMA_NODES");
+  int i;
+  assert(NULL != graph);
+  if ( 0 == numaNodes && NULL != simulated ) numaNodes = atoi(simulated);
+  graph->cpuCnt = (int)sysconf(_SC_NPROCESSORS_CONF);
+  if ( graph->cpuCnt < 1 ) graph->cpuCnt = 1;
+  graph->cpuNode = (int*)calloc(graph->cpuCnt, sizeof(int));
+  assert(NULL != graph->cpuNode);
+  if ( 0 < numaNodes ) {
+    graph->replicaCnt = numaNodes;
+    for ( i = 0; i < graph->cpuCnt; i++ ) graph->cpuNode[i] = (int)((long)i * numaNodes / graph->cpuCnt);
+  } else {
+    graph->replicaCnt = readNumaTopology(graph->cpuNode, graph->cpuCnt);
+  }
+  graph->shared = newLevelGraph(root);
+  graph->replicas = (CDGReplica*)malloc(sizeof(CDGReplica) * graph->replicaCnt);
+  ReplicaBuild* builds = (ReplicaBuild*)malloc(sizeof(ReplicaBuild) * graph->replicaCnt);
+  pthread_t* threads = (pthread_t*)malloc(sizeof(pthread_t) * graph->replicaCnt);
+  assert(NULL != graph->replicas && NULL != builds && NULL != threads);
+  for ( i = 0; i < graph->replicaCnt; i++ ) {
+    graph->replicas[i].numaNode = i;
+    builds[i].graph = graph;
+    builds[i].replica = &graph->replicas[i];
+    if ( 0 != pthread_create(&threads[i], NULL, buildReplica, &builds[i]) ) {
+      buildReplica(&builds[i]);
+      threads[i] = pthread_self();
+    }
+  }
+  for ( i = 0; i < graph->replicaCnt; i++ ) {
+    if ( !pthread_equal(threads[i], pthread_self()) ) pthread_join(threads[i], NULL);
+  }
+  free(builds);
+  free(threads);
+  return graph;
+}
+
+CDGReplica* getLocalReplica(CDGReplicatedGraph* graph) {
+  assert(NULL != graph);
+  int cpu = sched_getcpu();
+  if ( cpu < 0 || cpu >= graph->cpuCnt ) return &graph->replicas[0];
+  return &graph->replicas[graph->cpuNode[cpu]];
+}
+
+CDGNode* updateReplicatedCDG(CDGReplicatedGraph* graph) {
+  return updateCDGLevels(&getLocalReplica(graph)->view);
+}
+
+/* State of a node within a call: its slot in the overlay, NULL if the call did not change it */
+
+int* findOverlayState(ReplicaOverlay* overlay, int index) {
+  unsigned int j;
+  if ( 0 == overlay->slotCnt ) return NULL;
+  j = (unsigned int)index * 0x9E3779B1u & (overlay->slotCnt - 1);
+  while ( 0 != overlay->keys[j] ) {
+    if ( index + 1 == overlay->keys[j] ) return &overlay->state[3 * j];
+    j = (j + 1) & (overlay->slotCnt - 1);
+  }
+  return NULL;
+}
+
+void growOverlay(ReplicaOverlay* overlay) {
+  int* keys = overlay->keys;
+  int* state = overlay->state;
+  int slotCnt = overlay->slotCnt;
+  int i;
+  unsigned int j;
+  overlay->slotCnt = 0 == slotCnt ? 256 : 2 * slotCnt;
+  overlay->keys = (int*)calloc(overlay->slotCnt, sizeof(int));
+  overlay->state = (int*)malloc(sizeof(int) * 3 * overlay->slotCnt);
+  assert(NULL != overlay->keys && NULL != overlay->state);
+  for ( i = 0; i < slotCnt; i++ ) {
+    if ( 0 == keys[i] ) continue;
+    j = (unsigned int)(keys[i] - 1) * 0x9E3779B1u & (overlay->slotCnt - 1);
+    while ( 0 != overlay->keys[j] ) j = (j + 1) & (overlay->slotCnt - 1);
+    overlay->keys[j] = keys[i];
+    memcpy(&overlay->state[3 * j], &state[3 * i], sizeof(int) * 3);
+  }
+  free(keys);
+  free(state);
+}
+
+/* Returns the state of a node to change, copying it from the shared region the first time */
+
+int* writeOverlayState(ReplicaOverlay* overlay, CDGLevelGraph* view, int index) {
+  int* state = findOverlayState(overlay, index);
+  unsigned int j;
+  if ( NULL != state ) return state;
+  if ( 2 * (overlay->count + 1) > overlay->slotCnt ) growOverlay(overlay);
+  j = (unsigned int)index * 0x9E3779B1u & (overlay->slotCnt - 1);
+  while ( 0 != overlay->keys[j] ) j = (j + 1) & (overlay->slotCnt - 1);
+  overlay->keys[j] = index + 1;
+  overlay->count++;
+  state = &overlay->state[3 * j];
+  state[0] = view->score[index];
+  state[1] = view->outcome[index];
+  state[2] = view->implicit[index];
+  return state;
+}
+
+int overlayScore(ReplicaOverlay* overlay, CDGLevelGraph* view, int index) {
+  int* state = findOverlayState(overlay, index);
+  return NULL == state ? view->score[index] : state[0];
+}
+
+int overlayOutcome(ReplicaOverlay* overlay, CDGLevelGraph* view, int index) {
+  int* state = findOverlayState(overlay, index);
+  return NULL == state ? view->outcome[index] : state[1];
+}
+
+int overlayImplicit(ReplicaOverlay* overlay, CDGLevelGraph* view, int index) {
+  int* state = findOverlayState(overlay, index);
+  return NULL == state ? view->implicit[index] : state[2];
+}
+
+/* Same as updateScore on a decision node of the replica, reading its children through the overlay */
+
+void rescoreOverlayNode(ReplicaOverlay* overlay, CDGLevelGraph* view, int index) {
+  int sums[2] = { 0, 0 };
+  int uncovered[2] = { 0, 0 };
+  int* state;
+  int j, side, implicit;
+  for ( j = view->childStart[index]; j < view->childEnd[index]; j++ ) {
+    side = j < view->childMid[index];
+    if ( view->leaf[j] ) {
+      uncovered[side] += 0 < overlayScore(overlay, view, j);
+    } else {
+      sums[side] += overlayScore(overlay, view, j);
+    }
+  }
+  implicit = overlayImplicit(overlay, view, index);
+  state = writeOverlayState(overlay, view, index);
+  if ( 0 == sums[1] && 0 == sums[0] ) {
+    uncovered[1] += implicit & CDG_IMPLICIT_TRUE;
+    uncovered[0] += 0 != (implicit & CDG_IMPLICIT_FALSE);
+    state[0] = 0 < uncovered[1] || 0 < uncovered[0];
+    state[1] = 0 < uncovered[1] || 0 == uncovered[0];
+  } else if ( sums[1] >= sums[0] ) {
+    state[0] = sums[1] + 1;
+    state[1] = 1;
+  } else {
+    state[0] = sums[0] + 1;
+    state[1] = 0;
+  }
+}
+
+/* Same as transactUpdateScores, from a node up to the first ancestor whose score does not change */
+
+void rescoreOverlayAncestors(ReplicaOverlay* overlay, CDGReplica* replica, int index) {
+  int oldScore;
+  while ( 0 <= index ) {
+    oldScore = overlayScore(overlay, &replica->view, index);
+    rescoreOverlayNode(overlay, &replica->view, index);
+    if ( oldScore == overlayScore(overlay, &replica->view, index) ) break;
+    index = replica->parent[index];
+  }
+}
+
+/* Same as walkPath without infeasible cores, over the nodes [start, end) of the replica */
+
+CDGNode* walkReplica(ReplicaOverlay* overlay, CDGReplica* replica, int start, int end) {
+  CDGLevelGraph* view = &replica->view;
+  CDGNode* pathNode = newBlankNode();
+  CDGNode* temp = pathNode;
+  int i, outcome;
+  for ( i = start; i < end; i++ ) {
+    if ( 0 == overlayScore(overlay, view, i) ) continue;
+    if ( view->leaf[i] ) {
+      writeOverlayState(overlay, view, i)[0] = 0;
+      rescoreOverlayAncestors(overlay, replica, replica->parent[i]);
+      continue;
+    }
+    outcome = overlayOutcome(overlay, view, i);
+    setNextNode(temp, setExpr(setID(newBlankNode(), replica->id[i]), replica->expr[i]));
+    temp = getNextNode(temp);
+    setOutcome(temp, outcome);
+    if ( outcome ) {
+      setTrueNodeSet(temp, walkReplica(overlay, replica, view->childStart[i], view->childMid[i]));
+    } else {
+      setFalseNodeSet(temp, walkReplica(overlay, replica, view->childMid[i], view->childEnd[i]));
+    }
+    if ( overlayImplicit(overlay, view, i) & CDG_IMPLICIT(outcome) ) {
+      writeOverlayState(overlay, view, i)[2] &= ~CDG_IMPLICIT(outcome);
+      rescoreOverlayAncestors(overlay, replica, i);
+    }
+  }
+  temp = getNextNode(pathNode);
+  deleteNode(pathNode);
+  return temp;
+}
+
+CDGPath* getReplicatedTopPaths(CDGReplicatedGraph* graph, int numberOfPaths) {
+  CDGReplica* replica = getLocalReplica(graph);
+  ReplicaOverlay overlay = { NULL, NULL, 0, 0 };
+  CDGPath* pathHead = NULL;
+  CDGPath* currPath = NULL;
+  CDGNode* path;
+  while ( numberOfPaths-- ) {
+    path = walkReplica(&overlay, replica, 0, replica->view.levelStart[1]);
+    if ( NULL == path ) break;
+    if ( NULL == pathHead ) {
+      pathHead = setPathNode(newPath(), path);
+      currPath = pathHead;
+    } else {
+      setNextPath(currPath, setPathNode(newPath(), path));
+      currPath = getNextPath(currPath);
+    }
+  }
+  free(overlay.keys);
+  free(overlay.state);
+  return pathHead;
+}
+
+void deleteReplicatedGraph(CDGReplicatedGraph* graph) {
+  assert(NULL != graph);
+  CDGLevelGraph* view;
+  int i;
+  for ( i = 0; i < graph->replicaCnt; i++ ) {
+    view = &graph->replicas[i].view;
+    free(view->nodes);
+    free(view->leaf);
+    free(view->childStart);
+    free(view->childMid);
+    free(view->childEnd);
+    free(view->levelStart);
+    free(view->condSum);
+    free(view->uncovSum);
+    free(graph->replicas[i].parent);
+    free(graph->replicas[i].id);
+    free(graph->replicas[i].expr);
+    free(graph->replicas[i].exprData);
+  }
+  free(graph->replicas);
+  free(graph->cpuNode);
+  deleteLevelGraph(graph->shared);
+  free(graph);
+}
@@ -0,0 +1,100 @@
+#ifndef CDG_NUMA_H
+#define CDG_NUMA_H
+
+#include "cdg.h"
+#include "cdgLevels.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* NUMA replicated structure
+ *
+ * On hosts with several NUMA nodes, threads walking a CDG allocated on another node pay the
+ * remote latency on every pointer chase. A CDGReplicatedGraph freezes the structure of a CDG
+ * as a level graph (see cdgLevels.h) and copies it once per NUMA node, each copy made by a
+ * thread pinned to the node so that its pages are allocated there. The mutable state, the
+ * score, outcome and implicit blocks of each node, stays in one shared region of three ints
+ * per node.
+ *
+ * Every call reads the replica of the NUMA node of the calling thread (see sched_getcpu),
+ * so threads need no setup beyond running where they are scheduled. The topology is read
+ * from /sys/devices/system/node. Setting CDG_NUMA_NODES in the environment simulates that
+ * many nodes instead, splitting the CPUs into equal contiguous groups.
+ *
+ * Like the level graph, only plain coverage without a scoring is supported, and the structure
+ * of the CDG must not change while the replicated graph is in use */
+
+/* CDGReplica - Copy of the frozen structure, allocated on one NUMA node
+ * @view - Level graph reading the structure and the scratch sums from this replica and the
+ *         scores, outcomes and implicit blocks from the shared region
+ * @parent - Index of the parent of each node, -1 for the root list
+ * @id - Id of each node, so that path nodes are built without reading the CDG nodes
+ * @expr - Expr of each node, NULL for none, pointing into exprData
+ * @exprData - Copies of the exprs
+ * @numaNode - NUMA node holding the replica */
+
+typedef struct CDGReplica {
+  CDGLevelGraph view;
+  int* parent;
+  int* id;
+  const char** expr;
+  char* exprData;
+  int numaNode;
+} CDGReplica;
+
+/* CDGReplicatedGraph - Structure of a CDG replicated per NUMA node
+ * @shared - Level graph the replicas were copied from. Its score, outcome and implicit
+ *           arrays are the shared region
+ * @replicas - One replica per NUMA node
+ * @replicaCnt - Number of replicas
+ * @cpuNode - Replica of each CPU
+ * @cpuCnt - Number of CPUs */
+
+typedef struct CDGReplicatedGraph {
+  CDGLevelGraph* shared;
+  CDGReplica* replicas;
+  int replicaCnt;
+  int* cpuNode;
+  int cpuCnt;
+} CDGReplicatedGraph;
+
+/* newReplicatedGraph - Freezes the structure of a CDG and replicates it per NUMA node.
+ *                      Reads the current scores of the CDG
+ * @root - Root of CDG
+ * @numaNodes - Number of NUMA nodes to simulate, 0 to use the topology of the host */
+
+CDGReplicatedGraph* newReplicatedGraph(CDGNode* root, int numaNodes);
+
+/* getLocalReplica - Returns the replica of the NUMA node of the calling thread
+ * @graph - a replicated graph */
+
+CDGReplica* getLocalReplica(CDGReplicatedGraph* graph);
+
+/* updateReplicatedCDG - Same as updateCDGLevels, rescoring through the local replica.
+ *                       Returns the root of the CDG. Must not run concurrently with any
+ *                       other call on the graph
+ * @graph - a replicated graph */
+
+CDGNode* updateReplicatedCDG(CDGReplicatedGraph* graph);
+
+/* getReplicatedTopPaths - Same as getTopPaths, walking the local replica and the shared scores.
+ *                         Leaves covered along the way are kept in a private overlay of
+ *                         the call, so any number of threads can query at once. Path nodes
+ *                         take their ids and exprs from the replica (see setExpr), so they
+ *                         share no predicate with the CDG unless a parser is active
+ * @graph - a replicated graph, up to date (see updateReplicatedCDG)
+ * @numberOfPaths - Maximum number of paths to be returned */
+
+CDGPath* getReplicatedTopPaths(CDGReplicatedGraph* graph, int numberOfPaths);
+
+/* deleteReplicatedGraph - Deallocates a replicated graph. The CDG is left untouched
+ * @graph - a replicated graph */
+
+void deleteReplicatedGraph(CDGReplicatedGraph* graph);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,296 @@
+#include <unistd.h>
+#include "cdgParallel.h"
+
+void addStealLeaf(CDGStealTask* task, CDGNode* leaf, int outcome) {
+  if ( task->leafCnt == task->leafCapacity ) {
+    task->leafCapacity = 0 == task->leafCapacity ? 16 : 2 * task->leafCapacity;
+    task->leaves = (CDGStealLeaf*)realloc(task->leaves, sizeof(CDGStealLeaf) * task->leafCapacity);
+    assert(NULL != task->leaves);
+  }
+  task->leaves[task->leafCnt].node = leaf;
+  task->leaves[task->leafCnt].outcome = outcome;
+  task->leafCnt++;
+}
+
+/* Records the implicit empty block on the chosen side of a decision, if it is uncovered */
+
+void addStealImplicit(CDGStealTask* task, CDGNode* node) {
+  if ( getFlags(node) & CDG_IMPLICIT(getOutcome(node)) ) addStealLeaf(task, node, getOutcome(node));
+}
+
+/* Walks like getTopPath without writing to the CDG, recording the leaves to cover */
+
+CDGNode* walkTopPath(CDGNode* node, CDGStealTask* task) {
+  CDGNode* pathNode = NULL;
+  CDGNode* temp = NULL;
+  CDGNode* curr;
+  while (node) {
+    if ( 0 != getScore(node) ) {
+      if ( isLeaf(node) ) {
+        addStealLeaf(task, node, -1);
+      } else {
+        curr = copyToPathNode(newBlankNode(), node);
+        if ( NULL == temp ) {
+          pathNode = curr;
+        } else {
+          setNextNode(temp, curr);
+        }
+        temp = curr;
+        if (getOutcome(node)) {
+          setTrueNodeSet(temp, walkTopPath(getTrueNodeSet(node), task));
+        } else {
+          setFalseNodeSet(temp, walkTopPath(getFalseNodeSet(node), task));
+        }
+        addStealImplicit(task, node);
+      }
+    }
+    node = getNextNode(node);
+  }
+  return pathNode;
+}
+
+void runStealTask(CDGStealTask* task) {
+  CDGNode* node = task->node;
+  task->path = copyToPathNode(newBlankNode(), node);
+  if (getOutcome(node)) {
+    setTrueNodeSet(task->path, walkTopPath(getTrueNodeSet(node), task));
+  } else {
+    setFalseNodeSet(task->path, walkTopPath(getFalseNodeSet(node), task));
+  }
+  addStealImplicit(task, node);
+}
+
+int popStealTask(CDGStealDeque* deque) {
+  int task = -1;
+  pthread_mutex_lock(&deque->lock);
+  if ( deque->top < deque->bottom ) {
+    task = deque->tasks[--deque->bottom];
+  }
+  pthread_mutex_unlock(&deque->lock);
+  return task;
+}
+
+int stealTask(CDGStealDeque* deque) {
+  int task = -1;
+  pthread_mutex_lock(&deque->lock);
+  if ( deque->top < deque->bottom ) {
+    task = deque->tasks[deque->top++];
+  }
+  pthread_mutex_unlock(&deque->lock);
+  return task;
+}
+
+/* Tasks are only created before a walk starts, so a worker is done once every deque is empty */
+
+void runStealWorker(CDGStealPool* pool, int worker) {
+  int task, i;
+  while (1) {
+    task = popStealTask(&pool->deques[worker]);
+    for ( i = 1; -1 == task && i < pool->numThreads; i++ ) {
+      task = stealTask(&pool->deques[(worker + i) % pool->numThreads]);
+    }
+    if ( -1 == task ) break;
+    runStealTask(&pool->tasks[task]);
+  }
+  pthread_mutex_lock(&pool->lock);
+  if ( 0 == --pool->active ) pthread_cond_signal(&pool->done);
+  pthread_mutex_unlock(&pool->lock);
+}
+
+typedef struct StealThreadArg {
+  CDGStealPool* pool;
+  int worker;
+} StealThreadArg;
+
+void* runStealThread(void* arg) {
+  StealThreadArg* threadArg = (StealThreadArg*)arg;
+  CDGStealPool* pool = threadArg->pool;
+  int worker = threadArg->worker;
+  free(threadArg);
+  unsigned long seen = 0;
+  pthread_mutex_lock(&pool->lock);
+  while (1) {
+    while ( seen == pool->generation && !pool->stop ) {
+      pthread_cond_wait(&pool->start, &pool->lock);
+    }
+    if ( pool->stop ) break;
+    seen = pool->generation;
+    pthread_mutex_unlock(&pool->lock);
+    runStealWorker(pool, worker);
+    pthread_mutex_lock(&pool->lock);
+  }
+  pthread_mutex_unlock(&pool->lock);
+  return NULL;
+}
+
+CDGStealPool* newStealPool(int numThreads) {
+  if ( 0 >= numThreads ) numThreads = (int)sysconf(_SC_NPROCESSORS_ONLN);
+  if ( 0 >= numThreads ) numThreads = 1;
+  CDGStealPool* pool;
+  pool = (CDGStealPool*)malloc(sizeof(CDGStealPool));
+  assert(NULL != pool);
+  pool->numThreads = numThreads;
+  pool->threads = (pthread_t*)malloc(sizeof(pthread_t) * numThreads);
+  pool->deques = (CDGStealDeque*)malloc(sizeof(CDGStealDeque) * numThreads);
+  assert(NULL != pool->threads && NULL != pool->deques);
+  pool->tasks = NULL;
+  pool->taskCnt = 0;
+  pool->taskCapacity = 0;
+  pool->generation = 0;
+  pool->active = 0;
+  pool->stop = 0;
+  pthread_mutex_init(&pool->lock, NULL);
+  pthread_cond_init(&pool->start, NULL);
+  pthread_cond_init(&pool->done, NULL);
+  int i, rc;
+  for ( i = 0; i < numThreads; i++ ) {
+    pool->deques[i].tasks = NULL;
+    pool->deques[i].top = 0;
+    pool->deques[i].bottom = 0;
+    pthread_mutex_init(&pool->deques[i].lock, NULL);
+  }
+  StealThreadArg* arg;
+  for ( i = 1; i < numThreads; i++ ) {
+    arg = (StealThreadArg*)malloc(sizeof(StealThreadArg));
+    assert(NULL != arg);
+    arg->pool = pool;
+    arg->worker = i;
+    rc = pthread_create(&pool->threads[i], NULL, runStealThread, arg);
+    assert(0 == rc);
+  }
+  return pool;
+}
+
+void addStealTask(CDGStealPool* pool, CDGNode* node) {
+  int i;
+  if ( pool->taskCnt == pool->taskCapacity ) {
+    pool->taskCapacity = 0 == pool->taskCapacity ? 16 : 2 * pool->taskCapacity;
+    pool->tasks = (CDGStealTask*)realloc(pool->tasks, sizeof(CDGStealTask) * pool->taskCapacity);
+    assert(NULL != pool->tasks);
+    for ( i = 0; i < pool->numThreads; i++ ) {
+      pool->deques[i].tasks = (int*)realloc(pool->deques[i].tasks, sizeof(int) * pool->taskCapacity);
+      assert(NULL != pool->deques[i].tasks);
+    }
+  }
+  CDGStealTask* task = &pool->tasks[pool->taskCnt++];
+  task->node = node;
+  task->path = NULL;
+  task->leaves = NULL;
+  task->leafCnt = 0;
+  task->leafCapacity = 0;
+}
+
+/* Deals the tasks out in contiguous chunks, last task at the top, so that every worker pops
+ * its own chunk in order while thieves take the subtrees furthest from it */
+
+void dealStealTasks(CDGStealPool* pool) {
+  int i, task, chunk;
+  chunk = (pool->taskCnt + pool->numThreads - 1) / pool->numThreads;
+  for ( i = 0; i < pool->numThreads; i++ ) {
+    pool->deques[i].top = 0;
+    pool->deques[i].bottom = 0;
+  }
+  for ( task = pool->taskCnt - 1; task >= 0; task-- ) {
+    CDGStealDeque* deque = &pool->deques[task / chunk];
+    deque->tasks[deque->bottom++] = task;
+  }
+}
+
+void runStealTasks(CDGStealPool* pool) {
+  if ( 0 == pool->taskCnt ) return;
+  dealStealTasks(pool);
+  pthread_mutex_lock(&pool->lock);
+  pool->active = pool->numThreads;
+  pool->generation++;
+  pthread_cond_broadcast(&pool->start);
+  pthread_mutex_unlock(&pool->lock);
+  runStealWorker(pool, 0);
+  pthread_mutex_lock(&pool->lock);
+  while ( 0 != pool->active ) {
+    pthread_cond_wait(&pool->done, &pool->lock);
+  }
+  pthread_mutex_unlock(&pool->lock);
+}
+
+CDGNode* getTopPathParallel(CDGStealPool* pool, CDGNode* node, CDGTransaction* txn) {
+  assert(NULL != pool);
+  assert(NULL == txn->scoring || NULL == txn->scoring->cores);
+  CDGNode* curr;
+  pool->taskCnt = 0;
+  for ( curr = node; curr; curr = getNextNode(curr) ) {
+    if ( 0 != getScore(curr) && !isLeaf(curr) ) addStealTask(pool, curr);
+  }
+  runStealTasks(pool);
+
+  CDGNode* pathNode = NULL;
+  CDGNode* temp = NULL;
+  CDGStealTask* task = pool->tasks;
+  int i;
+  for ( curr = node; curr; curr = getNextNode(curr) ) {
+    if ( 0 == getScore(curr) ) continue;
+    if ( isLeaf(curr) ) {
+      transactSetScore(txn, curr, 0);
+      continue;
+    }
+    if ( NULL == temp ) {
+      pathNode = task->path;
+    } else {
+      setNextNode(temp, task->path);
+    }
+    temp = task->path;
+    for ( i = 0; i < task->leafCnt; i++ ) {
+      if ( 0 > task->leaves[i].outcome ) {
+        transactSetScore(txn, task->leaves[i].node, 0);
+      } else {
+        transactCoverImplicit(txn, task->leaves[i].node, task->leaves[i].outcome);
+      }
+    }
+    free(task->leaves);
+    task++;
+  }
+  pool->taskCnt = 0;
+  return pathNode;
+}
+
+CDGPath* getTopPathsParallel(CDGStealPool* pool, CDGNode* root, int numberOfPaths) {
+  CDGPath* pathHead = NULL;
+  CDGNode* path;
+  CDGPath* currPath;
+  CDGTransaction* txn = beginTransaction();
+  while ( numberOfPaths-- ) {
+    path = getTopPathParallel(pool, root, txn);
+    if ( NULL == path ) break;
+    if ( NULL == pathHead ) {
+      pathHead = setPathNode(newPath(), path);
+      currPath = pathHead;
+    } else {
+      setNextPath(currPath, setPathNode(newPath(), path));
+      currPath = getNextPath(currPath);
+    }
+  }
+  rollbackTransaction(txn);
+  return pathHead;
+}
+
+void deleteStealPool(CDGStealPool* pool) {
+  assert(NULL != pool);
+  int i;
+  pthread_mutex_lock(&pool->lock);
+  pool->stop = 1;
+  pthread_cond_broadcast(&pool->start);
+  pthread_mutex_unlock(&pool->lock);
+  for ( i = 1; i < pool->numThreads; i++ ) {
+    pthread_join(pool->threads[i], NULL);
+  }
+  for ( i = 0; i < pool->numThreads; i++ ) {
+    free(pool->deques[i].tasks);
+    pthread_mutex_destroy(&pool->deques[i].lock);
+  }
+  pthread_cond_destroy(&pool->done);
+  pthread_cond_destroy(&pool->start);
+  pthread_mutex_destroy(&pool->lock);
+  free(pool->tasks);
+  free(pool->deques);
+  free(pool->threads);
+  free(pool);
+}
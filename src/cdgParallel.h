@@ -0,0 +1,116 @@
+#ifndef CDG_PARALLEL_H
+#define CDG_PARALLEL_H
+
+#include <pthread.h>
+#include "cdg.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Parallel top path extraction
+ *
+ * While getTopPath walks a decision subtree it only reads nodes of that subtree, and the
+ * leaves it covers only change the scores of their ancestors, which have been read already.
+ * The subtrees of the root sibling list can therefore be walked concurrently as long as the
+ * covered leaves are applied afterwards, in the order the serial walk would have covered them */
+
+/* CDGStealLeaf - Leaf to be covered once the walk is over
+ * @node - The leaf, or the decision node of an implicit empty block (see addDummyNodes)
+ * @outcome - Side of the implicit block, -1 for a leaf */
+
+typedef struct CDGStealLeaf {
+  CDGNode* node;
+  int outcome;
+} CDGStealLeaf;
+
+/* CDGStealTask - Walk of one decision subtree of the root sibling list
+ * @node - Root of the subtree
+ * @path - Path built for the subtree
+ * @leaves - Leaves and implicit blocks to be covered, in walk order
+ * @leafCnt - Number of leaves
+ * @leafCapacity - Allocated size of leaves */
+
+typedef struct CDGStealTask {
+  CDGNode* node;
+  CDGNode* path;
+  CDGStealLeaf* leaves;
+  int leafCnt;
+  int leafCapacity;
+} CDGStealTask;
+
+/* CDGStealDeque - Tasks of a worker. The owner pops from the bottom, thieves from the top
+ * @tasks - Task indices
+ * @top - Index of the next task to be stolen
+ * @bottom - End of the tasks
+ * @lock - Protects top and bottom */
+
+typedef struct CDGStealDeque {
+  int* tasks;
+  int top;
+  int bottom;
+  pthread_mutex_t lock;
+} CDGStealDeque;
+
+/* CDGStealPool - Work stealing pool of threads building top paths
+ * @numThreads - Number of workers, including the calling thread
+ * @threads - Background workers, numThreads - 1 of them
+ * @deques - Deque of each worker
+ * @tasks - Tasks of the current walk
+ * @taskCnt - Number of tasks of the current walk
+ * @taskCapacity - Allocated size of tasks and of every deque
+ * @generation - Number of walks started, wakes the background workers
+ * @active - Number of workers still running the current walk
+ * @stop - Set to stop the background workers
+ * @lock - Protects generation, active and stop
+ * @start - Signals a new walk or stop
+ * @done - Signals the end of the current walk */
+
+typedef struct CDGStealPool {
+  int numThreads;
+  pthread_t* threads;
+  CDGStealDeque* deques;
+  CDGStealTask* tasks;
+  int taskCnt;
+  int taskCapacity;
+  unsigned long generation;
+  int active;
+  int stop;
+  pthread_mutex_t lock;
+  pthread_cond_t start;
+  pthread_cond_t done;
+} CDGStealPool;
+
+/* newStealPool - Creates a work stealing pool
+ * @numThreads - Number of workers, 0 to use one per online processor */
+
+CDGStealPool* newStealPool(int numThreads);
+
+/* getTopPathParallel - Same as getTopPath, walking the decision subtrees of the root sibling
+ *                      list on the pool. The path and the covered leaves are identical to
+ *                      the ones of getTopPath. The subtrees are walked apart, so a core
+ *                      spanning several of them cannot be checked: the scoring of the
+ *                      transaction must not have infeasible cores
+ * @pool - a work stealing pool
+ * @node - Root of CDG
+ * @txn - Transaction in which the leaves of the path are covered */
+
+CDGNode* getTopPathParallel(CDGStealPool* pool, CDGNode* node, CDGTransaction* txn);
+
+/* getTopPathsParallel - Same as getTopPaths, building every path with getTopPathParallel
+ * @pool - a work stealing pool
+ * @root - Root of CDG
+ * @numberOfPaths - Maximum number of paths to be returned */
+
+CDGPath* getTopPathsParallel(CDGStealPool* pool, CDGNode* root, int numberOfPaths);
+
+/* deleteStealPool - Stops the workers and deallocates the pool
+ * @pool - a work stealing pool */
+
+void deleteStealPool(CDGStealPool* pool);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,124 @@
+#include "cdgPathTrie.h"
+
+CDGPathTrie* newTrieNode(int id, int outcome, const char* expr) {
+  CDGPathTrie* trie;
+  trie = (CDGPathTrie*)malloc(sizeof(CDGPathTrie));
+  assert(NULL != trie);
+  trie->id = id;
+  trie->outcome = outcome;
+  trie->expr = NULL;
+  if ( NULL != expr ) {
+    trie->expr = (char*)malloc(sizeof(char)*(strlen(expr)+1));
+    strcpy(trie->expr, expr);
+  }
+  trie->pathEnds = 0;
+  trie->children = NULL;
+  trie->next = NULL;
+  return trie;
+}
+
+CDGPathTrie* newPathTrie() {
+  return newTrieNode(-1, 1, NULL);
+}
+
+CDGPathTrie* getTrieChild(CDGPathTrie* trie, CDGNode* node) {
+  CDGPathTrie* child = trie->children;
+  CDGPathTrie* last = NULL;
+  while ( child ) {
+    if ( child->id == getID(node) && child->outcome == getOutcome(node) ) return child;
+    last = child;
+    child = child->next;
+  }
+  child = newTrieNode(getID(node), getOutcome(node), getExpr(node));
+  if ( NULL == last ) {
+    trie->children = child;
+  } else {
+    last->next = child;
+  }
+  return child;
+}
+
+CDGPathTrie* insertPathNodes(CDGPathTrie* trie, CDGNode* node) {
+  while ( node ) {
+    trie = getTrieChild(trie, node);
+    trie = insertPathNodes(trie, getTrueNodeSet(node));
+    trie = insertPathNodes(trie, getFalseNodeSet(node));
+    node = getNextNode(node);
+  }
+  return trie;
+}
+
+CDGPathTrie* addPathToTrie(CDGPathTrie* trie, CDGNode* path) {
+  assert(NULL != trie);
+  if ( NULL == path ) return trie;
+  insertPathNodes(trie, path)->pathEnds++;
+  return trie;
+}
+
+CDGPathTrie* buildPathTrie(CDGPath* path) {
+  CDGPathTrie* trie = newPathTrie();
+  while ( path ) {
+    addPathToTrie(trie, getPathNode(path));
+    path = getNextPath(path);
+  }
+  return trie;
+}
+
+CDGPathTrie* getTopPathTrie(CDGNode* root, int numberOfPaths) {
+  CDGPathTrie* trie = newPathTrie();
+  CDGNode* path;
+  CDGTransaction* txn = beginTransaction();
+  while ( numberOfPaths-- ) {
+    path = getTopPath(root, txn);
+    if ( NULL == path ) break;
+    addPathToTrie(trie, path);
+    deleteCDG(path);
+  }
+  rollbackTransaction(txn);
+  return trie;
+}
+
+int getPathTrieSize(CDGPathTrie* trie) {
+  if ( NULL == trie ) return 0;
+  return (-1 != trie->id) + getPathTrieSize(trie->children) + getPathTrieSize(trie->next);
+}
+
+void writeTrieAssert(FILE* out, CDGPathTrie* trie) {
+  if ( NULL == trie->expr ) {
+    fprintf(out, "; %d %d\n", trie->id, trie->outcome);
+  } else if ( trie->outcome ) {
+    fprintf(out, "(assert %s)\n", trie->expr);
+  } else {
+    fprintf(out, "(assert (not %s))\n", trie->expr);
+  }
+}
+
+void writeTrieScript(FILE* out, CDGPathTrie* trie) {
+  if ( -1 != trie->id ) writeTrieAssert(out, trie);
+  if ( 0 < trie->pathEnds ) fprintf(out, "(check-sat)\n");
+  CDGPathTrie* child = trie->children;
+  int scoped = NULL != child && NULL != child->next;
+  while ( child ) {
+    if ( scoped ) fprintf(out, "(push 1)\n");
+    writeTrieScript(out, child);
+    if ( scoped ) fprintf(out, "(pop 1)\n");
+    child = child->next;
+  }
+}
+
+void writePathTrieScript(FILE* out, CDGPathTrie* trie) {
+  assert(NULL != out);
+  assert(NULL != trie);
+  writeTrieScript(out, trie);
+}
+
+void deletePathTrie(CDGPathTrie* trie) {
+  CDGPathTrie* next;
+  while ( trie ) {
+    next = trie->next;
+    deletePathTrie(trie->children);
+    if ( NULL != trie->expr ) free(trie->expr);
+    free(trie);
+    trie = next;
+  }
+}
@@ -0,0 +1,74 @@
+#ifndef CDG_PATH_TRIE_H
+#define CDG_PATH_TRIE_H
+
+#include <stdio.h>
+#include "cdg.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* CDGPathTrie - Set of paths sharing their common prefixes of (id, outcome) decisions.
+ *               Decisions of a path are taken in the order printPath visits them
+ * @id - Id of the decision, -1 for the trie root
+ * @outcome - Outcome of the decision
+ * @expr - Predicate of the decision, NULL if not known
+ * @pathEnds - Number of paths ending at this decision
+ * @children - First decision following this one
+ * @next - Next decision following the same prefix */
+
+typedef struct CDGPathTrie {
+  int id;
+  int outcome;
+  char* expr;
+  int pathEnds;
+  struct CDGPathTrie* children;
+  struct CDGPathTrie* next;
+} CDGPathTrie;
+
+/* newPathTrie - Creates and returns an empty path trie */
+
+CDGPathTrie* newPathTrie();
+
+/* addPathToTrie - Adds a path to the trie, sharing the already present prefix and returns
+ *                 the trie
+ * @trie - a path trie
+ * @path - Head node of the path */
+
+CDGPathTrie* addPathToTrie(CDGPathTrie* trie, CDGNode* path);
+
+/* buildPathTrie - Returns a trie of all the paths of a path list
+ * @path - a path head */
+
+CDGPathTrie* buildPathTrie(CDGPath* path);
+
+/* getTopPathTrie - Returns the score-wise top paths of a CDG (see getTopPaths) as a trie
+ * @node - CDG root node
+ * @numberOfPaths - Maximum number of paths to be added */
+
+CDGPathTrie* getTopPathTrie(CDGNode* node, int numberOfPaths);
+
+/* getPathTrieSize - Returns the number of decisions stored in the trie
+ * @trie - a path trie */
+
+int getPathTrieSize(CDGPathTrie* trie);
+
+/* writePathTrieScript - Writes the paths of the trie as an incremental SMT-LIB script.
+ *                       Each decision is asserted once, a (check-sat) follows the last
+ *                       decision of every path and (push)/(pop) scopes are only opened
+ *                       where paths diverge
+ * @out - Stream to write to
+ * @trie - a path trie */
+
+void writePathTrieScript(FILE* out, CDGPathTrie* trie);
+
+/* deletePathTrie - Deallocates memory allocated to the trie
+ * @trie - a path trie */
+
+void deletePathTrie(CDGPathTrie* trie);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,116 @@
+#include <string.h>
+#include "cdgPredicates.h"
+
+static CDGPredicateParser* predicateParser = NULL;
+
+unsigned long long hashPredicate(const char* expr) {
+  unsigned long long hash = 14695981039346656037ULL;
+  for ( ; *expr; expr++ ) hash = (hash ^ (unsigned char)*expr) * 0x100000001b3ULL;
+  return hash ^ (hash >> 32);
+}
+
+CDGPredicateParser* newPredicateParser(CDGParseFunc parse, CDGReleaseFunc release, void* context) {
+  assert(NULL != parse);
+  CDGPredicateParser* parser = (CDGPredicateParser*)malloc(sizeof(CDGPredicateParser));
+  assert(NULL != parser);
+  parser->parse = parse;
+  parser->release = release;
+  parser->context = context;
+  parser->slotCnt = 64;
+  parser->slots = (CDGPredicate**)calloc(parser->slotCnt, sizeof(CDGPredicate*));
+  assert(NULL != parser->slots);
+  parser->count = 0;
+  pthread_mutex_init(&parser->lock, NULL);
+  return parser;
+}
+
+void setPredicateParser(CDGPredicateParser* parser) {
+  predicateParser = parser;
+}
+
+CDGPredicateParser* getPredicateParser() {
+  return predicateParser;
+}
+
+void growPredicateSlots(CDGPredicateParser* parser) {
+  CDGPredicate** slots = parser->slots;
+  int slotCnt = parser->slotCnt;
+  int i;
+  unsigned int j;
+  parser->slotCnt *= 2;
+  parser->slots = (CDGPredicate**)calloc(parser->slotCnt, sizeof(CDGPredicate*));
+  assert(NULL != parser->slots);
+  for ( i = 0; i < slotCnt; i++ ) {
+    if ( NULL == slots[i] ) continue;
+    j = (unsigned int)slots[i]->hash & (parser->slotCnt - 1);
+    while ( NULL != parser->slots[j] ) j = (j + 1) & (parser->slotCnt - 1);
+    parser->slots[j] = slots[i];
+  }
+  free(slots);
+}
+
+CDGPredicate* internPredicate(CDGPredicateParser* parser, const char* expr) {
+  assert(NULL != parser);
+  assert(NULL != expr);
+  unsigned long long hash = hashPredicate(expr);
+  CDGPredicate* predicate;
+  unsigned int j;
+  pthread_mutex_lock(&parser->lock);
+  j = (unsigned int)hash & (parser->slotCnt - 1);
+  while ( NULL != (predicate = parser->slots[j]) ) {
+    if ( hash == predicate->hash && 0 == strcmp(expr, predicate->expr) ) {
+      pthread_mutex_unlock(&parser->lock);
+      return predicate;
+    }
+    j = (j + 1) & (parser->slotCnt - 1);
+  }
+  predicate = (CDGPredicate*)malloc(sizeof(CDGPredicate));
+  assert(NULL != predicate);
+  predicate->refs = 1;
+  predicate->expr = (char*)malloc(sizeof(char)*(strlen(expr)+1));
+  assert(NULL != predicate->expr);
+  strcpy(predicate->expr, expr);
+  predicate->parsed = parser->parse(expr, parser->context);
+  predicate->hash = hash;
+  predicate->release = parser->release;
+  predicate->context = parser->context;
+  parser->slots[j] = predicate;
+  parser->count++;
+  if ( 2 * parser->count > parser->slotCnt ) growPredicateSlots(parser);
+  pthread_mutex_unlock(&parser->lock);
+  return predicate;
+}
+
+int getPredicateCount(CDGPredicateParser* parser) {
+  assert(NULL != parser);
+  pthread_mutex_lock(&parser->lock);
+  int count = parser->count;
+  pthread_mutex_unlock(&parser->lock);
+  return count;
+}
+
+CDGPredicate* retainPredicate(CDGPredicate* predicate) {
+  assert(NULL != predicate);
+  __sync_fetch_and_add(&predicate->refs, 1);
+  return predicate;
+}
+
+void releasePredicate(CDGPredicate* predicate) {
+  assert(NULL != predicate);
+  if ( 0 != __sync_sub_and_fetch(&predicate->refs, 1) ) return;
+  if ( NULL != predicate->release ) predicate->release(predicate->parsed, predicate->context);
+  free(predicate->expr);
+  free(predicate);
+}
+
+void deletePredicateParser(CDGPredicateParser* parser) {
+  assert(NULL != parser);
+  int i;
+  if ( parser == predicateParser ) predicateParser = NULL;
+  for ( i = 0; i < parser->slotCnt; i++ ) {
+    if ( NULL != parser->slots[i] ) releasePredicate(parser->slots[i]);
+  }
+  free(parser->slots);
+  pthread_mutex_destroy(&parser->lock);
+  free(parser);
+}
@@ -0,0 +1,122 @@
+#ifndef CDG_PREDICATES_H
+#define CDG_PREDICATES_H
+
+#include <pthread.h>
+#include "cdg.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Parsed predicates
+ *
+ * Solver front ends parse the expr of every path node they are handed. A predicate parser
+ * registers a parse callback, and while it is active (see setPredicateParser) setExpr gives
+ * a decision node a reference counted CDGPredicate instead of a copy of the string. The
+ * parser keeps one predicate per distinct expr, so each predicate is parsed at most once for
+ * the life of the parser, and nodes with the same expr share it along with its string.
+ *
+ * copyToPathNode makes path nodes share the predicate of the node they are taken from, so
+ * getParsedPredicate on the nodes of getTopPaths and getFeasiblePath results hands back the
+ * parsed form without parsing again. Nodes of compact CDGs have no predicate */
+
+/* CDGParseFunc - Parses a predicate and returns its parsed form, an opaque pointer
+ * @expr - The predicate
+ * @context - Context given to newPredicateParser */
+
+typedef void* (*CDGParseFunc)(const char* expr, void* context);
+
+/* CDGReleaseFunc - Frees the parsed form of a predicate once no node holds it
+ * @parsed - What the parse callback returned
+ * @context - Context given to newPredicateParser */
+
+typedef void (*CDGReleaseFunc)(void* parsed, void* context);
+
+/* CDGPredicate - Predicate shared by the nodes with the same expr
+ * @refs - Number of references held, one by the parser that created it and one per node
+ * @expr - The predicate
+ * @parsed - What the parse callback returned for it
+ * @hash - Hash of expr
+ * @release - Frees parsed with the last reference, NULL for none
+ * @context - Context passed to release */
+
+typedef struct CDGPredicate {
+  int refs;
+  char* expr;
+  void* parsed;
+  unsigned long long hash;
+  CDGReleaseFunc release;
+  void* context;
+} CDGPredicate;
+
+/* CDGPredicateParser - Parse callback and the predicates it parsed. Thread safe
+ * @parse - Parse callback
+ * @release - Release callback, NULL for none
+ * @context - Context passed to the callbacks
+ * @slots - Open addressing hash table of the predicates, NULL for an empty slot
+ * @slotCnt - Number of slots, a power of 2
+ * @count - Number of predicates
+ * @lock - Serializes lookups. parse is called with it held */
+
+typedef struct CDGPredicateParser {
+  CDGParseFunc parse;
+  CDGReleaseFunc release;
+  void* context;
+  CDGPredicate** slots;
+  int slotCnt;
+  int count;
+  pthread_mutex_t lock;
+} CDGPredicateParser;
+
+/* newPredicateParser - Creates and returns a parser with no predicates
+ * @parse - Parse callback
+ * @release - Release callback. May be NULL
+ * @context - Context passed to the callbacks. May be NULL */
+
+CDGPredicateParser* newPredicateParser(CDGParseFunc parse, CDGReleaseFunc release, void* context);
+
+/* setPredicateParser - Activates a parser for setExpr. With NULL (the default) setExpr copies
+ *                      the string
+ * @parser - a parser, or NULL */
+
+void setPredicateParser(CDGPredicateParser* parser);
+
+/* getPredicateParser - Returns the active parser, NULL if none */
+
+CDGPredicateParser* getPredicateParser();
+
+/* internPredicate - Returns the predicate of an expr, parsing it if the parser has not seen it
+ *                   yet. The parser holds the reference, see retainPredicate to keep it longer
+ * @parser - a parser
+ * @expr - a predicate */
+
+CDGPredicate* internPredicate(CDGPredicateParser* parser, const char* expr);
+
+/* getPredicateCount - Returns the number of distinct predicates parsed by a parser
+ * @parser - a parser */
+
+int getPredicateCount(CDGPredicateParser* parser);
+
+/* retainPredicate - Takes a reference to a predicate and returns it. Thread safe
+ * @predicate - a predicate */
+
+CDGPredicate* retainPredicate(CDGPredicate* predicate);
+
+/* releasePredicate - Drops a reference to a predicate, freeing it and its parsed form with the
+ *                    last one. Thread safe
+ * @predicate - a predicate */
+
+void releasePredicate(CDGPredicate* predicate);
+
+/* deletePredicateParser - Drops the references of a parser to its predicates and deallocates
+ *                         it, deactivating it if it is active. Predicates still held by nodes
+ *                         live on until their nodes are deleted
+ * @parser - a parser */
+
+void deletePredicateParser(CDGPredicateParser* parser);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
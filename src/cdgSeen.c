@@ -0,0 +1,113 @@
+#include <string.h>
+#include "cdgSeen.h"
+
+CDGSeenSet* newSeenSet() {
+  CDGSeenSet* seen;
+  seen = (CDGSeenSet*)malloc(sizeof(CDGSeenSet));
+  assert(NULL != seen);
+  seen->slotCnt = 64;
+  seen->slots = (unsigned long long*)calloc(seen->slotCnt, sizeof(unsigned long long));
+  assert(NULL != seen->slots);
+  seen->size = 0;
+  seen->hasZero = 0;
+  return seen;
+}
+
+/* Fingerprints are already mixed, so their low bits pick the slot */
+
+unsigned long long* findSeenSlot(CDGSeenSet* seen, unsigned long long fingerprint) {
+  unsigned int mask = seen->slotCnt - 1;
+  unsigned int i = (unsigned int)fingerprint & mask;
+  while ( 0 != seen->slots[i] && fingerprint != seen->slots[i] ) {
+    i = (i + 1) & mask;
+  }
+  return &seen->slots[i];
+}
+
+void growSeenSet(CDGSeenSet* seen) {
+  unsigned long long* slots = seen->slots;
+  int slotCnt = seen->slotCnt;
+  int i;
+  seen->slotCnt = 2 * slotCnt;
+  seen->slots = (unsigned long long*)calloc(seen->slotCnt, sizeof(unsigned long long));
+  assert(NULL != seen->slots);
+  for ( i = 0; i < slotCnt; i++ ) {
+    if ( 0 != slots[i] ) *findSeenSlot(seen, slots[i]) = slots[i];
+  }
+  free(slots);
+}
+
+int addSeenPath(CDGSeenSet* seen, unsigned long long fingerprint) {
+  assert(NULL != seen);
+  if ( 0 == fingerprint ) {
+    if ( seen->hasZero ) return 0;
+    seen->hasZero = 1;
+    seen->size++;
+    return 1;
+  }
+  if ( 2 * (seen->size + 1) > seen->slotCnt ) growSeenSet(seen);
+  unsigned long long* slot = findSeenSlot(seen, fingerprint);
+  if ( 0 != *slot ) return 0;
+  *slot = fingerprint;
+  seen->size++;
+  return 1;
+}
+
+int hasSeenPath(CDGSeenSet* seen, unsigned long long fingerprint) {
+  assert(NULL != seen);
+  if ( 0 == fingerprint ) return seen->hasZero;
+  return 0 != *findSeenSlot(seen, fingerprint);
+}
+
+int getSeenCount(CDGSeenSet* seen) {
+  assert(NULL != seen);
+  return seen->size;
+}
+
+void clearSeenSet(CDGSeenSet* seen) {
+  assert(NULL != seen);
+  memset(seen->slots, 0, sizeof(unsigned long long) * seen->slotCnt);
+  seen->size = 0;
+  seen->hasZero = 0;
+}
+
+CDGPath* getDistinctTopPaths(CDGNode* root, int numberOfPaths, CDGSeenSet* seen) {
+  return getDistinctTopPathsWith(root, numberOfPaths, seen, NULL);
+}
+
+CDGPath* getDistinctTopPathsWith(CDGNode* root, int numberOfPaths, CDGSeenSet* seen, CDGScoring* scoring) {
+  assert(NULL != seen);
+  CDGPath* pathHead = NULL;
+  CDGPath* currPath = NULL;
+  CDGNode* path;
+  unsigned long long fingerprint;
+  int logSize;
+  CDGTransaction* txn = beginTransactionWith(scoring);
+  while ( 0 < numberOfPaths ) {
+    logSize = stackSize(txn->undoLog);
+    path = getTopPathFingerprint(root, txn, &fingerprint);
+    if ( NULL == path ) break;
+    if ( !addSeenPath(seen, fingerprint) ) {
+      deleteCDG(path);
+      /* Nothing got covered, the same path would be built again */
+      if ( logSize == stackSize(txn->undoLog) ) break;
+      continue;
+    }
+    if ( NULL == pathHead ) {
+      pathHead = setPathNode(newPath(), path);
+      currPath = pathHead;
+    } else {
+      setNextPath(currPath, setPathNode(newPath(), path));
+      currPath = getNextPath(currPath);
+    }
+    numberOfPaths--;
+  }
+  rollbackTransaction(txn);
+  return pathHead;
+}
+
+void deleteSeenSet(CDGSeenSet* seen) {
+  assert(NULL != seen);
+  free(seen->slots);
+  free(seen);
+}
@@ -0,0 +1,78 @@
+#ifndef CDG_SEEN_H
+#define CDG_SEEN_H
+
+#include "cdg.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* CDGSeenSet - Open addressing hash set of the fingerprints of paths already handed out
+ *              (see getPathFingerprint)
+ * @slots - Slots, a power of two of them. 0 marks an empty slot
+ * @slotCnt - Number of slots
+ * @size - Number of fingerprints held, including a 0 fingerprint
+ * @hasZero - 1 if the 0 fingerprint is held, 0 otherwise */
+
+typedef struct CDGSeenSet {
+  unsigned long long* slots;
+  int slotCnt;
+  int size;
+  int hasZero;
+} CDGSeenSet;
+
+/* newSeenSet - Creates and returns an empty seen set */
+
+CDGSeenSet* newSeenSet();
+
+/* addSeenPath - Adds a fingerprint to the set. Returns 1 if it was not in the set, 0 otherwise
+ * @seen - a seen set
+ * @fingerprint - Fingerprint of a path */
+
+int addSeenPath(CDGSeenSet* seen, unsigned long long fingerprint);
+
+/* hasSeenPath - Returns 1 if a fingerprint is in the set, 0 otherwise
+ * @seen - a seen set
+ * @fingerprint - Fingerprint of a path */
+
+int hasSeenPath(CDGSeenSet* seen, unsigned long long fingerprint);
+
+/* getSeenCount - Returns the number of fingerprints in the set
+ * @seen - a seen set */
+
+int getSeenCount(CDGSeenSet* seen);
+
+/* clearSeenSet - Removes all the fingerprints from the set
+ * @seen - a seen set */
+
+void clearSeenSet(CDGSeenSet* seen);
+
+/* getDistinctTopPaths - Returns the score-wise top paths of a CDG (see getTopPaths) whose
+ *                       fingerprints are not in the seen set, and adds them to it
+ *                     - A path already seen is dropped as soon as getTopPath has built it and
+ *                       the next best path is taken instead. Its leaves stay covered within
+ *                       the transaction, so it is not built again
+ * @root - CDG root node
+ * @numberOfPaths - Maximum number of paths to be returned
+ * @seen - Fingerprints of the paths handed out before */
+
+CDGPath* getDistinctTopPaths(CDGNode* root, int numberOfPaths, CDGSeenSet* seen);
+
+/* getDistinctTopPathsWith - Same as getDistinctTopPaths for a CDG scored with a scoring
+ * @root - CDG root node
+ * @numberOfPaths - Maximum number of paths to be returned
+ * @seen - Fingerprints of the paths handed out before
+ * @scoring - Scoring of the CDG, NULL for plain coverage */
+
+CDGPath* getDistinctTopPathsWith(CDGNode* root, int numberOfPaths, CDGSeenSet* seen, CDGScoring* scoring);
+
+/* deleteSeenSet - Deallocates a seen set
+ * @seen - a seen set */
+
+void deleteSeenSet(CDGSeenSet* seen);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
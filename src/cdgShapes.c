@@ -0,0 +1,269 @@
+#include <string.h>
+#include "cdgShapes.h"
+
+#define SHAPE_PRIME 0x100000001b3ULL
+
+/* Child shapes of the nodes being hash-consed, the nodes of a set pushed in order */
+
+typedef struct ShapeScratch {
+  int* shapes;
+  int size;
+  int capacity;
+} ShapeScratch;
+
+unsigned long long mixShape(unsigned long long hash) {
+  hash *= 0x9E3779B97F4A7C15ULL;
+  return hash ^ (hash >> 32);
+}
+
+void growShapeSlots(CDGSharing* sharing) {
+  int i;
+  unsigned int mask;
+  unsigned int j;
+  free(sharing->slots);
+  sharing->slotCnt = 0 == sharing->slotCnt ? 64 : 2 * sharing->slotCnt;
+  sharing->slots = (int*)calloc(sharing->slotCnt, sizeof(int));
+  assert(NULL != sharing->slots);
+  mask = sharing->slotCnt - 1;
+  for ( i = 0; i < sharing->shapeCnt; i++ ) {
+    j = (unsigned int)sharing->shapes[i].hash & mask;
+    while ( 0 != sharing->slots[j] ) j = (j + 1) & mask;
+    sharing->slots[j] = i + 1;
+  }
+}
+
+int sameShape(CDGShape* shape, unsigned long long hash, int exprHandle, int children[], int trueCnt, int falseCnt) {
+  return hash == shape->hash && exprHandle == shape->exprHandle && trueCnt == shape->trueCnt
+    && falseCnt == shape->falseCnt && 0 == memcmp(children, shape->children, sizeof(int) * (trueCnt + falseCnt));
+}
+
+/* Returns the shape with a predicate and child shapes, adding it if there is none */
+
+int internShape(CDGSharing* sharing, int exprHandle, int children[], int trueCnt, int falseCnt) {
+  unsigned long long hash = mixShape((unsigned long long)exprHandle << 32 ^ (unsigned long long)trueCnt);
+  int i, shape;
+  for ( i = 0; i < trueCnt + falseCnt; i++ ) hash = (hash ^ (unsigned long long)children[i]) * SHAPE_PRIME;
+  hash = mixShape(hash);
+  if ( 2 * (sharing->shapeCnt + 1) > sharing->slotCnt ) growShapeSlots(sharing);
+  unsigned int mask = sharing->slotCnt - 1;
+  unsigned int j = (unsigned int)hash & mask;
+  while ( 0 != sharing->slots[j] ) {
+    shape = sharing->slots[j] - 1;
+    if ( sameShape(&sharing->shapes[shape], hash, exprHandle, children, trueCnt, falseCnt) ) return shape;
+    j = (j + 1) & mask;
+  }
+  if ( sharing->shapeCnt == sharing->shapeCapacity ) {
+    sharing->shapeCapacity = 0 == sharing->shapeCapacity ? 64 : 2 * sharing->shapeCapacity;
+    sharing->shapes = (CDGShape*)realloc(sharing->shapes, sizeof(CDGShape) * sharing->shapeCapacity);
+    assert(NULL != sharing->shapes);
+  }
+  CDGShape* added = &sharing->shapes[sharing->shapeCnt];
+  added->hash = hash;
+  added->exprHandle = exprHandle;
+  added->children = (int*)malloc(sizeof(int) * (trueCnt + falseCnt + 1));
+  assert(NULL != added->children);
+  memcpy(added->children, children, sizeof(int) * (trueCnt + falseCnt));
+  added->trueCnt = trueCnt;
+  added->falseCnt = falseCnt;
+  added->size = 1;
+  for ( i = 0; i < trueCnt + falseCnt; i++ ) added->size += sharing->shapes[children[i]].size;
+  added->instances = 0;
+  sharing->slots[j] = sharing->shapeCnt + 1;
+  return sharing->shapeCnt++;
+}
+
+void consNodeList(CDGSharing* sharing, CDGNode* node, ShapeScratch* scratch);
+
+int consNode(CDGSharing* sharing, CDGNode* node, ShapeScratch* scratch) {
+  int id = getID(node);
+  assert(0 <= id && id < sharing->size && -1 == sharing->shapeOf[id]);
+  int base = scratch->size;
+  consNodeList(sharing, getTrueNodeSet(node), scratch);
+  int trueCnt = scratch->size - base;
+  consNodeList(sharing, getFalseNodeSet(node), scratch);
+  int shape = internShape(sharing, internString(sharing->exprs, getExpr(node)), &scratch->shapes[base],
+                          trueCnt, scratch->size - base - trueCnt);
+  scratch->size = base;
+  sharing->shapeOf[id] = shape;
+  sharing->shapes[shape].instances++;
+  return shape;
+}
+
+void consNodeList(CDGSharing* sharing, CDGNode* node, ShapeScratch* scratch) {
+  int shape;
+  for ( ; node; node = getNextNode(node) ) {
+    shape = consNode(sharing, node, scratch);
+    if ( scratch->size == scratch->capacity ) {
+      scratch->capacity *= 2;
+      scratch->shapes = (int*)realloc(scratch->shapes, sizeof(int) * scratch->capacity);
+      assert(NULL != scratch->shapes);
+    }
+    scratch->shapes[scratch->size++] = shape;
+  }
+}
+
+CDGSharing* hashConsCDG(CDGNode* root, int maxId) {
+  assert(NULL != root);
+  assert(0 <= maxId);
+  CDGSharing* sharing;
+  ShapeScratch scratch = { NULL, 0, 64 };
+  int i;
+  sharing = (CDGSharing*)malloc(sizeof(CDGSharing));
+  assert(NULL != sharing);
+  sharing->exprs = newInternTable();
+  sharing->shapes = NULL;
+  sharing->shapeCnt = 0;
+  sharing->shapeCapacity = 0;
+  sharing->slots = NULL;
+  sharing->slotCnt = 0;
+  sharing->size = maxId + 1;
+  sharing->shapeOf = (int*)malloc(sizeof(int) * sharing->size);
+  sharing->state = (unsigned long long*)malloc(sizeof(unsigned long long) * sharing->size);
+  assert(NULL != sharing->shapeOf && NULL != sharing->state);
+  for ( i = 0; i < sharing->size; i++ ) sharing->shapeOf[i] = -1;
+  sharing->memo = NULL;
+  sharing->memoSlotCnt = 0;
+  sharing->memoCnt = 0;
+  sharing->reused = 0;
+  growShapeSlots(sharing);
+  scratch.shapes = (int*)malloc(sizeof(int) * scratch.capacity);
+  assert(NULL != scratch.shapes);
+  consNodeList(sharing, root, &scratch);
+  free(scratch.shapes);
+  return sharing;
+}
+
+int getShapeCount(CDGSharing* sharing) {
+  assert(NULL != sharing);
+  return sharing->shapeCnt;
+}
+
+int getShape(CDGSharing* sharing, int id) {
+  assert(NULL != sharing);
+  if ( id < 0 || id >= sharing->size ) return -1;
+  return sharing->shapeOf[id];
+}
+
+int getShapeInstances(CDGSharing* sharing, int shape) {
+  assert(NULL != sharing);
+  assert(0 <= shape && shape < sharing->shapeCnt);
+  return sharing->shapes[shape].instances;
+}
+
+const char* getShapeExpr(CDGSharing* sharing, int shape) {
+  assert(NULL != sharing);
+  assert(0 <= shape && shape < sharing->shapeCnt);
+  return getInternedString(sharing->exprs, sharing->shapes[shape].exprHandle);
+}
+
+/* Sets the coverage state signatures of a node set and returns the signature of the set */
+
+unsigned long long computeStates(CDGSharing* sharing, CDGNode* node) {
+  unsigned long long setState = 0;
+  unsigned long long state;
+  for ( ; node; node = getNextNode(node) ) {
+    assert(0 <= getID(node) && getID(node) < sharing->size && -1 != sharing->shapeOf[getID(node)]);
+    if ( isLeaf(node) ) {
+      state = mixShape((unsigned long long)(unsigned int)getScore(node) + 1);
+    } else {
+      state = mixShape((unsigned long long)getFlags(node) + 1);
+      state = mixShape(state ^ computeStates(sharing, getTrueNodeSet(node)));
+      state = mixShape(state ^ computeStates(sharing, getFalseNodeSet(node)));
+    }
+    sharing->state[getID(node)] = state;
+    setState = (setState ^ state) * SHAPE_PRIME;
+  }
+  return setState;
+}
+
+CDGScoreMemo* findMemo(CDGSharing* sharing, int shape, unsigned long long state) {
+  unsigned int mask = sharing->memoSlotCnt - 1;
+  unsigned int i = (unsigned int)mixShape(state ^ (unsigned long long)shape) & mask;
+  while ( NULL != sharing->memo[i].node && (shape != sharing->memo[i].shape || state != sharing->memo[i].state) ) {
+    i = (i + 1) & mask;
+  }
+  return &sharing->memo[i];
+}
+
+void growMemo(CDGSharing* sharing) {
+  CDGScoreMemo* memo = sharing->memo;
+  int slotCnt = sharing->memoSlotCnt;
+  int i;
+  sharing->memoSlotCnt = 0 == slotCnt ? 64 : 2 * slotCnt;
+  sharing->memo = (CDGScoreMemo*)calloc(sharing->memoSlotCnt, sizeof(CDGScoreMemo));
+  assert(NULL != sharing->memo);
+  for ( i = 0; i < slotCnt; i++ ) {
+    if ( NULL != memo[i].node ) *findMemo(sharing, memo[i].shape, memo[i].state) = memo[i];
+  }
+  free(memo);
+}
+
+/* Copies the scores of a subtree to an isomorphic one. Returns 0, with part of the scores
+   copied, if their coverage states differ after all */
+
+int copyScores(CDGNode* from, CDGNode* to) {
+  CDGNode* a;
+  CDGNode* b;
+  if ( getFlags(from) != getFlags(to) ) return 0;
+  if ( isLeaf(from) ) return getScore(from) == getScore(to);
+  for ( a = getTrueNodeSet(from), b = getTrueNodeSet(to); a; a = getNextNode(a), b = getNextNode(b) ) {
+    if ( !copyScores(a, b) ) return 0;
+  }
+  for ( a = getFalseNodeSet(from), b = getFalseNodeSet(to); a; a = getNextNode(a), b = getNextNode(b) ) {
+    if ( !copyScores(a, b) ) return 0;
+  }
+  setScore(to, getScore(from));
+  setOutcome(to, getOutcome(from));
+  return 1;
+}
+
+void rescoreShared(CDGSharing* sharing, CDGNode* node) {
+  CDGNode* child;
+  CDGScoreMemo* memo = NULL;
+  int id = getID(node);
+  int shape = sharing->shapeOf[id];
+  if ( isLeaf(node) ) return;
+  if ( 1 < sharing->shapes[shape].instances ) {
+    if ( 2 * (sharing->memoCnt + 1) > sharing->memoSlotCnt ) growMemo(sharing);
+    memo = findMemo(sharing, shape, sharing->state[id]);
+    if ( NULL != memo->node && copyScores(memo->node, node) ) {
+      sharing->reused++;
+      return;
+    }
+  }
+  for ( child = getTrueNodeSet(node); child; child = getNextNode(child) ) rescoreShared(sharing, child);
+  for ( child = getFalseNodeSet(node); child; child = getNextNode(child) ) rescoreShared(sharing, child);
+  updateScore(node);
+  if ( NULL != memo && NULL == memo->node ) {
+    memo->node = node;
+    memo->shape = shape;
+    memo->state = sharing->state[id];
+    sharing->memoCnt++;
+  }
+}
+
+CDGNode* updateSharedCDG(CDGSharing* sharing, CDGNode* root, CDGScoring* scoring) {
+  assert(NULL != sharing);
+  assert(NULL != root);
+  CDGNode* node;
+  sharing->reused = 0;
+  if ( NULL != scoring && (NULL != scoring->hits || NULL != scoring->cores) ) return updateCDGWith(root, scoring);
+  computeStates(sharing, root);
+  if ( 0 < sharing->memoSlotCnt ) memset(sharing->memo, 0, sizeof(CDGScoreMemo) * sharing->memoSlotCnt);
+  sharing->memoCnt = 0;
+  for ( node = root; node; node = getNextNode(node) ) rescoreShared(sharing, node);
+  return root;
+}
+
+void deleteSharing(CDGSharing* sharing) {
+  assert(NULL != sharing);
+  int i;
+  for ( i = 0; i < sharing->shapeCnt; i++ ) free(sharing->shapes[i].children);
+  deleteInternTable(sharing->exprs);
+  free(sharing->shapes);
+  free(sharing->slots);
+  free(sharing->shapeOf);
+  free(sharing->state);
+  free(sharing->memo);
+  free(sharing);
+}
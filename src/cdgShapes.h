@@ -0,0 +1,134 @@
+#ifndef CDG_SHAPES_H
+#define CDG_SHAPES_H
+
+#include "cdg.h"
+#include "cdgWire.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Shared subtree shapes
+ *
+ * Macro expansion and inlining produce many decision subtrees that are identical except for
+ * their block ids. hashConsCDG gives every node a shape: its predicate and the shapes of its
+ * trueNodeSet and falseNodeSet, in order. Subtrees with the same shape are isomorphic, so the
+ * shape and its predicates are stored once in the table, while the ids, scores and implicit
+ * branches stay per instance in the nodes. hashConsCDG only reads the CDG, the nodes keep the
+ * exprs they own.
+ *
+ * Scores only depend on the shape of a subtree and its coverage state (leaf scores and
+ * implicit branches), so updateSharedCDG scores one instance per shape and state and copies
+ * the scores to the other instances instead of recomputing them. That does not hold under
+ * hit scoring or infeasible cores, whose weights depend on ids, and updateSharedCDG then
+ * falls back to updateCDGWith */
+
+/* CDGShape - Shape of a subtree
+ * @hash - Hash of the predicate and child shapes
+ * @exprHandle - Handle of the predicate in the expr table, 0 for none
+ * @children - Shapes of the trueNodeSet followed by those of the falseNodeSet
+ * @trueCnt - Number of nodes in the trueNodeSet
+ * @falseCnt - Number of nodes in the falseNodeSet
+ * @size - Number of nodes of the subtree
+ * @instances - Number of nodes with this shape */
+
+typedef struct CDGShape {
+  unsigned long long hash;
+  int exprHandle;
+  int* children;
+  int trueCnt;
+  int falseCnt;
+  int size;
+  int instances;
+} CDGShape;
+
+/* CDGScoreMemo - Subtree scored by the current updateSharedCDG
+ * @node - Root of the scored subtree, NULL for an empty slot
+ * @shape - Its shape
+ * @state - Signature of its coverage state */
+
+typedef struct CDGScoreMemo {
+  CDGNode* node;
+  int shape;
+  unsigned long long state;
+} CDGScoreMemo;
+
+/* CDGSharing - Shapes of the subtrees of a CDG whose ids are 0 to size - 1
+ * @exprs - Distinct predicates
+ * @shapes - Distinct shapes, indexed by shape
+ * @shapeCnt - Number of shapes
+ * @shapeCapacity - Allocated size of shapes
+ * @slots - Open addressing hash table of shape + 1, 0 for an empty slot
+ * @slotCnt - Number of slots, a power of 2
+ * @shapeOf - Shape of each id, -1 for an id not in the CDG
+ * @state - Coverage state signature of the subtree of each id, set by updateSharedCDG
+ * @size - Number of ids
+ * @memo - Open addressing hash table of the subtrees scored by updateSharedCDG
+ * @memoSlotCnt - Number of memo slots, a power of 2
+ * @memoCnt - Number of memo entries
+ * @reused - Number of subtrees the last updateSharedCDG copied the scores of */
+
+typedef struct CDGSharing {
+  CDGInternTable* exprs;
+  CDGShape* shapes;
+  int shapeCnt;
+  int shapeCapacity;
+  int* slots;
+  int slotCnt;
+  int* shapeOf;
+  unsigned long long* state;
+  int size;
+  CDGScoreMemo* memo;
+  int memoSlotCnt;
+  int memoCnt;
+  int reused;
+} CDGSharing;
+
+/* hashConsCDG - Computes the shapes of the subtrees of a CDG and returns them. Ids have to
+ *               be unique. Has to be computed again after changing the structure of the CDG
+ * @root - CDG root node
+ * @maxId - Largest id of the CDG */
+
+CDGSharing* hashConsCDG(CDGNode* root, int maxId);
+
+/* getShapeCount - Returns the number of distinct shapes
+ * @sharing - Shapes of a CDG */
+
+int getShapeCount(CDGSharing* sharing);
+
+/* getShape - Returns the shape of the node with an id, -1 if there is none
+ * @sharing - Shapes of a CDG
+ * @id - Id of a node */
+
+int getShape(CDGSharing* sharing, int id);
+
+/* getShapeInstances - Returns the number of nodes with a shape
+ * @sharing - Shapes of a CDG
+ * @shape - a shape */
+
+int getShapeInstances(CDGSharing* sharing, int shape);
+
+/* getShapeExpr - Returns the predicate of a shape, NULL if none
+ * @sharing - Shapes of a CDG
+ * @shape - a shape */
+
+const char* getShapeExpr(CDGSharing* sharing, int shape);
+
+/* updateSharedCDG - Same as updateCDGWith, scoring each shared shape once per coverage state.
+ *                   Returns the root
+ * @sharing - Shapes of the CDG
+ * @root - CDG root node
+ * @scoring - Scoring of the CDG, NULL for plain coverage */
+
+CDGNode* updateSharedCDG(CDGSharing* sharing, CDGNode* root, CDGScoring* scoring);
+
+/* deleteSharing - Deallocates the shapes of a CDG
+ * @sharing - Shapes of a CDG */
+
+void deleteSharing(CDGSharing* sharing);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,524 @@
+#include <string.h>
+#include <time.h>
+#include "cdgTrace.h"
+
+#define TRACE_HAS_EXPR 0x10
+#define TRACE_OUTCOME 0x8
+#define TRACE_HAS_TRUE 0x4
+#define TRACE_HAS_FALSE 0x2
+#define TRACE_HAS_NEXT 0x1
+
+CDGTraceRecorder* traceRecorder = NULL;
+
+CDGTraceRecorder* newTraceRecorder(FILE* out) {
+  assert(NULL != out);
+  CDGTraceRecorder* rec;
+  rec = (CDGTraceRecorder*)malloc(sizeof(CDGTraceRecorder));
+  assert(NULL != rec);
+  rec->out = out;
+  rec->buf = newWireBuffer();
+  rec->roots = NULL;
+  rec->rootCnt = 0;
+  rec->paths = NULL;
+  rec->pathCnt = 0;
+  rec->pathCapacity = 0;
+  rec->nextPaths = 1;
+  rec->records = 0;
+  pthread_mutex_init(&rec->lock, NULL);
+  fwrite("CDGT", 1, 4, out);
+  wireWriteVarint(rec->buf, CDG_TRACE_VERSION);
+  fwrite(rec->buf->data, 1, rec->buf->size, out);
+  clearWireBuffer(rec->buf);
+  return rec;
+}
+
+void setTraceRecorder(CDGTraceRecorder* rec) {
+  traceRecorder = rec;
+}
+
+CDGTraceRecorder* getTraceRecorder() {
+  return traceRecorder;
+}
+
+void writeRecord(CDGTraceRecorder* rec) {
+  fwrite(rec->buf->data, 1, rec->buf->size, rec->out);
+  clearWireBuffer(rec->buf);
+  rec->records++;
+}
+
+void encodeTraceNodes(CDGWireBuffer* buf, CDGNode* node) {
+  unsigned long long key;
+  while ( node ) {
+    key = zigzag(getID(node)) << 5;
+    if ( getExpr(node) ) key |= TRACE_HAS_EXPR;
+    if ( getOutcome(node) ) key |= TRACE_OUTCOME;
+    if ( getTrueNodeSet(node) ) key |= TRACE_HAS_TRUE;
+    if ( getFalseNodeSet(node) ) key |= TRACE_HAS_FALSE;
+    if ( getNextNode(node) ) key |= TRACE_HAS_NEXT;
+    wireWriteVarint(buf, key);
+    wireWriteVarint(buf, zigzag(getScore(node)));
+    wireWriteVarint(buf, getFlags(node));
+    if ( getExpr(node) ) wireWriteString(buf, getExpr(node));
+    encodeTraceNodes(buf, getTrueNodeSet(node));
+    encodeTraceNodes(buf, getFalseNodeSet(node));
+    node = getNextNode(node);
+  }
+}
+
+void encodeTraceTree(CDGWireBuffer* buf, CDGNode* node) {
+  wireWriteVarint(buf, getPathLength(node));
+  encodeTraceNodes(buf, node);
+}
+
+unsigned long long getPathListFingerprint(CDGPath* paths) {
+  unsigned long long fingerprint = CDG_FINGERPRINT_BASIS;
+  for ( ; paths; paths = getNextPath(paths) ) {
+    fingerprint = (fingerprint ^ getPathFingerprint(getPathNode(paths))) * 0x100000001b3ULL;
+  }
+  return fingerprint;
+}
+
+void writeBuild(CDGTraceRecorder* rec, unsigned long handle, CDGNode* root) {
+  wireWriteVarint(rec->buf, CDG_TRACE_BUILD);
+  wireWriteVarint(rec->buf, handle);
+  encodeTraceTree(rec->buf, root);
+  writeRecord(rec);
+}
+
+/* Returns the handle of a root, recording a build first if the root is new */
+
+unsigned long getRootHandle(CDGTraceRecorder* rec, CDGNode* root) {
+  int i;
+  for ( i = 0; i < rec->rootCnt; i++ ) {
+    if ( root == rec->roots[i].ptr ) return rec->roots[i].handle;
+  }
+  rec->roots = (CDGTraceHandle*)realloc(rec->roots, sizeof(CDGTraceHandle) * (rec->rootCnt + 1));
+  assert(NULL != rec->roots);
+  rec->roots[rec->rootCnt].ptr = root;
+  rec->roots[rec->rootCnt].handle = rec->rootCnt + 1;
+  rec->rootCnt++;
+  writeBuild(rec, rec->rootCnt, root);
+  return rec->rootCnt;
+}
+
+/* A root seen before keeps its handle, the replay swaps the CDG behind it */
+
+void traceBuild(CDGTraceRecorder* rec, CDGNode* root) {
+  assert(NULL != rec);
+  assert(NULL != root);
+  int i;
+  pthread_mutex_lock(&rec->lock);
+  for ( i = 0; i < rec->rootCnt && root != rec->roots[i].ptr; i++ );
+  if ( i < rec->rootCnt ) {
+    writeBuild(rec, rec->roots[i].handle, root);
+  } else {
+    getRootHandle(rec, root);
+  }
+  pthread_mutex_unlock(&rec->lock);
+}
+
+void traceDeleteCDG(CDGTraceRecorder* rec, CDGNode* root) {
+  assert(NULL != rec);
+  int i;
+  pthread_mutex_lock(&rec->lock);
+  for ( i = 0; i < rec->rootCnt; i++ ) {
+    if ( root == rec->roots[i].ptr ) rec->roots[i].ptr = NULL;
+  }
+  pthread_mutex_unlock(&rec->lock);
+}
+
+void traceCoverNodes(CDGTraceRecorder* rec, CDGNode* root, CDGNode* nodes[], int size) {
+  assert(NULL != rec);
+  int i;
+  pthread_mutex_lock(&rec->lock);
+  unsigned long handle = getRootHandle(rec, root);
+  wireWriteVarint(rec->buf, CDG_TRACE_COVER);
+  wireWriteVarint(rec->buf, handle);
+  wireWriteVarint(rec->buf, size);
+  for ( i = 0; i < size; i++ ) {
+    wireWriteVarint(rec->buf, zigzag(getID(nodes[i])) << 1 | (0 != getOutcome(nodes[i])));
+  }
+  writeRecord(rec);
+  pthread_mutex_unlock(&rec->lock);
+}
+
+void traceTopPaths(CDGTraceRecorder* rec, CDGNode* root, int numberOfPaths, CDGPath* paths) {
+  assert(NULL != rec);
+  pthread_mutex_lock(&rec->lock);
+  unsigned long handle = getRootHandle(rec, root);
+  wireWriteVarint(rec->buf, CDG_TRACE_TOP_PATHS);
+  wireWriteVarint(rec->buf, handle);
+  wireWriteVarint(rec->buf, numberOfPaths);
+  if ( NULL == paths ) {
+    wireWriteVarint(rec->buf, 0);
+  } else {
+    if ( rec->pathCnt == rec->pathCapacity ) {
+      rec->pathCapacity = 0 == rec->pathCapacity ? 16 : 2 * rec->pathCapacity;
+      rec->paths = (CDGTraceHandle*)realloc(rec->paths, sizeof(CDGTraceHandle) * rec->pathCapacity);
+      assert(NULL != rec->paths);
+    }
+    rec->paths[rec->pathCnt].ptr = paths;
+    rec->paths[rec->pathCnt].handle = rec->nextPaths;
+    rec->pathCnt++;
+    wireWriteVarint(rec->buf, rec->nextPaths++);
+  }
+  wireWriteVarint(rec->buf, getPathListFingerprint(paths));
+  writeRecord(rec);
+  pthread_mutex_unlock(&rec->lock);
+}
+
+/* Writes a path as the handle of the live path list holding it and its index in the list,
+   or as 0 and its nodes if no live list holds it */
+
+void encodeTracePath(CDGTraceRecorder* rec, CDGNode* path) {
+  CDGPath* paths;
+  int i, index;
+  for ( i = rec->pathCnt - 1; i >= 0; i-- ) {
+    paths = (CDGPath*)rec->paths[i].ptr;
+    for ( index = 0; paths && path != getPathNode(paths); paths = getNextPath(paths) ) index++;
+    if ( NULL == paths ) continue;
+    wireWriteVarint(rec->buf, rec->paths[i].handle);
+    wireWriteVarint(rec->buf, index);
+    return;
+  }
+  wireWriteVarint(rec->buf, 0);
+  encodeTraceTree(rec->buf, path);
+}
+
+void traceFeasiblePath(CDGTraceRecorder* rec, CDGNode* path, CDGNode* nodeList, CDGNode* result) {
+  assert(NULL != rec);
+  CDGNode* node;
+  int size = 0;
+  pthread_mutex_lock(&rec->lock);
+  wireWriteVarint(rec->buf, CDG_TRACE_FEASIBLE);
+  encodeTracePath(rec, path);
+  for ( node = nodeList; node; node = getNextNode(node) ) size++;
+  wireWriteVarint(rec->buf, size);
+  for ( node = nodeList; node; node = getNextNode(node) ) wireWriteVarint(rec->buf, zigzag(getID(node)));
+  wireWriteVarint(rec->buf, getPathFingerprint(result));
+  writeRecord(rec);
+  pthread_mutex_unlock(&rec->lock);
+}
+
+/* Path lists are mostly deleted soon after they are handed out, so the search starts from
+   the most recent one */
+
+void traceDeletePaths(CDGTraceRecorder* rec, CDGPath* paths) {
+  assert(NULL != rec);
+  int i;
+  pthread_mutex_lock(&rec->lock);
+  for ( i = rec->pathCnt - 1; i >= 0 && paths != rec->paths[i].ptr; i-- );
+  if ( 0 <= i ) {
+    wireWriteVarint(rec->buf, CDG_TRACE_DELETE);
+    wireWriteVarint(rec->buf, rec->paths[i].handle);
+    writeRecord(rec);
+    rec->paths[i] = rec->paths[--rec->pathCnt];
+  }
+  pthread_mutex_unlock(&rec->lock);
+}
+
+void deleteTraceRecorder(CDGTraceRecorder* rec) {
+  assert(NULL != rec);
+  if ( rec == traceRecorder ) traceRecorder = NULL;
+  fflush(rec->out);
+  deleteWireBuffer(rec->buf);
+  free(rec->roots);
+  free(rec->paths);
+  pthread_mutex_destroy(&rec->lock);
+  free(rec);
+}
+
+CDGTraceStats* newTraceStats() {
+  CDGTraceStats* stats;
+  stats = (CDGTraceStats*)calloc(1, sizeof(CDGTraceStats));
+  assert(NULL != stats);
+  return stats;
+}
+
+double traceNow() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+void addTraceLatency(CDGTraceStats* stats, int op, double seconds) {
+  if ( stats->counts[op] == stats->capacities[op] ) {
+    stats->capacities[op] = 0 == stats->capacities[op] ? 256 : 2 * stats->capacities[op];
+    stats->latencies[op] = (double*)realloc(stats->latencies[op], sizeof(double) * stats->capacities[op]);
+    assert(NULL != stats->latencies[op]);
+  }
+  stats->latencies[op][stats->counts[op]++] = seconds;
+}
+
+int compareLatencies(const void* a, const void* b) {
+  double x = *(const double*)a;
+  double y = *(const double*)b;
+  return (x > y) - (x < y);
+}
+
+CDGNode* decodeTraceNodes(CDGWireReader* reader, CDGNode* parent, int* remaining, int* ok) {
+  CDGNode* head = NULL;
+  CDGNode* last = NULL;
+  CDGNode* node;
+  unsigned long long key, score, flags;
+  const char* expr;
+  do {
+    expr = NULL;
+    if ( 0 == *remaining || !wireReadVarint(reader, &key) || !wireReadVarint(reader, &score)
+         || !wireReadVarint(reader, &flags) || ((key & TRACE_HAS_EXPR) && !wireReadString(reader, &expr)) ) {
+      *ok = 0;
+      return head;
+    }
+    (*remaining)--;
+    node = newNode(unzigzag(key >> 5), unzigzag(score), 0 != (key & TRACE_OUTCOME), expr, NULL, NULL, parent, NULL);
+    setFlags(node, (int)flags);
+    if ( NULL == head ) {
+      head = node;
+    } else {
+      setNextNode(last, node);
+    }
+    last = node;
+    if ( key & TRACE_HAS_TRUE ) {
+      setTrueNodeSet(node, decodeTraceNodes(reader, node, remaining, ok));
+      if ( !*ok ) return head;
+    }
+    if ( key & TRACE_HAS_FALSE ) {
+      setFalseNodeSet(node, decodeTraceNodes(reader, node, remaining, ok));
+      if ( !*ok ) return head;
+    }
+  } while ( key & TRACE_HAS_NEXT );
+  return head;
+}
+
+/* Decodes a node count and that many nodes. Returns 0 on malformed input */
+
+int decodeTraceTree(CDGWireReader* reader, CDGNode** tree) {
+  int remaining, ok = 1;
+  *tree = NULL;
+  if ( !wireReadCount(reader, &remaining) ) return 0;
+  if ( 0 == remaining ) return 1;
+  *tree = decodeTraceNodes(reader, NULL, &remaining, &ok);
+  if ( ok && 0 == remaining ) return 1;
+  deleteCDG(*tree);
+  *tree = NULL;
+  return 0;
+}
+
+/* Replay state: decoded roots and live path lists, both indexed by handle - 1 */
+
+typedef struct TraceReplay {
+  CDGNode** roots;
+  int rootCnt;
+  CDGPath** paths;
+  int pathCnt;
+  CDGNode** nodes;
+  int nodeCapacity;
+} TraceReplay;
+
+CDGNode** getReplayNodes(TraceReplay* replay, int size) {
+  if ( size <= replay->nodeCapacity ) return replay->nodes;
+  replay->nodes = (CDGNode**)realloc(replay->nodes, sizeof(CDGNode*) * size);
+  assert(NULL != replay->nodes);
+  for ( ; replay->nodeCapacity < size; replay->nodeCapacity++ ) {
+    replay->nodes[replay->nodeCapacity] = newBlankNode();
+  }
+  return replay->nodes;
+}
+
+/* Reads a handle between 1 and count, returned as an index. Returns -1 on malformed input */
+
+int readTraceHandle(CDGWireReader* reader, int count) {
+  unsigned long long handle;
+  if ( !wireReadVarint(reader, &handle) || 0 == handle || handle > (unsigned long long)count ) return -1;
+  return (int)handle - 1;
+}
+
+int replayBuild(CDGWireReader* reader, TraceReplay* replay) {
+  unsigned long long handle;
+  CDGNode* root;
+  if ( !wireReadVarint(reader, &handle) || 0 == handle || handle > (unsigned long long)replay->rootCnt + 1 ) return 0;
+  if ( !decodeTraceTree(reader, &root) || NULL == root ) return 0;
+  if ( handle > (unsigned long long)replay->rootCnt ) {
+    replay->roots = (CDGNode**)realloc(replay->roots, sizeof(CDGNode*) * handle);
+    assert(NULL != replay->roots);
+    replay->rootCnt++;
+  } else {
+    deleteCDG(replay->roots[handle - 1]);
+  }
+  replay->roots[handle - 1] = root;
+  return 1;
+}
+
+int replayCover(CDGWireReader* reader, TraceReplay* replay, CDGTraceStats* stats) {
+  unsigned long long value;
+  int root = readTraceHandle(reader, replay->rootCnt);
+  int size, i;
+  if ( 0 > root || !wireReadCount(reader, &size) ) return 0;
+  CDGNode** nodes = getReplayNodes(replay, size);
+  for ( i = 0; i < size; i++ ) {
+    if ( !wireReadVarint(reader, &value) ) return 0;
+    setID(nodes[i], unzigzag(value >> 1));
+    setOutcome(nodes[i], (int)(value & 1));
+  }
+  double start = traceNow();
+  coverNodes(replay->roots[root], nodes, size);
+  addTraceLatency(stats, CDG_TRACE_COVER, traceNow() - start);
+  return 1;
+}
+
+int replayTopPaths(CDGWireReader* reader, TraceReplay* replay, CDGTraceStats* stats) {
+  unsigned long long numberOfPaths, handle, fingerprint;
+  int root = readTraceHandle(reader, replay->rootCnt);
+  if ( 0 > root || !wireReadVarint(reader, &numberOfPaths) || !wireReadVarint(reader, &handle)
+       || !wireReadVarint(reader, &fingerprint) ) return 0;
+  if ( 0 != handle && handle != (unsigned long long)replay->pathCnt + 1 ) return 0;
+  double start = traceNow();
+  CDGPath* paths = getTopPaths(replay->roots[root], (int)numberOfPaths);
+  addTraceLatency(stats, CDG_TRACE_TOP_PATHS, traceNow() - start);
+  if ( fingerprint != getPathListFingerprint(paths) || (0 == handle) != (NULL == paths) ) stats->divergences++;
+  if ( 0 == handle ) {
+    if ( NULL != paths ) deletePaths(paths);
+    return 1;
+  }
+  replay->paths = (CDGPath**)realloc(replay->paths, sizeof(CDGPath*) * handle);
+  assert(NULL != replay->paths);
+  replay->paths[replay->pathCnt++] = paths;
+  return 1;
+}
+
+/* Decodes a count and that many ids into a node list. Returns 0 on malformed input */
+
+int decodeTraceIds(CDGWireReader* reader, CDGNode** list) {
+  unsigned long long value;
+  CDGNode* node;
+  int size, i;
+  *list = NULL;
+  if ( !wireReadCount(reader, &size) ) return 0;
+  for ( i = 0; i < size; i++ ) {
+    if ( !wireReadVarint(reader, &value) ) return 0;
+    node = newBlankNode();
+    setID(node, unzigzag(value));
+    setNextNode(node, *list);
+    *list = node;
+  }
+  return 1;
+}
+
+/* Reads a path written by encodeTracePath. Sets owned if the path was decoded and has to be
+   deleted. Returns 0 on malformed input */
+
+int decodeTracePath(CDGWireReader* reader, TraceReplay* replay, CDGNode** path, int* owned) {
+  unsigned long long handle, index;
+  CDGPath* paths;
+  *path = NULL;
+  *owned = 0;
+  if ( !wireReadVarint(reader, &handle) ) return 0;
+  if ( 0 == handle ) {
+    *owned = 1;
+    return decodeTraceTree(reader, path);
+  }
+  if ( handle > (unsigned long long)replay->pathCnt || !wireReadVarint(reader, &index) ) return 0;
+  for ( paths = replay->paths[handle - 1]; paths && 0 < index; paths = getNextPath(paths) ) index--;
+  if ( NULL == paths ) return 0;
+  *path = getPathNode(paths);
+  return 1;
+}
+
+int replayFeasible(CDGWireReader* reader, TraceReplay* replay, CDGTraceStats* stats) {
+  unsigned long long fingerprint;
+  CDGNode* path;
+  CDGNode* list;
+  CDGNode* result;
+  double start;
+  int owned;
+  if ( !decodeTracePath(reader, replay, &path, &owned) ) return 0;
+  int ok = decodeTraceIds(reader, &list) && wireReadVarint(reader, &fingerprint);
+  if ( ok ) {
+    start = traceNow();
+    result = getFeasiblePath(path, list);
+    addTraceLatency(stats, CDG_TRACE_FEASIBLE, traceNow() - start);
+    if ( fingerprint != getPathFingerprint(result) ) stats->divergences++;
+    deleteCDG(result);
+  }
+  deleteCDG(list);
+  if ( owned ) deleteCDG(path);
+  return ok;
+}
+
+int replayDelete(CDGWireReader* reader, TraceReplay* replay, CDGTraceStats* stats) {
+  int handle = readTraceHandle(reader, replay->pathCnt);
+  if ( 0 > handle || NULL == replay->paths[handle] ) return 0;
+  double start = traceNow();
+  deletePaths(replay->paths[handle]);
+  addTraceLatency(stats, CDG_TRACE_DELETE, traceNow() - start);
+  replay->paths[handle] = NULL;
+  return 1;
+}
+
+int replayTrace(const void* data, size_t size, CDGTraceStats* stats) {
+  assert(NULL != stats);
+  assert(NULL == getTraceRecorder());
+  CDGWireReader reader;
+  TraceReplay replay = { NULL, 0, NULL, 0, NULL, 0 };
+  unsigned long long value;
+  int ok, i;
+  initWireReader(&reader, data, size);
+  ok = 4 <= size && 0 == memcmp(data, "CDGT", 4);
+  reader.pos = 4;
+  ok = ok && wireReadVarint(&reader, &value) && CDG_TRACE_VERSION == value;
+  while ( ok && reader.pos < reader.size ) {
+    if ( !wireReadVarint(&reader, &value) ) {
+      ok = 0;
+    } else if ( CDG_TRACE_BUILD == value ) {
+      ok = replayBuild(&reader, &replay);
+    } else if ( CDG_TRACE_COVER == value ) {
+      ok = replayCover(&reader, &replay, stats);
+    } else if ( CDG_TRACE_TOP_PATHS == value ) {
+      ok = replayTopPaths(&reader, &replay, stats);
+    } else if ( CDG_TRACE_FEASIBLE == value ) {
+      ok = replayFeasible(&reader, &replay, stats);
+    } else if ( CDG_TRACE_DELETE == value ) {
+      ok = replayDelete(&reader, &replay, stats);
+    } else {
+      ok = 0;
+    }
+  }
+  for ( i = 0; i < replay.pathCnt; i++ ) {
+    if ( NULL != replay.paths[i] ) deletePaths(replay.paths[i]);
+  }
+  for ( i = 0; i < replay.rootCnt; i++ ) deleteCDG(replay.roots[i]);
+  for ( i = 0; i < replay.nodeCapacity; i++ ) deleteNode(replay.nodes[i]);
+  free(replay.paths);
+  free(replay.roots);
+  free(replay.nodes);
+  for ( i = 0; i < CDG_TRACE_OPS; i++ ) {
+    if ( 0 < stats->counts[i] ) qsort(stats->latencies[i], stats->counts[i], sizeof(double), compareLatencies);
+  }
+  return ok;
+}
+
+double getTraceLatency(CDGTraceStats* stats, int op, double percentile) {
+  assert(NULL != stats);
+  assert(0 <= op && op < CDG_TRACE_OPS);
+  if ( 0 == stats->counts[op] ) return 0;
+  int i = (int)(percentile / 100 * (stats->counts[op] - 1) + 0.5);
+  if ( i < 0 ) i = 0;
+  if ( i >= stats->counts[op] ) i = stats->counts[op] - 1;
+  return stats->latencies[op][i];
+}
+
+double getTraceSeconds(CDGTraceStats* stats, int op) {
+  assert(NULL != stats);
+  assert(0 <= op && op < CDG_TRACE_OPS);
+  double seconds = 0;
+  int i;
+  for ( i = 0; i < stats->counts[op]; i++ ) seconds += stats->latencies[op][i];
+  return seconds;
+}
+
+void deleteTraceStats(CDGTraceStats* stats) {
+  assert(NULL != stats);
+  int i;
+  for ( i = 0; i < CDG_TRACE_OPS; i++ ) free(stats->latencies[i]);
+  free(stats);
+}
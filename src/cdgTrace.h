@@ -0,0 +1,194 @@
+#ifndef CDG_TRACE_H
+#define CDG_TRACE_H
+
+#include <stdio.h>
+#include <pthread.h>
+#include "cdg.h"
+#include "cdgWire.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Workload traces
+ *
+ * While a recorder is active (see setTraceRecorder) coverNodes, coverNodesWithChanges,
+ * getTopPaths, getFeasiblePath and deletePaths append a record of each call to a binary
+ * trace, and replayTrace re-executes a trace timing every call. The trace is "CDGT", the
+ * version and a sequence of records, all numbers varints (see cdgWire.h):
+ *   build     op, root handle, node count, nodes
+ *   cover     op, root handle, count, zigzag(id) << 1 | outcome for each node
+ *   topPaths  op, root handle, numberOfPaths, paths handle (0 for none), fingerprint
+ *   feasible  op, path, count, zigzag(id) for each node, fingerprint
+ *   delete    op, paths handle
+ * Nodes are in the order of findNode, each a key, zigzag(score), flags and the expr if any:
+ *   key = zigzag(id) << 5 | hasExpr << 4 | outcome << 3 | hasTrue << 2 | hasFalse << 1 | hasNext
+ * A path is the handle of the live path list holding it and its index in the list, or if no
+ * live list holds it, 0 followed by its node count and nodes.
+ * Roots and path lists get handles in the order they are first seen, from 1. A root is
+ * recorded by a build record the first time a call uses it, with its current scores, and
+ * again under the same handle whenever the structure of a CDG handle changes (see
+ * cdgAddTrueNode, cdgAddFalseNode and cdgRemoveNode). deleteCDG forgets a root, so that a
+ * new CDG allocated at the same address gets a handle of its own.
+ * Fingerprints are those of the results (see getPathFingerprint), so that a replay can
+ * report calls whose results differ from the recorded ones. Hit scoring and infeasible
+ * cores are not recorded and should be off while recording */
+
+#define CDG_TRACE_VERSION 1
+
+#define CDG_TRACE_BUILD 0
+#define CDG_TRACE_COVER 1
+#define CDG_TRACE_TOP_PATHS 2
+#define CDG_TRACE_FEASIBLE 3
+#define CDG_TRACE_DELETE 4
+#define CDG_TRACE_OPS 5
+
+/* CDGTraceHandle - Handle of a root or a path list of a trace
+ * @ptr - The root or path list
+ * @handle - Its handle */
+
+typedef struct CDGTraceHandle {
+  void* ptr;
+  unsigned long handle;
+} CDGTraceHandle;
+
+/* CDGTraceRecorder - Appends records to a trace file. Thread safe
+ * @out - File the trace is written to
+ * @buf - Record being encoded
+ * @roots - Roots recorded so far
+ * @rootCnt - Number of roots
+ * @paths - Path lists handed out and not deleted yet, most recent last
+ * @pathCnt - Number of path lists
+ * @pathCapacity - Allocated size of paths
+ * @nextPaths - Handle of the next path list
+ * @records - Number of records written
+ * @lock - Serializes the records */
+
+typedef struct CDGTraceRecorder {
+  FILE* out;
+  CDGWireBuffer* buf;
+  CDGTraceHandle* roots;
+  int rootCnt;
+  CDGTraceHandle* paths;
+  int pathCnt;
+  int pathCapacity;
+  unsigned long nextPaths;
+  unsigned long records;
+  pthread_mutex_t lock;
+} CDGTraceRecorder;
+
+/* CDGTraceStats - Latencies of the calls of a replayed trace
+ * @latencies - Latency of each call in seconds, per op. Sorted once the replay is done
+ * @counts - Number of calls, per op
+ * @capacities - Allocated size of latencies, per op
+ * @divergences - Number of calls whose results differ from the recorded ones */
+
+typedef struct CDGTraceStats {
+  double* latencies[CDG_TRACE_OPS];
+  int counts[CDG_TRACE_OPS];
+  int capacities[CDG_TRACE_OPS];
+  int divergences;
+} CDGTraceStats;
+
+/* newTraceRecorder - Creates a recorder writing the trace header to a file and returns it.
+ *                    The file stays owned by the caller
+ * @out - File opened for binary writing */
+
+CDGTraceRecorder* newTraceRecorder(FILE* out);
+
+/* setTraceRecorder - Activates a recorder. With NULL (the default) nothing is recorded
+ * @rec - a recorder, or NULL */
+
+void setTraceRecorder(CDGTraceRecorder* rec);
+
+/* getTraceRecorder - Returns the active recorder, NULL if none */
+
+CDGTraceRecorder* getTraceRecorder();
+
+/* traceBuild - Records a snapshot of a CDG, to be used by the calls that follow on its root.
+ *              Called by the other trace functions for a root they have not seen. To be
+ *              called again after changing the structure of the CDG outside of a handle
+ * @rec - a recorder
+ * @root - CDG root node */
+
+void traceBuild(CDGTraceRecorder* rec, CDGNode* root);
+
+/* traceDeleteCDG - Forgets a root, called by deleteCDG. Writes no record
+ * @rec - a recorder
+ * @root - CDG root node */
+
+void traceDeleteCDG(CDGTraceRecorder* rec, CDGNode* root);
+
+/* traceCoverNodes - Records a coverNodes call, before it is made
+ * @rec - a recorder
+ * @root - CDG root node
+ * @nodes - Array of CDGNodes. Will have id and outcome set
+ * @size - Size of array */
+
+void traceCoverNodes(CDGTraceRecorder* rec, CDGNode* root, CDGNode* nodes[], int size);
+
+/* traceTopPaths - Records a getTopPaths call along with its result
+ * @rec - a recorder
+ * @root - CDG root node
+ * @numberOfPaths - Number of paths requested
+ * @paths - The paths returned. May be NULL */
+
+void traceTopPaths(CDGTraceRecorder* rec, CDGNode* root, int numberOfPaths, CDGPath* paths);
+
+/* traceFeasiblePath - Records a getFeasiblePath call along with its result
+ * @rec - a recorder
+ * @path - Path from which the conditions were extracted
+ * @nodeList - List of nodes which were satfisfied
+ * @result - The feasible path returned. May be NULL */
+
+void traceFeasiblePath(CDGTraceRecorder* rec, CDGNode* path, CDGNode* nodeList, CDGNode* result);
+
+/* traceDeletePaths - Records a deletePaths call, if the paths were recorded by traceTopPaths
+ * @rec - a recorder
+ * @paths - a path head */
+
+void traceDeletePaths(CDGTraceRecorder* rec, CDGPath* paths);
+
+/* deleteTraceRecorder - Flushes the trace and deallocates a recorder, deactivating it if
+ *                       it is active. Does not close the file
+ * @rec - a recorder */
+
+void deleteTraceRecorder(CDGTraceRecorder* rec);
+
+/* newTraceStats - Creates and returns empty stats */
+
+CDGTraceStats* newTraceStats();
+
+/* replayTrace - Re-executes the calls of a trace, adding their latencies to the stats.
+ *               Returns 1 on success and 0 on a malformed trace, with the calls before the
+ *               malformed record replayed
+ * @data - The trace bytes
+ * @size - Number of trace bytes
+ * @stats - Stats to add to */
+
+int replayTrace(const void* data, size_t size, CDGTraceStats* stats);
+
+/* getTraceLatency - Returns a latency percentile of the calls of an op in seconds, 0 if
+ *                   there were none
+ * @stats - Stats of a replay
+ * @op - a CDG_TRACE_ op
+ * @percentile - Percentile, 0 to 100 */
+
+double getTraceLatency(CDGTraceStats* stats, int op, double percentile);
+
+/* getTraceSeconds - Returns the total latency of the calls of an op in seconds
+ * @stats - Stats of a replay
+ * @op - a CDG_TRACE_ op */
+
+double getTraceSeconds(CDGTraceStats* stats, int op);
+
+/* deleteTraceStats - Deallocates stats
+ * @stats - Stats of a replay */
+
+void deleteTraceStats(CDGTraceStats* stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,286 @@
+#include <limits.h>
+#include "cdgWire.h"
+
+#define INITIAL_INTERN_SLOTS 64
+#define INITIAL_WIRE_CAPACITY 256
+
+#define WIRE_OUTCOME 8
+#define WIRE_HAS_TRUE 4
+#define WIRE_HAS_FALSE 2
+#define WIRE_HAS_NEXT 1
+
+unsigned int hashString(const char* str) {
+  unsigned int hash = 2166136261u;
+  while ( *str ) {
+    hash ^= (unsigned char)*str++;
+    hash *= 16777619u;
+  }
+  return hash;
+}
+
+CDGInternTable* newInternTable() {
+  CDGInternTable* table;
+  table = (CDGInternTable*)malloc(sizeof(CDGInternTable));
+  assert(NULL != table);
+  table->size = 0;
+  table->capacity = INITIAL_INTERN_SLOTS / 2;
+  table->strings = (char**)malloc(sizeof(char*) * table->capacity);
+  table->slotCnt = INITIAL_INTERN_SLOTS;
+  table->slots = (int*)calloc(table->slotCnt, sizeof(int));
+  assert(NULL != table->strings && NULL != table->slots);
+  return table;
+}
+
+int* findInternSlot(CDGInternTable* table, const char* str) {
+  unsigned int i = hashString(str) & (table->slotCnt - 1);
+  while ( 0 != table->slots[i] && 0 != strcmp(table->strings[table->slots[i] - 1], str) ) {
+    i = (i + 1) & (table->slotCnt - 1);
+  }
+  return &table->slots[i];
+}
+
+void growInternTable(CDGInternTable* table) {
+  int i;
+  free(table->slots);
+  table->slotCnt *= 2;
+  table->slots = (int*)calloc(table->slotCnt, sizeof(int));
+  assert(NULL != table->slots);
+  for ( i = 0; i < table->size; i++ ) {
+    *findInternSlot(table, table->strings[i]) = i + 1;
+  }
+  table->capacity = table->slotCnt / 2;
+  table->strings = (char**)realloc(table->strings, sizeof(char*) * table->capacity);
+  assert(NULL != table->strings);
+}
+
+int internString(CDGInternTable* table, const char* str) {
+  assert(NULL != table);
+  if ( NULL == str ) return 0;
+  int* slot = findInternSlot(table, str);
+  if ( 0 != *slot ) return *slot;
+  if ( table->size == table->capacity ) {
+    growInternTable(table);
+    slot = findInternSlot(table, str);
+  }
+  char* copy = (char*)malloc(sizeof(char)*(strlen(str)+1));
+  assert(NULL != copy);
+  strcpy(copy, str);
+  table->strings[table->size++] = copy;
+  *slot = table->size;
+  return *slot;
+}
+
+const char* getInternedString(CDGInternTable* table, int handle) {
+  assert(NULL != table);
+  assert(0 <= handle && handle <= table->size);
+  if ( 0 == handle ) return NULL;
+  return table->strings[handle - 1];
+}
+
+void deleteInternTable(CDGInternTable* table) {
+  assert(NULL != table);
+  int i;
+  for ( i = 0; i < table->size; i++ ) {
+    free(table->strings[i]);
+  }
+  free(table->strings);
+  free(table->slots);
+  free(table);
+}
+
+CDGWireBuffer* newWireBuffer() {
+  CDGWireBuffer* buf;
+  buf = (CDGWireBuffer*)malloc(sizeof(CDGWireBuffer));
+  assert(NULL != buf);
+  buf->size = 0;
+  buf->capacity = INITIAL_WIRE_CAPACITY;
+  buf->data = (unsigned char*)malloc(buf->capacity);
+  assert(NULL != buf->data);
+  return buf;
+}
+
+CDGWireBuffer* clearWireBuffer(CDGWireBuffer* buf) {
+  assert(NULL != buf);
+  buf->size = 0;
+  return buf;
+}
+
+void deleteWireBuffer(CDGWireBuffer* buf) {
+  assert(NULL != buf);
+  free(buf->data);
+  free(buf);
+}
+
+void reserveWireBuffer(CDGWireBuffer* buf, size_t size) {
+  if ( buf->size + size <= buf->capacity ) return;
+  while ( buf->size + size > buf->capacity ) buf->capacity *= 2;
+  buf->data = (unsigned char*)realloc(buf->data, buf->capacity);
+  assert(NULL != buf->data);
+}
+
+void wireWriteVarint(CDGWireBuffer* buf, unsigned long long value) {
+  reserveWireBuffer(buf, 10);
+  while ( value >= 0x80 ) {
+    buf->data[buf->size++] = (unsigned char)(value | 0x80);
+    value >>= 7;
+  }
+  buf->data[buf->size++] = (unsigned char)value;
+}
+
+void wireWriteString(CDGWireBuffer* buf, const char* str) {
+  size_t len = strlen(str) + 1;
+  wireWriteVarint(buf, len);
+  reserveWireBuffer(buf, len);
+  memcpy(buf->data + buf->size, str, len);
+  buf->size += len;
+}
+
+unsigned long long zigzag(int value) {
+  return ((unsigned long long)(long long)value << 1) ^ (unsigned long long)((long long)value >> 63);
+}
+
+int unzigzag(unsigned long long value) {
+  return (int)((long long)(value >> 1) ^ -(long long)(value & 1));
+}
+
+void encodeNodeList(CDGWireBuffer* buf, CDGInternTable* table, CDGNode* node) {
+  unsigned long long key;
+  while ( node ) {
+    key = zigzag(getID(node)) << 4;
+    if ( getOutcome(node) ) key |= WIRE_OUTCOME;
+    if ( getTrueNodeSet(node) ) key |= WIRE_HAS_TRUE;
+    if ( getFalseNodeSet(node) ) key |= WIRE_HAS_FALSE;
+    if ( getNextNode(node) ) key |= WIRE_HAS_NEXT;
+    wireWriteVarint(buf, key);
+    wireWriteVarint(buf, internString(table, getExpr(node)));
+    encodeNodeList(buf, table, getTrueNodeSet(node));
+    encodeNodeList(buf, table, getFalseNodeSet(node));
+    node = getNextNode(node);
+  }
+}
+
+void encodePath(CDGWireBuffer* buf, CDGInternTable* table, CDGNode* path) {
+  assert(NULL != buf);
+  assert(NULL != table);
+  wireWriteVarint(buf, getPathLength(path));
+  encodeNodeList(buf, table, path);
+}
+
+void encodePathList(CDGWireBuffer* buf, CDGInternTable* table, CDGPath* path) {
+  assert(NULL != buf);
+  int count = 0;
+  CDGPath* temp;
+  for ( temp = path; temp; temp = getNextPath(temp) ) count++;
+  wireWriteVarint(buf, count);
+  for ( temp = path; temp; temp = getNextPath(temp) ) {
+    encodePath(buf, table, getPathNode(temp));
+  }
+}
+
+void encodeInternTable(CDGWireBuffer* buf, CDGInternTable* table) {
+  assert(NULL != buf);
+  assert(NULL != table);
+  int i;
+  wireWriteVarint(buf, table->size);
+  for ( i = 0; i < table->size; i++ ) {
+    wireWriteString(buf, table->strings[i]);
+  }
+}
+
+CDGWireReader* initWireReader(CDGWireReader* reader, const void* data, size_t size) {
+  assert(NULL != reader);
+  reader->data = (const unsigned char*)data;
+  reader->size = size;
+  reader->pos = 0;
+  return reader;
+}
+
+int wireReadVarint(CDGWireReader* reader, unsigned long long* value) {
+  unsigned long long out = 0;
+  int shift = 0;
+  unsigned char byte;
+  do {
+    if ( reader->pos >= reader->size || 63 < shift ) return 0;
+    byte = reader->data[reader->pos++];
+    out |= (unsigned long long)(byte & 0x7f) << shift;
+    shift += 7;
+  } while ( byte & 0x80 );
+  *value = out;
+  return 1;
+}
+
+int wireReadCount(CDGWireReader* reader, int* count) {
+  unsigned long long value;
+  if ( !wireReadVarint(reader, &value) || value > reader->size - reader->pos ) return 0;
+  *count = (int)value;
+  return 1;
+}
+
+int wireReadNode(CDGWireReader* reader, CDGWireNode* node) {
+  unsigned long long key, handle;
+  if ( !wireReadVarint(reader, &key) || !wireReadVarint(reader, &handle) ) return 0;
+  if ( handle > INT_MAX ) return 0;
+  node->id = unzigzag(key >> 4);
+  node->outcome = 0 != (key & WIRE_OUTCOME);
+  node->hasTrue = 0 != (key & WIRE_HAS_TRUE);
+  node->hasFalse = 0 != (key & WIRE_HAS_FALSE);
+  node->hasNext = 0 != (key & WIRE_HAS_NEXT);
+  node->exprHandle = (int)handle;
+  return 1;
+}
+
+int wireReadString(CDGWireReader* reader, const char** str) {
+  unsigned long long len;
+  if ( !wireReadVarint(reader, &len) || 0 == len || len > reader->size - reader->pos ) return 0;
+  if ( '\0' != reader->data[reader->pos + len - 1] ) return 0;
+  *str = (const char*)(reader->data + reader->pos);
+  reader->pos += len;
+  return 1;
+}
+
+CDGNode* decodeNodeList(CDGWireReader* reader, const char* strings[], int stringCnt, int* remaining,
+                        int* ok) {
+  CDGNode* head = NULL;
+  CDGNode* last = NULL;
+  CDGNode* node;
+  CDGWireNode wireNode;
+  do {
+    if ( 0 == *remaining || !wireReadNode(reader, &wireNode)
+         || (NULL != strings && wireNode.exprHandle > stringCnt) ) {
+      *ok = 0;
+      return head;
+    }
+    (*remaining)--;
+    node = newNode(wireNode.id, 1, wireNode.outcome,
+                   (NULL != strings && 0 < wireNode.exprHandle) ? strings[wireNode.exprHandle - 1] : NULL,
+                   NULL, NULL, NULL, NULL);
+    if ( NULL == head ) {
+      head = node;
+    } else {
+      setNextNode(last, node);
+    }
+    last = node;
+    if ( wireNode.hasTrue ) {
+      setTrueNodeSet(node, decodeNodeList(reader, strings, stringCnt, remaining, ok));
+      if ( !*ok ) return head;
+    }
+    if ( wireNode.hasFalse ) {
+      setFalseNodeSet(node, decodeNodeList(reader, strings, stringCnt, remaining, ok));
+      if ( !*ok ) return head;
+    }
+  } while ( wireNode.hasNext );
+  return head;
+}
+
+CDGNode* decodePath(CDGWireReader* reader, const char* strings[], int stringCnt) {
+  assert(NULL != reader);
+  assert(0 <= stringCnt);
+  int remaining, ok = 1;
+  if ( !wireReadCount(reader, &remaining) || 0 == remaining ) return NULL;
+  CDGNode* path = decodeNodeList(reader, strings, stringCnt, &remaining, &ok);
+  if ( !ok || 0 != remaining ) {
+    deleteCDG(path);
+    return NULL;
+  }
+  return path;
+}
@@ -0,0 +1,200 @@
+#ifndef CDG_WIRE_H
+#define CDG_WIRE_H
+
+#include "cdg.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Compact binary encoding of paths and path lists
+ *
+ * Numbers are unsigned LEB128 varints. A path is its number of nodes followed by the
+ * nodes in the order printPath visits them. Each node is a key and a predicate handle:
+ *   key = zigzag(id) << 4 | outcome << 3 | hasTrue << 2 | hasFalse << 1 | hasNext
+ *   predicate handle = index + 1 into the intern table, 0 for no predicate
+ * A path list is the number of paths followed by the paths. An intern table is the
+ * number of strings followed by, for each, its length and its bytes including the
+ * terminating '\0', so that readers can use the strings in place */
+
+/* CDGInternTable - Distinct predicates referred to by encoded paths
+ * @strings - Interned strings, indexed by handle - 1
+ * @size - Number of strings
+ * @capacity - Allocated size of strings
+ * @slots - Open addressing hash table of handles, 0 for an empty slot
+ * @slotCnt - Number of slots, a power of 2 */
+
+typedef struct CDGInternTable {
+  char** strings;
+  int size;
+  int capacity;
+  int* slots;
+  int slotCnt;
+} CDGInternTable;
+
+/* CDGWireBuffer - Growable byte buffer the encoder appends to
+ * @data - Encoded bytes
+ * @size - Number of encoded bytes
+ * @capacity - Allocated size of data */
+
+typedef struct CDGWireBuffer {
+  unsigned char* data;
+  size_t size;
+  size_t capacity;
+} CDGWireBuffer;
+
+/* CDGWireReader - Cursor over encoded bytes. The reader never copies the bytes
+ * @data - Encoded bytes
+ * @size - Number of encoded bytes
+ * @pos - Offset of the next byte to read */
+
+typedef struct CDGWireReader {
+  const unsigned char* data;
+  size_t size;
+  size_t pos;
+} CDGWireReader;
+
+/* CDGWireNode - A decoded path node
+ * @id - Id of the node
+ * @outcome - Outcome of the node
+ * @exprHandle - Predicate handle, 0 if the node has no predicate
+ * @hasTrue - 1 if the trueNodeSet of the node follows
+ * @hasFalse - 1 if the falseNodeSet of the node follows (after the trueNodeSet)
+ * @hasNext - 1 if the next node follows (after the trueNodeSet and falseNodeSet) */
+
+typedef struct CDGWireNode {
+  int id;
+  int outcome;
+  int exprHandle;
+  int hasTrue;
+  int hasFalse;
+  int hasNext;
+} CDGWireNode;
+
+/* newInternTable - Creates and returns an empty intern table */
+
+CDGInternTable* newInternTable();
+
+/* internString - Returns the handle of a string, adding it to the table if not present.
+ *                Returns 0 for NULL
+ * @table - an intern table
+ * @str - String to intern */
+
+int internString(CDGInternTable* table, const char* str);
+
+/* getInternedString - Returns the string of a handle, NULL for handle 0
+ * @table - an intern table
+ * @handle - a handle returned by internString */
+
+const char* getInternedString(CDGInternTable* table, int handle);
+
+/* deleteInternTable - Deallocates an intern table and its strings
+ * @table - an intern table */
+
+void deleteInternTable(CDGInternTable* table);
+
+/* newWireBuffer - Creates and returns an empty buffer */
+
+CDGWireBuffer* newWireBuffer();
+
+/* clearWireBuffer - Empties a buffer keeping its memory for reuse and returns it
+ * @buf - a buffer */
+
+CDGWireBuffer* clearWireBuffer(CDGWireBuffer* buf);
+
+/* deleteWireBuffer - Deallocates a buffer
+ * @buf - a buffer */
+
+void deleteWireBuffer(CDGWireBuffer* buf);
+
+/* wireWriteVarint - Appends a varint to a buffer
+ * @buf - a buffer
+ * @value - Value to append */
+
+void wireWriteVarint(CDGWireBuffer* buf, unsigned long long value);
+
+/* wireWriteString - Appends a string as its length and its bytes including the terminating
+ *                   '\0', the way strings of an intern table are encoded (see wireReadString)
+ * @buf - a buffer
+ * @str - String to append */
+
+void wireWriteString(CDGWireBuffer* buf, const char* str);
+
+/* zigzag - Maps a signed value to an unsigned one, small magnitudes to small values
+ * @value - Value to map */
+
+unsigned long long zigzag(int value);
+
+/* unzigzag - Inverse of zigzag
+ * @value - Mapped value */
+
+int unzigzag(unsigned long long value);
+
+/* encodePath - Appends a path to a buffer, walking the path nodes directly
+ * @buf - a buffer
+ * @table - Table the predicates of the path are interned into
+ * @path - Head of a path, as returned by getTopPaths or getFeasiblePath. May be NULL */
+
+void encodePath(CDGWireBuffer* buf, CDGInternTable* table, CDGNode* path);
+
+/* encodePathList - Appends a path list to a buffer
+ * @buf - a buffer
+ * @table - Table the predicates of the paths are interned into
+ * @path - a path head. May be NULL */
+
+void encodePathList(CDGWireBuffer* buf, CDGInternTable* table, CDGPath* path);
+
+/* encodeInternTable - Appends an intern table to a buffer
+ * @buf - a buffer
+ * @table - an intern table */
+
+void encodeInternTable(CDGWireBuffer* buf, CDGInternTable* table);
+
+/* initWireReader - Points a reader to the start of encoded bytes and returns it
+ * @reader - a reader
+ * @data - Encoded bytes
+ * @size - Number of encoded bytes */
+
+CDGWireReader* initWireReader(CDGWireReader* reader, const void* data, size_t size);
+
+/* wireReadVarint - Reads a varint. Returns 1 on success and 0 on malformed input
+ * @reader - a reader
+ * @value - Address where the value is to be stored */
+
+int wireReadVarint(CDGWireReader* reader, unsigned long long* value);
+
+/* wireReadCount - Reads the number of nodes of a path, paths of a list or strings of a
+ *                 table. Returns 1 on success and 0 on malformed input
+ * @reader - a reader
+ * @count - Address where the count is to be stored */
+
+int wireReadCount(CDGWireReader* reader, int* count);
+
+/* wireReadNode - Reads the next node of a path. Returns 1 on success and 0 on malformed input,
+ *                including a predicate handle that does not fit in an int
+ * @reader - a reader
+ * @node - Address where the node is to be decoded */
+
+int wireReadNode(CDGWireReader* reader, CDGWireNode* node);
+
+/* wireReadString - Reads the next string of an intern table without copying it.
+ *                  Returns 1 on success and 0 on malformed input
+ * @reader - a reader
+ * @str - Address where a pointer to the string inside the encoded bytes is to be stored */
+
+int wireReadString(CDGWireReader* reader, const char** str);
+
+/* decodePath - Reads a path and rebuilds it as path nodes. Returns NULL for an empty or
+ *              malformed path, including one with a predicate handle past the strings
+ * @reader - a reader
+ * @strings - Strings of the intern table, indexed by handle - 1. May be NULL to drop the
+ *            predicates
+ * @stringCnt - Number of strings */
+
+CDGNode* decodePath(CDGWireReader* reader, const char* strings[], int stringCnt);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -5,6 +5,7 @@ Stack* stackNew(int elementSize) {
   s->elementSize = elementSize;
   s->elementsCnt = 0;
   s->head = NULL;
+  return s;
 }
 
 void stackPush(Stack *s, const void *element) {
@@ -5,6 +5,10 @@
 #include <string.h> /* memcpy */
 #include <assert.h>
 
+#ifdef __cplusplus
+extern "C" {
+#endif
+
 typedef struct node{
   void *element;
   struct node *next;  
@@ -62,4 +66,8 @@ int stackSize(Stack *s);
 
 void stackPeek(Stack *s, void *element);
 
+#ifdef __cplusplus
+}
+#endif
+
 #endif
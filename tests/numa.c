@@ -0,0 +1,111 @@
+#define _GNU_SOURCE
+#include <sched.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <pthread.h>
+#include "../src/cdg.h"
+#include "../src/cdgNuma.h"
+
+/* NUMA replication benchmark
+ *
+ * Runs getReplicatedTopPaths from one thread per CPU, each pinned to its CPU, on a random CDG
+ * replicated once (every thread reads the copy of the first NUMA node) and then once per
+ * NUMA node, and prints the query throughput of both. On a single node host, set
+ * CDG_NUMA_NODES to simulate a topology, which measures the overhead of replication rather
+ * than its benefit.
+ *
+ * Usage: ./numa [nodes] [queries per thread] [threads] */
+
+#define NUMA_PATHS 4
+
+typedef struct NumaWorker {
+  CDGReplicatedGraph* graph;
+  int cpu;
+  int queries;
+} NumaWorker;
+
+double now() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+CDGNode* buildNumaCDG(int size, unsigned int seed) {
+  CDGNode** nodes = (CDGNode**)malloc(sizeof(CDGNode*) * size);
+  char expr[32];
+  int i, parent;
+  srand(seed);
+  nodes[0] = newNode(0, 1, 1, "(p 0)", NULL, NULL, NULL, NULL);
+  for ( i = 1; i < size; i++ ) {
+    sprintf(expr, "(p %d)", i % 97);
+    nodes[i] = newNode(i, 1, 1, expr, NULL, NULL, NULL, NULL);
+    parent = rand() % i;
+    if ( 0 == rand() % 40 ) {
+      setNextNode(nodes[i], getNextNode(nodes[0]));
+      setNextNode(nodes[0], nodes[i]);
+    } else if ( rand() % 2 ) {
+      addTrueNode(nodes[parent], nodes[i]);
+    } else {
+      addFalseNode(nodes[parent], nodes[i]);
+    }
+  }
+  CDGNode* out = nodes[0];
+  free(nodes);
+  return updateCDG(out);
+}
+
+void* runNumaWorker(void* arg) {
+  NumaWorker* worker = (NumaWorker*)arg;
+  cpu_set_t cpus;
+  int i;
+  CPU_ZERO(&cpus);
+  CPU_SET(worker->cpu, &cpus);
+  pthread_setaffinity_np(pthread_self(), sizeof(cpu_set_t), &cpus);
+  for ( i = 0; i < worker->queries; i++ ) {
+    CDGPath* paths = getReplicatedTopPaths(worker->graph, NUMA_PATHS);
+    if ( paths ) deletePaths(paths);
+  }
+  return NULL;
+}
+
+double runQueries(CDGReplicatedGraph* graph, int threads, int queries) {
+  NumaWorker* workers = (NumaWorker*)malloc(sizeof(NumaWorker) * threads);
+  pthread_t* ids = (pthread_t*)malloc(sizeof(pthread_t) * threads);
+  int cpus = (int)sysconf(_SC_NPROCESSORS_ONLN);
+  int i;
+  double start = now();
+  for ( i = 0; i < threads; i++ ) {
+    workers[i].graph = graph;
+    workers[i].cpu = i % cpus;
+    workers[i].queries = queries;
+    pthread_create(&ids[i], NULL, runNumaWorker, &workers[i]);
+  }
+  for ( i = 0; i < threads; i++ ) pthread_join(ids[i], NULL);
+  double seconds = now() - start;
+  free(workers);
+  free(ids);
+  return seconds;
+}
+
+int main(int argc, char* argv[]) {
+  int size = argc > 1 ? atoi(argv[1]) : 100000;
+  int queries = argc > 2 ? atoi(argv[2]) : 50;
+  int threads = argc > 3 ? atoi(argv[3]) : (int)sysconf(_SC_NPROCESSORS_ONLN);
+  assert(1 < size && 0 < queries && 0 < threads);
+  CDGNode* root = buildNumaCDG(size, 1);
+  CDGReplicatedGraph* single = newReplicatedGraph(root, 1);
+  CDGReplicatedGraph* replicated = newReplicatedGraph(root, 0);
+  double singleSeconds = runQueries(single, threads, queries);
+  double replicatedSeconds = runQueries(replicated, threads, queries);
+  printf("%d nodes, %d threads, %d queries per thread\n", size, threads, queries);
+  printf("%-12s %10s %12s %10s\n", "structure", "replicas", "queries/s", "speedup");
+  printf("%-12s %10d %12.0f %10s\n", "single", single->replicaCnt, threads * queries / singleSeconds, "1.00");
+  printf("%-12s %10d %12.0f %10.2f\n", "replicated", replicated->replicaCnt,
+         threads * queries / replicatedSeconds, singleSeconds / replicatedSeconds);
+  deleteReplicatedGraph(single);
+  deleteReplicatedGraph(replicated);
+  deleteCDG(root);
+  return 0;
+}
@@ -0,0 +1,563 @@
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include "../src/cdg.h"
+#include "../src/cdgCompact.h"
+#include "../src/cdgLevels.h"
+#include "../src/cdgParallel.h"
+#include "../src/cdgBuffer.h"
+#include "../src/cdgNuma.h"
+
+/* Differential oracle
+ *
+ * Runs random coverage traces on random CDGs through the reference engine (the original
+ * full rescoring implementation, copied below) and through every optimized engine side by
+ * side. After each step the scores and outcomes are compared node by node, then the top
+ * paths and a feasible path of each. Divergences are reported as they are found and a
+ * timing summary is printed at the end. Exits with 1 on any divergence.
+ *
+ * Usage: ./oracle [trials] [nodes] [steps] [seed] */
+
+#define ORACLE_PATHS 4
+#define ORACLE_COVERED 6
+#define ORACLE_BUFFER_NODES 65536
+
+/* Reference engine */
+
+void refPushNodeListToStack(Stack* s, CDGNode* node) {
+  do {
+    stackPush(s, &node);
+    node = getNextNode(node);
+  } while ( node );
+}
+
+void refPostOrder(CDGNode* root, Stack* s) {
+  if ( NULL == root ) return;
+  Stack* temp = stackNew(sizeof(CDGNode*));
+  CDGNode* node;
+  refPushNodeListToStack(temp, root);
+  while ( !stackIsEmpty(temp) ) {
+    stackPop(temp, &node);
+    if ( getTrueNodeSet(node) ) refPushNodeListToStack(temp, getTrueNodeSet(node));
+    if ( getFalseNodeSet(node) ) refPushNodeListToStack(temp, getFalseNodeSet(node));
+    stackPush(s, &node);
+  }
+  stackFree(temp);
+  free(temp);
+}
+
+int refConditionalNodeSum(CDGNode* node) {
+  int sum = 0;
+  while (node != NULL) {
+    if ( !isLeaf(node) ) {
+      sum += getScore(node);
+    }
+    node = getNextNode(node);
+  }
+  return sum;
+}
+
+int refHasUncoveredChild(CDGNode* node, int branch) {
+  CDGNode* temp = branch ? getTrueNodeSet(node) : getFalseNodeSet(node);
+  while (temp) {
+    if (isLeaf(temp) && 0 < getScore(temp)) return 1;
+    temp = getNextNode(temp);
+  }
+  return 0;
+}
+
+int refHasConditionalChild(CDGNode* node) {
+  CDGNode* temp;
+  for ( temp = getTrueNodeSet(node); temp; temp = getNextNode(temp) ) {
+    if (!isLeaf(temp)) return 1;
+  }
+  for ( temp = getFalseNodeSet(node); temp; temp = getNextNode(temp) ) {
+    if (!isLeaf(temp)) return 1;
+  }
+  return 0;
+}
+
+int refIsConditionalLeaf(CDGNode* node) {
+  if (isLeaf(node)) return 0;
+  if (!refHasConditionalChild(node)) return 1;
+  if ( 0 < refConditionalNodeSum(getTrueNodeSet(node))) return 0;
+  if ( 0 < refConditionalNodeSum(getFalseNodeSet(node))) return 0;
+  return 1;
+}
+
+void refUpdateScore(CDGNode* node) {
+  if ( isLeaf(node) ) return;
+  if ( refIsConditionalLeaf(node)) {
+    if ( refHasUncoveredChild(node, 1)) {
+      setScore(node, 1);
+      setOutcome(node, 1);
+    } else if ( refHasUncoveredChild(node, 0)) {
+      setScore(node, 1);
+      setOutcome(node, 0);
+    } else {
+      setScore(node, 0);
+      setOutcome(node, 1);
+    }
+    return;
+  }
+  int trueScore = refConditionalNodeSum(getTrueNodeSet(node));
+  int falseScore = refConditionalNodeSum(getFalseNodeSet(node));
+  if ( trueScore >= falseScore ) {
+    setScore(node, trueScore + 1);
+    setOutcome(node, 1);
+  } else {
+    setScore(node, falseScore + 1);
+    setOutcome(node, 0);
+  }
+}
+
+void refUpdateCDG(CDGNode* root) {
+  Stack* nodeStack = stackNew(sizeof(CDGNode*));
+  CDGNode* node;
+  refPostOrder(root, nodeStack);
+  while ( !stackIsEmpty(nodeStack) ) {
+    stackPop(nodeStack, &node);
+    refUpdateScore(node);
+  }
+  stackFree(nodeStack);
+  free(nodeStack);
+}
+
+void refCoverNodes(CDGNode* root, CDGNode* nodes[], int size) {
+  Stack* nodeStack = stackNew(sizeof(CDGNode*));
+  CDGNode* node;
+  CDGNode* child;
+  int i;
+  refPostOrder(root, nodeStack);
+  while ( !stackIsEmpty(nodeStack) ) {
+    stackPop(nodeStack, &node);
+    for ( i = 0; i < size; i++ ) {
+      if ( getID(node) == getID(nodes[i]) ) {
+        child = getOutcome(nodes[i]) ? getTrueNodeSet(node) : getFalseNodeSet(node);
+        for ( ; child; child = getNextNode(child) ) {
+          if ( isLeaf(child) ) setScore(child, 0);
+        }
+        break;
+      }
+    }
+  }
+  stackFree(nodeStack);
+  free(nodeStack);
+  refUpdateCDG(root);
+}
+
+CDGNode* refGetTopPath(CDGNode* node, Stack* changedNodes) {
+  CDGNode* pathNode = newBlankNode();
+  CDGNode* temp = pathNode;
+  while (node) {
+    if ( 0 != getScore(node) ) {
+      if ( isLeaf(node) ) {
+        setScore(node, 0);
+        stackPush(changedNodes, &node);
+      } else {
+        setNextNode(temp, copyToPathNode(newBlankNode(), node));
+        temp = getNextNode(temp);
+        if (getOutcome(node)) {
+          setTrueNodeSet(temp, refGetTopPath(getTrueNodeSet(node), changedNodes));
+        } else {
+          setFalseNodeSet(temp, refGetTopPath(getFalseNodeSet(node), changedNodes));
+        }
+      }
+    }
+    node = getNextNode(node);
+  }
+  if ( temp == pathNode ) {
+    deleteNode(pathNode);
+    pathNode = NULL;
+  } else {
+    temp = pathNode;
+    pathNode = getNextNode(pathNode);
+    deleteNode(temp);
+  }
+  return pathNode;
+}
+
+int refGetTopPaths(CDGNode* root, int numberOfPaths, CDGNode* heads[]) {
+  int count = 0;
+  CDGNode* path;
+  CDGNode* node;
+  Stack* changedNodes = stackNew(sizeof(CDGNode*));
+  while ( numberOfPaths-- ) {
+    path = refGetTopPath(root, changedNodes);
+    if ( NULL == path ) break;
+    heads[count++] = path;
+    refUpdateCDG(root);
+  }
+  while ( !stackIsEmpty(changedNodes) ) {
+    stackPop(changedNodes, &node);
+    setScore(node, 1);
+  }
+  refUpdateCDG(root);
+  stackFree(changedNodes);
+  free(changedNodes);
+  return count;
+}
+
+CDGNode* refFindNode(CDGNode* node, int id) {
+  if ( NULL == node ) return NULL;
+  if (id == getID(node)) return node;
+  CDGNode* temp = refFindNode(getTrueNodeSet(node), id);
+  if ( temp ) return temp;
+  temp = refFindNode(getFalseNodeSet(node), id);
+  if ( temp ) return temp;
+  return refFindNode(getNextNode(node), id);
+}
+
+CDGNode* refGetFeasiblePath(CDGNode* node, CDGNode* list) {
+  while ( node && NULL == refFindNode(list, getID(node)) ) {
+    node = getNextNode(node);
+  }
+  if ( NULL == node ) return NULL;
+  CDGNode* out = copyToPathNode(newBlankNode(), node);
+  setTrueNodeSet(out, refGetFeasiblePath(getTrueNodeSet(node), list));
+  setFalseNodeSet(out, refGetFeasiblePath(getFalseNodeSet(node), list));
+  setNextNode(out, refGetFeasiblePath(getNextNode(node), list));
+  return out;
+}
+
+/* Optimized engines */
+
+/* OracleState - CDG of one engine
+ * @root - Root of the CDG, a compact handle for the compact engine
+ * @levels - Level graph of the levels engines
+ * @kernel - Rescoring kernel of the levels engines
+ * @pool - Pool of the parallel engine
+ * @buffer - Buffer of the buffer engine
+ * @numa - Replicated graph of the numa engine
+ * @paths - Paths to release after comparison, if allocated by the engine */
+
+typedef struct OracleState {
+  CDGNode* root;
+  CDGLevelGraph* levels;
+  int kernel;
+  CDGStealPool* pool;
+  CDGPathBuffer buffer;
+  CDGReplicatedGraph* numa;
+  CDGPath* paths;
+} OracleState;
+
+/* OracleEngine - An optimized engine under test
+ * @name - Name in the report
+ * @load - Sets up the engine on a fresh copy of the CDG
+ * @cover - Applies one coverage step and rescores
+ * @topPaths - Fills heads with the top paths and returns their number
+ * @feasible - Returns the feasible path of a path for a satisfied list
+ * @unload - Releases the engine state
+ * @seconds - Time spent in cover, topPaths and feasible
+ * @divergences - Number of divergences found */
+
+typedef struct OracleEngine {
+  const char* name;
+  void (*load)(OracleState* state, CDGNode* root);
+  void (*cover)(OracleState* state, CDGNode* nodes[], int size);
+  int (*topPaths)(OracleState* state, int numberOfPaths, CDGNode* heads[]);
+  CDGNode* (*feasible)(OracleState* state, CDGNode* path, CDGNode* list);
+  void (*unload)(OracleState* state);
+  double seconds;
+  int divergences;
+} OracleEngine;
+
+void loadPlain(OracleState* state, CDGNode* root) {
+  state->root = root;
+}
+
+void loadCompact(OracleState* state, CDGNode* root) {
+  state->root = compactCDG(root);
+  deleteCDG(root);
+}
+
+void loadLevels(OracleState* state, CDGNode* root) {
+  state->root = root;
+  state->levels = newLevelGraph(root);
+}
+
+void loadLevelsScalar(OracleState* state, CDGNode* root) {
+  loadLevels(state, root);
+  state->kernel = CDG_KERNEL_SCALAR;
+}
+
+void loadParallel(OracleState* state, CDGNode* root) {
+  state->root = root;
+  state->pool = newStealPool(4);
+}
+
+void loadBuffer(OracleState* state, CDGNode* root) {
+  static CDGNode nodes[ORACLE_BUFFER_NODES];
+  static CDGNode* heads[ORACLE_PATHS];
+  static CDGUndoEntry undo[ORACLE_BUFFER_NODES];
+  state->root = root;
+  initPathBuffer(&state->buffer, nodes, ORACLE_BUFFER_NODES, heads, ORACLE_PATHS, undo, ORACLE_BUFFER_NODES);
+}
+
+/* Two simulated NUMA nodes, so that the replicas are exercised on any host */
+
+void loadNuma(OracleState* state, CDGNode* root) {
+  state->root = root;
+  state->numa = newReplicatedGraph(root, 2);
+}
+
+void coverFull(OracleState* state, CDGNode* nodes[], int size) {
+  coverNodes(state->root, nodes, size);
+}
+
+void coverIncremental(OracleState* state, CDGNode* nodes[], int size) {
+  coverNodesWithChanges(state->root, nodes, size, NULL, 0, NULL);
+}
+
+void coverLevels(OracleState* state, CDGNode* nodes[], int size) {
+  coverNodesWithChanges(state->root, nodes, size, NULL, 0, NULL);
+  setLevelKernel(state->kernel);
+  updateCDGLevels(state->levels);
+}
+
+void coverNuma(OracleState* state, CDGNode* nodes[], int size) {
+  coverNodesWithChanges(state->root, nodes, size, NULL, 0, NULL);
+  updateReplicatedCDG(state->numa);
+}
+
+int listPaths(OracleState* state, CDGPath* paths, CDGNode* heads[]) {
+  int count = 0;
+  state->paths = paths;
+  for ( ; paths; paths = getNextPath(paths) ) {
+    heads[count++] = getPathNode(paths);
+  }
+  return count;
+}
+
+int topPathsSerial(OracleState* state, int numberOfPaths, CDGNode* heads[]) {
+  return listPaths(state, getTopPaths(state->root, numberOfPaths), heads);
+}
+
+int topPathsParallel(OracleState* state, int numberOfPaths, CDGNode* heads[]) {
+  return listPaths(state, getTopPathsParallel(state->pool, state->root, numberOfPaths), heads);
+}
+
+int topPathsBuffer(OracleState* state, int numberOfPaths, CDGNode* heads[]) {
+  int i, count = getTopPathsInto(state->root, numberOfPaths, &state->buffer);
+  if ( state->buffer.truncated ) return -1;
+  for ( i = 0; i < count; i++ ) {
+    heads[i] = state->buffer.paths[i];
+  }
+  return count;
+}
+
+int topPathsNuma(OracleState* state, int numberOfPaths, CDGNode* heads[]) {
+  return listPaths(state, getReplicatedTopPaths(state->numa, numberOfPaths), heads);
+}
+
+CDGNode* feasibleSerial(OracleState* state, CDGNode* path, CDGNode* list) {
+  (void)state;
+  return getFeasiblePath(path, list);
+}
+
+CDGNode* feasibleBuffer(OracleState* state, CDGNode* path, CDGNode* list) {
+  static CDGNode nodes[ORACLE_BUFFER_NODES];
+  CDGPathBuffer buffer;
+  CDGNode* out;
+  (void)state;
+  out = getFeasiblePathInto(path, list, initPathBuffer(&buffer, nodes, ORACLE_BUFFER_NODES, NULL, 0, NULL, 0));
+  assert(!buffer.truncated);
+  return out;
+}
+
+void unloadPlain(OracleState* state) {
+  deleteCDG(state->root);
+}
+
+void unloadLevels(OracleState* state) {
+  deleteLevelGraph(state->levels);
+  setLevelKernel(CDG_KERNEL_AUTO);
+  deleteCDG(state->root);
+}
+
+void unloadParallel(OracleState* state) {
+  deleteStealPool(state->pool);
+  deleteCDG(state->root);
+}
+
+void unloadNuma(OracleState* state) {
+  deleteReplicatedGraph(state->numa);
+  deleteCDG(state->root);
+}
+
+OracleEngine engines[] = {
+  { "full", loadPlain, coverFull, topPathsSerial, feasibleSerial, unloadPlain, 0, 0 },
+  { "incremental", loadPlain, coverIncremental, topPathsSerial, feasibleSerial, unloadPlain, 0, 0 },
+  { "levels-scalar", loadLevelsScalar, coverLevels, topPathsSerial, feasibleSerial, unloadLevels, 0, 0 },
+  { "levels-simd", loadLevels, coverLevels, topPathsSerial, feasibleSerial, unloadLevels, 0, 0 },
+  { "compact", loadCompact, coverFull, topPathsSerial, feasibleSerial, unloadPlain, 0, 0 },
+  { "parallel", loadParallel, coverIncremental, topPathsParallel, feasibleSerial, unloadParallel, 0, 0 },
+  { "buffer", loadBuffer, coverIncremental, topPathsBuffer, feasibleBuffer, unloadPlain, 0, 0 },
+  { "numa", loadNuma, coverNuma, topPathsNuma, feasibleSerial, unloadNuma, 0, 0 }
+};
+
+#define ENGINE_CNT ((int)(sizeof(engines) / sizeof(engines[0])))
+
+/* Driver */
+
+double now() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+CDGNode* buildOracleCDG(int size, unsigned int seed) {
+  CDGNode** nodes = (CDGNode**)malloc(sizeof(CDGNode*) * size);
+  char expr[32];
+  int i, parent;
+  srand(seed);
+  nodes[0] = newNode(0, 1, 1, "(p 0)", NULL, NULL, NULL, NULL);
+  for ( i = 1; i < size; i++ ) {
+    sprintf(expr, "(p %d)", i % 97);
+    nodes[i] = newNode(i, 1, 1, expr, NULL, NULL, NULL, NULL);
+    parent = rand() % i;
+    if ( 0 == rand() % 40 ) {
+      setNextNode(nodes[i], getNextNode(nodes[0]));
+      setNextNode(nodes[0], nodes[i]);
+    } else if ( rand() % 2 ) {
+      addTrueNode(nodes[parent], nodes[i]);
+    } else {
+      addFalseNode(nodes[parent], nodes[i]);
+    }
+  }
+  CDGNode* out = nodes[0];
+  free(nodes);
+  refUpdateCDG(out);
+  return out;
+}
+
+int reportDivergence(OracleEngine* engine, int trial, int step, const char* what, int id) {
+  printf("DIVERGENCE %s trial %d step %d: %s at node %d\n", engine->name, trial, step, what, id);
+  engine->divergences++;
+  return 0;
+}
+
+int compareScores(OracleEngine* engine, int trial, int step, CDGNode* ref, CDGNode* node) {
+  for ( ; ref || node; ref = getNextNode(ref), node = getNextNode(node) ) {
+    if ( NULL == ref || NULL == node ) return reportDivergence(engine, trial, step, "structure", ref ? getID(ref) : getID(node));
+    if ( getID(ref) != getID(node) ) return reportDivergence(engine, trial, step, "id", getID(ref));
+    if ( getScore(ref) != getScore(node) ) return reportDivergence(engine, trial, step, "score", getID(ref));
+    if ( !isLeaf(ref) && getOutcome(ref) != getOutcome(node) ) return reportDivergence(engine, trial, step, "outcome", getID(ref));
+    if ( !compareScores(engine, trial, step, getTrueNodeSet(ref), getTrueNodeSet(node)) ) return 0;
+    if ( !compareScores(engine, trial, step, getFalseNodeSet(ref), getFalseNodeSet(node)) ) return 0;
+  }
+  return 1;
+}
+
+int comparePath(OracleEngine* engine, int trial, int step, CDGNode* ref, CDGNode* node) {
+  for ( ; ref || node; ref = getNextNode(ref), node = getNextNode(node) ) {
+    if ( NULL == ref || NULL == node ) return reportDivergence(engine, trial, step, "path shape", ref ? getID(ref) : getID(node));
+    if ( getID(ref) != getID(node) || getOutcome(ref) != getOutcome(node) ) return reportDivergence(engine, trial, step, "path node", getID(ref));
+    if ( (NULL == getExpr(ref)) != (NULL == getExpr(node)) || (getExpr(ref) && strcmp(getExpr(ref), getExpr(node))) )
+      return reportDivergence(engine, trial, step, "path predicate", getID(ref));
+    if ( !comparePath(engine, trial, step, getTrueNodeSet(ref), getTrueNodeSet(node)) ) return 0;
+    if ( !comparePath(engine, trial, step, getFalseNodeSet(ref), getFalseNodeSet(node)) ) return 0;
+  }
+  return 1;
+}
+
+/* Satisfied list made of every other node of a path */
+
+CDGNode* pickSatisfied(CDGNode* path, CDGNode* list, int* index) {
+  for ( ; path; path = getNextNode(path) ) {
+    if ( 0 == (*index)++ % 2 ) list = newNode(getID(path), 0, 1, NULL, NULL, NULL, NULL, list);
+    list = pickSatisfied(getTrueNodeSet(path), list, index);
+    list = pickSatisfied(getFalseNodeSet(path), list, index);
+  }
+  return list;
+}
+
+void releasePaths(OracleState* state) {
+  CDGPath* next;
+  while ( state->paths ) {
+    next = getNextPath(state->paths);
+    deleteCDG(getPathNode(state->paths));
+    free(state->paths);
+    state->paths = next;
+  }
+}
+
+void runTrial(int trial, int size, int steps, unsigned int seed, double* refSeconds) {
+  CDGNode* ref = buildOracleCDG(size, seed);
+  OracleState states[ENGINE_CNT];
+  CDGNode* refHeads[ORACLE_PATHS];
+  CDGNode* heads[ORACLE_PATHS];
+  CDGNode* covered[ORACLE_COVERED];
+  CDGNode* list;
+  CDGNode* refFeasible;
+  CDGNode* feasible;
+  int e, i, step, refCount, count, index;
+  double start;
+  for ( e = 0; e < ENGINE_CNT; e++ ) {
+    memset(&states[e], 0, sizeof(OracleState));
+    engines[e].load(&states[e], buildOracleCDG(size, seed));
+  }
+  srand(seed ^ 0x5bd1e995);
+  for ( step = 0; step < steps; step++ ) {
+    for ( i = 0; i < ORACLE_COVERED; i++ ) {
+      covered[i] = newNode(rand() % size, 0, rand() % 2, NULL, NULL, NULL, NULL, NULL);
+    }
+    start = now();
+    refCoverNodes(ref, covered, ORACLE_COVERED);
+    refCount = refGetTopPaths(ref, ORACLE_PATHS, refHeads);
+    index = 0;
+    list = refCount ? pickSatisfied(refHeads[0], NULL, &index) : NULL;
+    refFeasible = refCount ? refGetFeasiblePath(refHeads[0], list) : NULL;
+    *refSeconds += now() - start;
+
+    for ( e = 0; e < ENGINE_CNT; e++ ) {
+      start = now();
+      engines[e].cover(&states[e], covered, ORACLE_COVERED);
+      count = engines[e].topPaths(&states[e], ORACLE_PATHS, heads);
+      feasible = count ? engines[e].feasible(&states[e], heads[0], list) : NULL;
+      engines[e].seconds += now() - start;
+      compareScores(&engines[e], trial, step, ref, states[e].root);
+      if ( count != refCount ) {
+        reportDivergence(&engines[e], trial, step, "path count", count);
+      } else {
+        for ( i = 0; i < count; i++ ) {
+          comparePath(&engines[e], trial, step, refHeads[i], heads[i]);
+        }
+        comparePath(&engines[e], trial, step, refFeasible, feasible);
+      }
+      if ( engines[e].feasible == feasibleSerial && feasible ) deleteCDG(feasible);
+      releasePaths(&states[e]);
+    }
+
+    for ( i = 0; i < refCount; i++ ) deleteCDG(refHeads[i]);
+    if ( refFeasible ) deleteCDG(refFeasible);
+    if ( list ) deleteCDG(list);
+    for ( i = 0; i < ORACLE_COVERED; i++ ) deleteNode(covered[i]);
+  }
+  for ( e = 0; e < ENGINE_CNT; e++ ) {
+    engines[e].unload(&states[e]);
+  }
+  deleteCDG(ref);
+}
+
+int main(int argc, char* argv[]) {
+  int trials = argc > 1 ? atoi(argv[1]) : 10;
+  int size = argc > 2 ? atoi(argv[2]) : 3000;
+  int steps = argc > 3 ? atoi(argv[3]) : 20;
+  unsigned int seed = argc > 4 ? (unsigned int)atoi(argv[4]) : 1;
+  double refSeconds = 0;
+  int trial, e, divergences = 0;
+  assert(1 < size);
+  for ( trial = 0; trial < trials; trial++ ) {
+    runTrial(trial, size, steps, seed + trial, &refSeconds);
+  }
+  printf("%d trials, %d nodes, %d steps, seed %u\n", trials, size, steps, seed);
+  printf("%-14s %12s %10s %12s\n", "engine", "seconds", "speedup", "divergences");
+  printf("%-14s %12.4f %10s %12s\n", "reference", refSeconds, "1.00", "-");
+  for ( e = 0; e < ENGINE_CNT; e++ ) {
+    printf("%-14s %12.4f %10.2f %12d\n", engines[e].name, engines[e].seconds,
+           engines[e].seconds > 0 ? refSeconds / engines[e].seconds : 0, engines[e].divergences);
+    divergences += engines[e].divergences;
+  }
+  return divergences ? 1 : 0;
+}
@@ -0,0 +1,157 @@
+#include <stdio.h>
+#include <string.h>
+#include "../src/cdg.h"
+#include "../src/cdgTrace.h"
+
+/* Workload replay
+ *
+ * Re-executes a trace written by a trace recorder (see cdgTrace.h) and prints, for each
+ * call type, the number of calls, the throughput and latency percentiles. Calls whose
+ * results differ from the recorded ones are counted as divergences.
+ *
+ * With -r a synthetic workload of interleaved coverNodes, getTopPaths, getFeasiblePath and
+ * deletePaths calls on a random CDG is recorded to the file instead, to be replayed later.
+ *
+ * Usage: ./replay trace
+ *        ./replay -r trace [nodes] [steps] [seed] */
+
+#define REPLAY_PATHS 4
+#define REPLAY_COVERED 6
+#define REPLAY_LIVE 8
+
+const char* opNames[CDG_TRACE_OPS] = { "build", "coverNodes", "getTopPaths", "getFeasiblePath", "deletePaths" };
+
+CDGNode* buildReplayCDG(int size, unsigned int seed) {
+  CDGNode** nodes = (CDGNode**)malloc(sizeof(CDGNode*) * size);
+  char expr[32];
+  int i, parent;
+  srand(seed);
+  nodes[0] = newNode(0, 1, 1, "(p 0)", NULL, NULL, NULL, NULL);
+  for ( i = 1; i < size; i++ ) {
+    sprintf(expr, "(p %d)", i % 97);
+    nodes[i] = newNode(i, 1, 1, expr, NULL, NULL, NULL, NULL);
+    parent = rand() % i;
+    if ( 0 == rand() % 40 ) {
+      setNextNode(nodes[i], getNextNode(nodes[0]));
+      setNextNode(nodes[0], nodes[i]);
+    } else if ( rand() % 2 ) {
+      addTrueNode(nodes[parent], nodes[i]);
+    } else {
+      addFalseNode(nodes[parent], nodes[i]);
+    }
+  }
+  CDGNode* out = nodes[0];
+  free(nodes);
+  return updateCDG(out);
+}
+
+/* Satisfies every other node of a path */
+
+CDGNode* pickSatisfied(CDGNode* path, CDGNode* list, int* index) {
+  CDGNode* node;
+  for ( ; path; path = getNextNode(path) ) {
+    if ( 0 == (*index)++ % 2 ) {
+      node = newBlankNode();
+      setID(node, getID(path));
+      setNextNode(node, list);
+      list = node;
+    }
+    list = pickSatisfied(getTrueNodeSet(path), list, index);
+    list = pickSatisfied(getFalseNodeSet(path), list, index);
+  }
+  return list;
+}
+
+/* Keeps a few path lists alive at a time, so that deletes interleave with the other calls */
+
+int recordWorkload(const char* file, int size, int steps, unsigned int seed) {
+  FILE* out = fopen(file, "wb");
+  if ( NULL == out ) {
+    perror(file);
+    return 1;
+  }
+  CDGNode* root = buildReplayCDG(size, seed);
+  CDGNode* covered[REPLAY_COVERED];
+  CDGPath* live[REPLAY_LIVE] = { NULL };
+  CDGNode* list;
+  CDGNode* feasible;
+  int i, step, slot, index;
+  CDGTraceRecorder* rec = newTraceRecorder(out);
+  setTraceRecorder(rec);
+  srand(seed ^ 0x5bd1e995);
+  for ( i = 0; i < REPLAY_COVERED; i++ ) covered[i] = newBlankNode();
+  for ( step = 0; step < steps; step++ ) {
+    for ( i = 0; i < REPLAY_COVERED; i++ ) {
+      setID(covered[i], rand() % size);
+      setOutcome(covered[i], rand() % 2);
+    }
+    coverNodes(root, covered, 1 + rand() % REPLAY_COVERED);
+    slot = step % REPLAY_LIVE;
+    if ( NULL != live[slot] ) deletePaths(live[slot]);
+    live[slot] = getTopPaths(root, 1 + rand() % REPLAY_PATHS);
+    if ( NULL != live[slot] ) {
+      index = 0;
+      list = pickSatisfied(getPathNode(live[slot]), NULL, &index);
+      feasible = getFeasiblePath(getPathNode(live[slot]), list);
+      if ( NULL != feasible ) deleteCDG(feasible);
+      if ( NULL != list ) deleteCDG(list);
+    }
+  }
+  for ( slot = 0; slot < REPLAY_LIVE; slot++ ) {
+    if ( NULL != live[slot] ) deletePaths(live[slot]);
+  }
+  printf("%lu records written to %s\n", rec->records, file);
+  deleteTraceRecorder(rec);
+  fclose(out);
+  for ( i = 0; i < REPLAY_COVERED; i++ ) deleteNode(covered[i]);
+  deleteCDG(root);
+  return 0;
+}
+
+int replayFile(const char* file) {
+  FILE* in = fopen(file, "rb");
+  if ( NULL == in ) {
+    perror(file);
+    return 1;
+  }
+  fseek(in, 0, SEEK_END);
+  long size = ftell(in);
+  fseek(in, 0, SEEK_SET);
+  unsigned char* data = (unsigned char*)malloc(size + 1);
+  assert(NULL != data);
+  size_t got = fread(data, 1, size, in);
+  fclose(in);
+  CDGTraceStats* stats = newTraceStats();
+  int ok = replayTrace(data, got, stats);
+  double seconds;
+  int op;
+  printf("%s: %ld bytes%s\n", file, size, ok ? "" : ", malformed record, replay stopped");
+  printf("%-16s %10s %12s %10s %10s %10s %10s\n", "call", "calls", "calls/s", "p50 us", "p90 us", "p99 us", "max us");
+  for ( op = CDG_TRACE_COVER; op < CDG_TRACE_OPS; op++ ) {
+    seconds = getTraceSeconds(stats, op);
+    printf("%-16s %10d %12.0f %10.2f %10.2f %10.2f %10.2f\n", opNames[op], stats->counts[op],
+           seconds > 0 ? stats->counts[op] / seconds : 0,
+           1e6 * getTraceLatency(stats, op, 50), 1e6 * getTraceLatency(stats, op, 90),
+           1e6 * getTraceLatency(stats, op, 99), 1e6 * getTraceLatency(stats, op, 100));
+  }
+  printf("%d divergences\n", stats->divergences);
+  ok = ok && 0 == stats->divergences;
+  deleteTraceStats(stats);
+  free(data);
+  return ok ? 0 : 1;
+}
+
+int main(int argc, char* argv[]) {
+  if ( 3 <= argc && 0 == strcmp("-r", argv[1]) ) {
+    int size = argc > 3 ? atoi(argv[3]) : 3000;
+    int steps = argc > 4 ? atoi(argv[4]) : 2000;
+    unsigned int seed = argc > 5 ? (unsigned int)atoi(argv[5]) : 1;
+    assert(1 < size);
+    return recordWorkload(argv[2], size, steps, seed);
+  }
+  if ( 2 != argc ) {
+    fprintf(stderr, "Usage: %s trace\n       %s -r trace [nodes] [steps] [seed]\n", argv[0], argv[0]);
+    return 2;
+  }
+  return replayFile(argv[1]);
+}
@@ -1,7 +1,26 @@
 #include <stdio.h>
+#include <limits.h>
 #include "../src/cdg.h"
+#include "../src/cdgForest.h"
+#include "../src/cdgBatch.h"
+#include "../src/cdgPathTrie.h"
+#include "../src/cdgWire.h"
+#include "../src/cdgCompact.h"
+#include "../src/cdgLevels.h"
+#include "../src/cdgGraph.h"
+#include "../src/cdgAsync.h"
+#include "../src/cdgParallel.h"
+#include "../src/cdgBuffer.h"
+#include "../src/cdgHits.h"
+#include "../src/cdgCores.h"
+#include "../src/cdgSeen.h"
+#include "../src/cdgTrace.h"
+#include "../src/cdgShapes.h"
+#include "../src/cdgBudget.h"
+#include "../src/cdgPredicates.h"
+#include "../src/cdgNuma.h"
 
-CDGNode* root;
+static CDGNode* root;
 
 void tCreateNode();
 void tUpdateCDG();
@@ -11,6 +30,29 @@ void tearDown();
 void printScores();
 void tFeasiblePath();
 void tPathLength();
+void tTransaction();
+void tForest();
+void tFeasibleBatch();
+void tPathTrie();
+void tWire();
+void tCompact();
+void tLevelRescore();
+void tCoverageChanges();
+void tEpochCache();
+void tAsyncScoring();
+void tParallelTopPath();
+void tPathBuffer();
+void tHitScoring();
+void tDirectedPath();
+void tInfeasibleCores();
+void tDistinctPaths();
+void tImplicitBranches();
+void tIncrementalStructure();
+void tTraceReplay();
+void tSharedShapes();
+void tBudgetedPaths();
+void tParsedPredicates();
+void tReplicatedGraph();
 
 int main () {
   setup();
@@ -20,6 +62,29 @@ int main () {
   tUpdateCDG();
   tFeasiblePath();
   tPathLength();
+  tTransaction();
+  tForest();
+  tFeasibleBatch();
+  tPathTrie();
+  tWire();
+  tCompact();
+  tLevelRescore();
+  tCoverageChanges();
+  tEpochCache();
+  tAsyncScoring();
+  tParallelTopPath();
+  tPathBuffer();
+  tHitScoring();
+  tDirectedPath();
+  tInfeasibleCores();
+  tDistinctPaths();
+  tImplicitBranches();
+  tIncrementalStructure();
+  tTraceReplay();
+  tSharedShapes();
+  tBudgetedPaths();
+  tParsedPredicates();
+  tReplicatedGraph();
   printf("Hurray... !!! Everything Worked !!!\n");
   return 0;
 }
@@ -166,3 +231,1615 @@ void tFeasiblePath() {
 void tPathLength() {
   assert(15 == getPathLength(getPathNode(getTopPaths(root, 1))));
 }
+
+int collectNodes(CDGNode* nodes[], int scores[], int outcomes[]) {
+  Stack* nodeStack = stackNew(sizeof(CDGNode*));
+  int size = 0;
+  postOrder(root, nodeStack);
+  while ( !stackIsEmpty(nodeStack) ) {
+    stackPop(nodeStack, &nodes[size]);
+    scores[size] = getScore(nodes[size]);
+    outcomes[size] = getOutcome(nodes[size]);
+    size++;
+  }
+  stackFree(nodeStack);
+  return size;
+}
+
+void tTransaction() {
+  CDGNode* nodes[64];
+  int scores[64], outcomes[64], afterScores[64], afterOutcomes[64];
+  int i, size;
+  updateCDG(root);
+  size = collectNodes(nodes, scores, outcomes);
+
+  CDGTransaction* txn = beginTransaction();
+  for ( i = 0; i < size; i++ ) {
+    if ( NULL == getTrueNodeSet(nodes[i]) && NULL == getFalseNodeSet(nodes[i]) && 1 == i % 2 ) {
+      transactSetScore(txn, nodes[i], 0);
+    }
+  }
+  collectNodes(nodes, afterScores, afterOutcomes);
+  updateCDG(root);
+  for ( i = 0; i < size; i++ ) {
+    assert(afterScores[i] == getScore(nodes[i]));
+    assert(afterOutcomes[i] == getOutcome(nodes[i]));
+  }
+  rollbackTransaction(txn);
+  for ( i = 0; i < size; i++ ) {
+    assert(scores[i] == getScore(nodes[i]));
+    assert(outcomes[i] == getOutcome(nodes[i]));
+  }
+
+  deletePaths(getTopPaths(root, 3));
+  for ( i = 0; i < size; i++ ) {
+    assert(scores[i] == getScore(nodes[i]));
+    assert(outcomes[i] == getOutcome(nodes[i]));
+  }
+}
+
+CDGNode* newDecision(int id, CDGNode* trueNode, CDGNode* falseNode) {
+  CDGNode* node = newNode(id, 1, 1, NULL, NULL, NULL, NULL, NULL);
+  addTrueNode(node, trueNode);
+  addFalseNode(node, falseNode);
+  return node;
+}
+
+CDGNode* newLeaf(int id) {
+  return newNode(id, 1, 1, NULL, NULL, NULL, NULL, NULL);
+}
+
+void tForest() {
+  CDGForest* forest = newForest();
+  int a = addFunction(forest, newDecision(1, newLeaf(2), newLeaf(3)));
+  int b = addFunction(forest, newDecision(10, newDecision(11, newLeaf(12), newLeaf(13)), newLeaf(14)));
+  addCallSite(forest, b, 14, a);
+  assert(a == getCallSites(forest, b)->function);
+  assert(b == getCallers(forest, a)->function);
+  assert(1 == getFunctionScore(forest, a));
+  assert(2 == getFunctionScore(forest, b));
+  assert(b == getBestFunction(forest));
+
+  CDGForestPath* paths = forestGetTopPaths(forest, 3);
+  assert(b == paths->function);
+  assert(10 == getID(paths->node) && 11 == getID(getTrueNodeSet(paths->node)));
+  assert(1 == getOutcome(getTrueNodeSet(paths->node)));
+  assert(b == paths->next->function);
+  assert(0 == getOutcome(getTrueNodeSet(paths->next->node)));
+  assert(NULL != paths->next->next && NULL == paths->next->next->next);
+  deleteForestPaths(paths);
+  assert(2 == getFunctionScore(forest, b));
+  assert(b == getBestFunction(forest));
+
+  CDGNode* covered[3];
+  covered[0] = newNode(11, 0, 1, NULL, NULL, NULL, NULL, NULL);
+  covered[1] = newNode(11, 0, 0, NULL, NULL, NULL, NULL, NULL);
+  covered[2] = newNode(10, 0, 0, NULL, NULL, NULL, NULL, NULL);
+  forestCoverNodes(forest, b, covered, 1);
+  assert(b == getBestFunction(forest));
+  forestCoverNodes(forest, b, covered + 1, 2);
+  assert(0 == getFunctionScore(forest, b));
+  assert(a == getBestFunction(forest));
+  paths = forestGetTopPaths(forest, 5);
+  assert(a == paths->function && 1 == getOutcome(paths->node));
+  assert(a == paths->next->function && 0 == getOutcome(paths->next->node));
+  assert(NULL == paths->next->next);
+  deleteForestPaths(paths);
+  deleteNode(covered[0]);
+  deleteNode(covered[1]);
+  deleteNode(covered[2]);
+  deleteForest(forest);
+}
+
+int samePath(CDGNode* a, CDGNode* b) {
+  if ( NULL == a || NULL == b ) return a == b;
+  if ( getID(a) != getID(b) || getOutcome(a) != getOutcome(b) ) return 0;
+  return samePath(getTrueNodeSet(a), getTrueNodeSet(b))
+    && samePath(getFalseNodeSet(a), getFalseNodeSet(b))
+    && samePath(getNextNode(a), getNextNode(b));
+}
+
+CDGNode* newIdList(int ids[], int size) {
+  CDGNode* head = NULL;
+  while ( size-- ) {
+    head = newNode(ids[size], 0, 1, NULL, NULL, NULL, NULL, head);
+  }
+  return head;
+}
+
+void tFeasibleBatch() {
+  CDGPath* topPaths = getTopPaths(root, 3);
+  int satA[9] = {1,7,5,16,3,20,22,30,34};
+  int satB[4] = {3,22,1,5};
+  int satC[1] = {42};
+  CDGNode* paths[6];
+  int* satisfied[6] = {satA, satB, satC, satA, satB, satC};
+  int sizes[6] = {9, 4, 1, 9, 4, 1};
+  CDGPath* temp = topPaths;
+  int i;
+  for ( i = 0; i < 6; i++ ) {
+    paths[i] = getPathNode(temp);
+    if ( getNextPath(temp) ) temp = getNextPath(temp);
+  }
+  CDGFeasibleBatch* batch = getFeasiblePaths(paths, satisfied, sizes, 6, 4);
+  for ( i = 0; i < 6; i++ ) {
+    CDGNode* list = newIdList(satisfied[i], sizes[i]);
+    CDGNode* expected = getFeasiblePath(paths[i], list);
+    assert(samePath(expected, getBatchPath(batch, i)));
+    if ( expected ) deleteCDG(expected);
+    deleteCDG(list);
+  }
+  assert(NULL == getBatchPath(batch, 2));
+  deleteFeasibleBatch(batch);
+  deletePaths(topPaths);
+}
+
+void tPathTrie() {
+  CDGPathTrie* trie = getTopPathTrie(root, 3);
+  CDGPath* paths = getTopPaths(root, 3);
+  CDGPathTrie* fromPaths = buildPathTrie(paths);
+  assert(NULL == getNextPath(getNextPath(paths)));
+  assert(23 == getPathTrieSize(trie));
+  assert(23 == getPathTrieSize(fromPaths));
+
+  /* The decisions of the CDG have no exprs, so each is written as a comment */
+  FILE* script = tmpfile();
+  char line[256];
+  int id, outcome, decisions = 0, pushes = 0, pops = 0, checks = 0;
+  writePathTrieScript(script, trie);
+  rewind(script);
+  while ( fgets(line, sizeof(line), script) ) {
+    if ( 0 == strcmp(line, "(push 1)\n") ) pushes++;
+    else if ( 0 == strcmp(line, "(pop 1)\n") ) pops++;
+    else if ( 0 == strcmp(line, "(check-sat)\n") ) checks++;
+    else {
+      assert(2 == sscanf(line, "; %d %d", &id, &outcome));
+      decisions++;
+    }
+    assert(pops <= pushes);
+  }
+  fclose(script);
+  assert(23 == decisions);
+  assert(2 == checks);
+  assert(2 == pushes && 2 == pops);
+  deletePathTrie(fromPaths);
+  deletePathTrie(trie);
+  deletePaths(paths);
+
+  /* Shared prefixes are asserted once, diverging paths each get a scope */
+  CDGNode* path = newNode(1, 0, 1, "(p 1)", newNode(2, 0, 1, "(p 2)", NULL, NULL, NULL, NULL), NULL, NULL, NULL);
+  trie = addPathToTrie(newPathTrie(), path);
+  deleteCDG(path);
+  path = newNode(1, 0, 1, "(p 1)", newNode(3, 0, 0, "(p 3)", NULL, NULL, NULL, NULL), NULL, NULL, NULL);
+  addPathToTrie(trie, path);
+  addPathToTrie(trie, path);
+  deleteCDG(path);
+  script = tmpfile();
+  writePathTrieScript(script, trie);
+  rewind(script);
+  char text[512];
+  size_t size = fread(text, 1, sizeof(text) - 1, script);
+  text[size] = 0;
+  fclose(script);
+  assert(0 == strcmp(text, "(assert (p 1))\n"
+                           "(push 1)\n(assert (p 2))\n(check-sat)\n(pop 1)\n"
+                           "(push 1)\n(assert (not (p 3)))\n(check-sat)\n(pop 1)\n"));
+  deletePathTrie(trie);
+}
+
+void tWire() {
+  CDGPath* paths = getTopPaths(root, 2);
+  CDGNode* exprPath = newNode(-7, 1, 0, "(> x 0)", NULL, NULL, NULL, NULL);
+  setTrueNodeSet(exprPath, newNode(2, 1, 1, "(< y x)", NULL, NULL, NULL, NULL));
+  setNextNode(exprPath, newNode(3, 1, 1, "(> x 0)", NULL, NULL, NULL, NULL));
+
+  CDGInternTable* table = newInternTable();
+  CDGWireBuffer* buf = newWireBuffer();
+  encodePathList(buf, table, paths);
+  encodePath(buf, table, exprPath);
+  encodePath(buf, table, NULL);
+  assert(2 == table->size);
+  assert(buf->size < 3 * (size_t)(getPathLength(getPathNode(paths)) + getPathLength(getPathNode(getNextPath(paths))) + 3));
+  size_t pathsSize = buf->size;
+  encodeInternTable(buf, table);
+
+  CDGWireReader reader;
+  const char* strings[2];
+  int count, i;
+  initWireReader(&reader, buf->data + pathsSize, buf->size - pathsSize);
+  assert(wireReadCount(&reader, &count) && 2 == count);
+  for ( i = 0; i < count; i++ ) {
+    assert(wireReadString(&reader, &strings[i]));
+    assert(0 == strcmp(strings[i], getInternedString(table, i + 1)));
+  }
+
+  initWireReader(&reader, buf->data, pathsSize);
+  assert(wireReadCount(&reader, &count) && 2 == count);
+  CDGPath* temp;
+  CDGNode* decoded;
+  for ( temp = paths; temp; temp = getNextPath(temp) ) {
+    decoded = decodePath(&reader, strings, 2);
+    assert(samePath(getPathNode(temp), decoded));
+    deleteCDG(decoded);
+  }
+  decoded = decodePath(&reader, strings, 2);
+  assert(samePath(exprPath, decoded));
+  assert(0 == strcmp("(< y x)", getExpr(getTrueNodeSet(decoded))));
+  assert(getExpr(decoded) != getExpr(getNextNode(decoded)));
+  assert(0 == strcmp(getExpr(decoded), getExpr(getNextNode(decoded))));
+  deleteCDG(decoded);
+  assert(NULL == decodePath(&reader, strings, 2));
+  assert(reader.pos == reader.size);
+
+  initWireReader(&reader, buf->data, pathsSize - 2);
+  assert(wireReadCount(&reader, &count));
+  decoded = decodePath(&reader, strings, 2);
+  deleteCDG(decoded);
+  decoded = decodePath(&reader, strings, 2);
+  deleteCDG(decoded);
+  assert(NULL == decodePath(&reader, strings, 2));
+
+  CDGWireBuffer* bad = newWireBuffer();
+  wireWriteVarint(bad, 1);
+  wireWriteVarint(bad, 0);
+  wireWriteVarint(bad, 3);
+  initWireReader(&reader, bad->data, bad->size);
+  assert(NULL == decodePath(&reader, strings, 2));
+  initWireReader(&reader, bad->data, bad->size);
+  decoded = decodePath(&reader, NULL, 0);
+  assert(NULL != decoded && NULL == getExpr(decoded));
+  deleteCDG(decoded);
+  CDGWireNode wireNode;
+  clearWireBuffer(bad);
+  wireWriteVarint(bad, 0);
+  wireWriteVarint(bad, (unsigned long long)INT_MAX + 1);
+  initWireReader(&reader, bad->data, bad->size);
+  assert(!wireReadNode(&reader, &wireNode));
+  deleteWireBuffer(bad);
+
+  deleteWireBuffer(buf);
+  deleteInternTable(table);
+  deleteCDG(exprPath);
+  deletePaths(paths);
+}
+
+CDGNode* buildRandomCDG(int size, unsigned int seed) {
+  CDGNode** nodes = (CDGNode**)malloc(sizeof(CDGNode*) * size);
+  char expr[32];
+  int i, parent;
+  srand(seed);
+  nodes[0] = newNode(0, 1, 1, "(p 0)", NULL, NULL, NULL, NULL);
+  for ( i = 1; i < size; i++ ) {
+    sprintf(expr, "(p %d)", i % 50);
+    nodes[i] = newNode(i, 1, 1, expr, NULL, NULL, NULL, NULL);
+    parent = rand() % i;
+    if ( 0 == parent % 7 && 0 == rand() % 3 ) {
+      setNextNode(nodes[i], getNextNode(nodes[0]));
+      setNextNode(nodes[0], nodes[i]);
+    } else if ( rand() % 2 ) {
+      addTrueNode(nodes[parent], nodes[i]);
+    } else {
+      addFalseNode(nodes[parent], nodes[i]);
+    }
+  }
+  CDGNode* out = nodes[0];
+  free(nodes);
+  return updateCDG(out);
+}
+
+int sameCDG(CDGNode* a, CDGNode* b) {
+  if ( NULL == a || NULL == b ) return a == b;
+  if ( getID(a) != getID(b) || getScore(a) != getScore(b) || getOutcome(a) != getOutcome(b) ) return 0;
+  if ( (NULL == getExpr(a)) != (NULL == getExpr(b)) ) return 0;
+  if ( getExpr(a) && 0 != strcmp(getExpr(a), getExpr(b)) ) return 0;
+  if ( (NULL == getParent(a)) != (NULL == getParent(b)) ) return 0;
+  if ( getParent(a) && getID(getParent(a)) != getID(getParent(b)) ) return 0;
+  return sameCDG(getTrueNodeSet(a), getTrueNodeSet(b))
+    && sameCDG(getFalseNodeSet(a), getFalseNodeSet(b))
+    && sameCDG(getNextNode(a), getNextNode(b));
+}
+
+void tCompact() {
+  assert(16 == sizeof(CDGCompactNode));
+  CDGNode* compact = compactCDG(root);
+  assert(isCompactNode(compact));
+  assert(sameCDG(root, compact));
+  CDGPath* paths = getTopPaths(root, 2);
+  CDGPath* compactPaths = getTopPaths(compact, 2);
+  assert(samePath(getPathNode(paths), getPathNode(compactPaths)));
+  assert(samePath(getPathNode(getNextPath(paths)), getPathNode(getNextPath(compactPaths))));
+  deletePaths(compactPaths);
+  deletePaths(paths);
+  deleteCDG(compact);
+
+  CDGNode* big = buildRandomCDG(5000, 7);
+  compact = compactCDG(big);
+  assert(sameCDG(big, compact));
+  assert(getCompactCDGMemory(compact) * 3 <= 5000 * (sizeof(CDGNode) + sizeof(size_t)));
+  CDGNode* covered[4];
+  int i;
+  for ( i = 0; i < 4; i++ ) {
+    covered[i] = newNode(i * 11, 0, i % 2, NULL, NULL, NULL, NULL, NULL);
+  }
+  coverNodes(big, covered, 4);
+  coverNodes(compact, covered, 4);
+  assert(sameCDG(big, compact));
+  CDGTransaction* txn = beginTransaction();
+  deleteCDG(getTopPath(big, txn));
+  commitTransaction(txn);
+  txn = beginTransaction();
+  deleteCDG(getTopPath(compact, txn));
+  commitTransaction(txn);
+  assert(sameCDG(big, compact));
+  for ( i = 0; i < 4; i++ ) {
+    deleteNode(covered[i]);
+  }
+  deleteCDG(compact);
+  deleteCDG(big);
+}
+
+void coverRandomLeaves(CDGNode* node, int modulo) {
+  while ( node ) {
+    if ( isLeaf(node) && 0 == getID(node) % modulo ) setScore(node, 0);
+    coverRandomLeaves(getTrueNodeSet(node), modulo);
+    coverRandomLeaves(getFalseNodeSet(node), modulo);
+    node = getNextNode(node);
+  }
+}
+
+void tLevelRescore() {
+  int kernels[3] = {CDG_KERNEL_SCALAR, CDG_KERNEL_SSE2, CDG_KERNEL_AVX2};
+  int i, modulo;
+  CDGNode* expected = buildRandomCDG(3000, 11);
+  CDGNode* actual = buildRandomCDG(3000, 11);
+  CDGLevelGraph* graph = newLevelGraph(actual);
+  for ( i = 0; i < 3; i++ ) {
+    setLevelKernel(kernels[i]);
+    for ( modulo = 7; modulo > 1; modulo-- ) {
+      coverRandomLeaves(expected, modulo * (i + 1));
+      coverRandomLeaves(actual, modulo * (i + 1));
+      updateCDG(expected);
+      updateCDGLevels(graph);
+      assert(sameCDG(expected, actual));
+    }
+  }
+  setLevelKernel(CDG_KERNEL_AUTO);
+  deleteLevelGraph(graph);
+
+  graph = newLevelGraph(root);
+  updateCDGLevels(graph);
+  assert(7 == getScore(root));
+  deleteLevelGraph(graph);
+  deleteCDG(expected);
+  deleteCDG(actual);
+}
+
+void tCoverageChanges() {
+  CDGNode* expected = buildRandomCDG(2000, 5);
+  CDGNode* actual = buildRandomCDG(2000, 5);
+  CDGNode* nodes[64];
+  int scores[64], outcomes[64];
+  CDGChange changes[256];
+  CDGNode* covered[8];
+  int i, round, count, size;
+  for ( round = 0; round < 20; round++ ) {
+    for ( i = 0; i < 8; i++ ) {
+      covered[i] = newNode((round * 37 + i * 101) % 2000, 0, i % 2, NULL, NULL, NULL, NULL, NULL);
+    }
+    coverNodes(expected, covered, 8);
+    count = coverNodesWithChanges(actual, covered, 8, changes, 256, NULL);
+    assert(count <= 256);
+    assert(sameCDG(expected, actual));
+    for ( i = 0; i < count; i++ ) {
+      assert(changes[i].oldScore != changes[i].newScore || changes[i].oldOutcome != changes[i].newOutcome);
+      assert(getScore(changes[i].node) == changes[i].newScore);
+      if ( CDG_CHANGE_LEAF == changes[i].kind ) assert(1 == changes[i].oldScore && 0 == changes[i].newScore);
+    }
+    assert(0 == coverNodesWithChanges(actual, covered, 8, NULL, 0, NULL));
+    for ( i = 0; i < 8; i++ ) {
+      deleteNode(covered[i]);
+    }
+  }
+  deleteCDG(expected);
+  deleteCDG(actual);
+
+  updateCDG(root);
+  size = collectNodes(nodes, scores, outcomes);
+  covered[0] = newNode(16, 0, 1, NULL, NULL, NULL, NULL, NULL);
+  count = coverNodesWithChanges(root, covered, 1, changes, 1, NULL);
+  assert(1 < count);
+  assert(CDG_CHANGE_LEAF == changes[0].kind && 18 == changes[0].id);
+  assert(0 == coverNodesWithChanges(root, covered, 1, NULL, 0, NULL));
+  for ( i = 0; i < size; i++ ) {
+    setScore(nodes[i], scores[i]);
+    setOutcome(nodes[i], outcomes[i]);
+  }
+  deleteNode(covered[0]);
+}
+
+void tEpochCache() {
+  CDG* cdg = cdgNew(buildRandomCDG(500, 3));
+  int i;
+  CDGNode* expected = buildRandomCDG(500, 3);
+  CDGPathSet* first = cdgGetTopPaths(cdg, 3);
+  CDGPathSet* second = cdgGetTopPaths(cdg, 3);
+  CDGPath* paths = getTopPaths(expected, 3);
+  assert(first == second);
+  assert(samePath(getPathNode(paths), getPathNode(getPathSetPaths(first))));
+  releasePathSet(second);
+
+  int ids[3] = {0, 1, 2};
+  CDGNode* list = newIdList(ids, 3);
+  CDGNode* otherList = newIdList(ids, 2);
+  CDGPathSet* feasible = cdgGetFeasiblePath(cdg, getPathNode(getPathSetPaths(first)), list);
+  CDGPathSet* cached = cdgGetFeasiblePath(cdg, getPathNode(getPathSetPaths(first)), list);
+  CDGPathSet* other = cdgGetFeasiblePath(cdg, getPathNode(getPathSetPaths(first)), otherList);
+  assert(feasible == cached && feasible != other);
+  releasePathSet(cached);
+  releasePathSet(other);
+  /* Entries are found by the content of the path, not its address */
+  cached = cdgGetFeasiblePath(cdg, getPathNode(paths), list);
+  assert(feasible == cached);
+  releasePathSet(cached);
+  /* Entries outlive the top paths they were taken from */
+  CDGPathSet* more = cdgGetTopPaths(cdg, 4);
+  cached = cdgGetFeasiblePath(cdg, getPathNode(getPathSetPaths(first)), list);
+  assert(feasible == cached);
+  releasePathSet(cached);
+  releasePathSet(more);
+
+  unsigned long epoch = cdgEpoch(cdg);
+  CDGNode* covered[1];
+  CDGNode* deepest = getPathNode(paths);
+  while ( getTrueNodeSet(deepest) || getFalseNodeSet(deepest) ) {
+    deepest = getTrueNodeSet(deepest) ? getTrueNodeSet(deepest) : getFalseNodeSet(deepest);
+  }
+  covered[0] = newNode(getID(deepest), 0, getOutcome(deepest), NULL, NULL, NULL, NULL, NULL);
+  assert(0 < cdgCoverNodes(cdg, covered, 1));
+  coverNodes(expected, covered, 1);
+  assert(epoch < cdgEpoch(cdg));
+  epoch = cdgEpoch(cdg);
+  assert(0 == cdgCoverNodes(cdg, covered, 1));
+  assert(epoch == cdgEpoch(cdg));
+  /* Coverage changes keep the entries, feasible paths do not depend on coverage */
+  cached = cdgGetFeasiblePath(cdg, getPathNode(paths), list);
+  assert(feasible == cached);
+  releasePathSet(cached);
+  /* An entry whose fingerprint collides with another path is told apart by its content */
+  CDGNode* otherPath = getPathNode(getNextPath(paths));
+  other = cdgGetFeasiblePath(cdg, otherPath, list);
+  for ( i = 0; i < CDG_FEASIBLE_CACHE_SIZE && other != cdg->feasible[i].result; i++ );
+  assert(i < CDG_FEASIBLE_CACHE_SIZE);
+  unsigned long long collision = cdg->feasible[i].fingerprint;
+  cdg->feasible[i].fingerprint = 0;
+  releasePathSet(other);
+  for ( i = 0; i < CDG_FEASIBLE_CACHE_SIZE && feasible != cdg->feasible[i].result; i++ );
+  assert(i < CDG_FEASIBLE_CACHE_SIZE);
+  cdg->feasible[i].fingerprint = collision;
+  other = cdgGetFeasiblePath(cdg, otherPath, list);
+  assert(feasible != other);
+  releasePathSet(other);
+  second = cdgGetTopPaths(cdg, 3);
+  assert(first != second && epoch == second->epoch);
+  assert(sameCDG(expected, cdgRoot(cdg)));
+  releasePathSet(second);
+  releasePathSet(feasible);
+  releasePathSet(first);
+
+  cdgAddFalseNode(cdg, cdgRoot(cdg), newDecision(9000, newLeaf(9001), NULL));
+  addFalseNode(expected, newDecision(9000, newLeaf(9001), NULL));
+  updateCDG(expected);
+  assert(epoch < cdgEpoch(cdg));
+  assert(sameCDG(expected, cdgRoot(cdg)));
+
+  deleteNode(covered[0]);
+  deleteCDG(list);
+  deleteCDG(otherList);
+  deletePaths(paths);
+  deleteCDG(expected);
+  cdgDelete(cdg);
+}
+
+void* readTopPaths(void* arg) {
+  CDGAsync* async = (CDGAsync*)arg;
+  CDGPathSet* set;
+  int i;
+  for ( i = 0; i < 2000; i++ ) {
+    set = cdgAsyncGetTopPaths(async);
+    assert(NULL != set && 3 == set->numberOfPaths);
+    releasePathSet(set);
+  }
+  return NULL;
+}
+
+void tAsyncScoring() {
+  CDG* cdg = cdgNew(buildRandomCDG(1000, 9));
+  CDGNode* expected = buildRandomCDG(1000, 9);
+  CDGAsync* async = cdgStartAsync(cdg, 3);
+  CDGPathSet* initial = cdgAsyncGetTopPaths(async);
+  pthread_t reader;
+  pthread_create(&reader, NULL, readTopPaths, async);
+  CDGNode* covered[4];
+  int round, i;
+  for ( round = 0; round < 30; round++ ) {
+    for ( i = 0; i < 4; i++ ) {
+      covered[i] = newNode((round * 53 + i * 7) % 1000, 0, (round + i) % 2, NULL, NULL, NULL, NULL, NULL);
+    }
+    cdgAsyncCoverNodes(async, covered, 4);
+    coverNodes(expected, covered, 4);
+    for ( i = 0; i < 4; i++ ) {
+      deleteNode(covered[i]);
+    }
+  }
+  cdgAsyncFlush(async);
+  CDGPathSet* latest = cdgAsyncGetTopPaths(async);
+  CDGPath* paths = getTopPaths(expected, 3);
+  assert(initial != latest);
+  assert(samePath(getPathNode(paths), getPathNode(getPathSetPaths(latest))));
+  pthread_join(reader, NULL);
+  releasePathSet(latest);
+  releasePathSet(initial);
+  assert(cdg == cdgStopAsync(async));
+  assert(sameCDG(expected, cdgRoot(cdg)));
+  deletePaths(paths);
+  deleteCDG(expected);
+  cdgDelete(cdg);
+}
+
+void tParallelTopPath() {
+  CDGNode* big = buildRandomCDG(3000, 11);
+  CDGNode* before = buildRandomCDG(3000, 11);
+  CDGStealPool* pool = newStealPool(4);
+  CDGPath* expected = getTopPaths(big, 8);
+  CDGPath* actual = getTopPathsParallel(pool, big, 8);
+  CDGPath* e = expected;
+  CDGPath* a = actual;
+  while ( e && a ) {
+    assert(samePath(getPathNode(e), getPathNode(a)));
+    e = getNextPath(e);
+    a = getNextPath(a);
+  }
+  assert(NULL == e && NULL == a);
+  assert(sameCDG(before, big));
+
+  CDGTransaction* serial = beginTransaction();
+  CDGTransaction* parallel = beginTransaction();
+  CDGNode* serialPath = getTopPath(before, serial);
+  CDGNode* parallelPath = getTopPathParallel(pool, big, parallel);
+  assert(samePath(serialPath, parallelPath));
+  assert(sameCDG(before, big));
+  rollbackTransaction(parallel);
+  rollbackTransaction(serial);
+  deleteCDG(serialPath);
+  deleteCDG(parallelPath);
+
+  CDGPath* path;
+  for ( path = expected; path; path = getNextPath(path) ) deleteCDG(getPathNode(path));
+  for ( path = actual; path; path = getNextPath(path) ) deleteCDG(getPathNode(path));
+  for ( path = expected; path; path = e ) { e = getNextPath(path); free(path); }
+  for ( path = actual; path; path = a ) { a = getNextPath(path); free(path); }
+  deleteStealPool(pool);
+  deleteCDG(before);
+  deleteCDG(big);
+}
+
+void tPathBuffer() {
+  CDGNode* big = buildRandomCDG(2000, 13);
+  CDGNode* before = buildRandomCDG(2000, 13);
+  CDGNode nodes[2048];
+  CDGNode* heads[4];
+  CDGUndoEntry undo[2048];
+  CDGPathBuffer buffer;
+  initPathBuffer(&buffer, nodes, 2048, heads, 4, undo, 2048);
+  CDGPath* expected = getTopPaths(big, 4);
+  CDGPath* path = expected;
+  int i;
+  assert(4 == getTopPathsInto(big, 4, &buffer));
+  assert(0 == buffer.truncated);
+  for ( i = 0; i < 4; i++, path = getNextPath(path) ) {
+    assert(samePath(getPathNode(path), heads[i]));
+  }
+  assert(sameCDG(before, big));
+
+  initPathBuffer(&buffer, nodes, 8, heads, 4, undo, 2048);
+  i = getTopPathsInto(big, 4, &buffer);
+  assert(buffer.truncated && i < 4 && buffer.requiredNodes > 8);
+  initPathBuffer(&buffer, nodes, buffer.requiredNodes, heads, 4, undo, 2048);
+  assert(getTopPathsInto(big, 4, &buffer) > i);
+  assert(samePath(getPathNode(expected), heads[0]));
+  assert(sameCDG(before, big));
+
+  CDGNode* list = getPathNode(getNextPath(expected));
+  CDGNode* feasible = getFeasiblePath(getPathNode(expected), list);
+  initPathBuffer(&buffer, nodes, 2, NULL, 0, NULL, 0);
+  assert(NULL == getFeasiblePathInto(getPathNode(expected), list, &buffer));
+  assert(buffer.truncated && getPathLength(feasible) == buffer.requiredNodes);
+  initPathBuffer(&buffer, nodes, buffer.requiredNodes, NULL, 0, NULL, 0);
+  assert(samePath(feasible, getFeasiblePathInto(getPathNode(expected), list, &buffer)));
+
+  deleteCDG(feasible);
+  for ( path = expected; path; path = getNextPath(path) ) deleteCDG(getPathNode(path));
+  while ( expected ) {
+    path = getNextPath(expected);
+    free(expected);
+    expected = path;
+  }
+  deleteCDG(before);
+  deleteCDG(big);
+}
+
+void tHitScoring() {
+  CDGHitCounts* hits = newHitCounts(2);
+  int i;
+  for ( i = 0; i < 300; i++ ) recordHit(hits, 2, 0);
+  for ( i = 0; i < 5; i++ ) recordHit(hits, 1, 1);
+  assert(255 == getHitCount(hits, 2, 0) && 8 == getHitBucket(hits, 2, 0));
+  assert(5 == getHitCount(hits, 1, 1) && 4 == getHitBucket(hits, 1, 1));
+  assert(0 == getHitBucket(hits, 2, 1));
+  clearHitCounts(hits);
+
+  CDGNode* cdg = newDecision(0, newDecision(1, newLeaf(10), newLeaf(11)), newDecision(2, newLeaf(20), newLeaf(21)));
+  updateCDG(cdg);
+  assert(2 == getScore(cdg) && 1 == getOutcome(cdg));
+
+  CDGScoring scoring = { hits, NULL };
+  updateCDGWith(cdg, &scoring);
+  assert(2 * CDG_HIT_BUCKETS == getScore(cdg) && 1 == getOutcome(cdg));
+  CDGNode* covered[2];
+  covered[0] = newNode(0, 0, 1, NULL, NULL, NULL, NULL, NULL);
+  covered[1] = newNode(1, 0, 1, NULL, NULL, NULL, NULL, NULL);
+  for ( i = 0; i < 4; i++ ) coverNodesWith(cdg, covered, 2, &scoring);
+  assert(4 == getHitCount(hits, 0, 1) && 4 == getHitCount(hits, 1, 1));
+  assert(0 == getOutcome(cdg) && 2 * CDG_HIT_BUCKETS == getScore(cdg));
+  assert(CDG_HIT_BUCKETS == getScore(getTrueNodeSet(cdg)));
+  assert(0 == getOutcome(getTrueNodeSet(cdg)));
+  CDGPath* paths = getTopPathsWith(cdg, 1, &scoring);
+  assert(0 == getOutcome(getPathNode(paths)) && 2 == getID(getFalseNodeSet(getPathNode(paths))));
+
+  updateCDG(cdg);
+  assert(2 == getScore(cdg) && 1 == getOutcome(cdg));
+  deleteCDG(getPathNode(paths));
+  free(paths);
+
+  /* Handles count the hits of the coverage they ingest, each with its own counters */
+  CDG* handle = cdgNew(newDecision(0, newDecision(1, newLeaf(10), newLeaf(11)), newDecision(2, newLeaf(20), newLeaf(21))));
+  CDG* plain = cdgNew(newDecision(0, newDecision(1, newLeaf(10), newLeaf(11)), newDecision(2, newLeaf(20), newLeaf(21))));
+  cdgSetHitCounts(handle, newHitCounts(2));
+  assert(2 * CDG_HIT_BUCKETS == getScore(cdgRoot(handle)) && 2 == getScore(cdgRoot(plain)));
+  for ( i = 0; i < 4; i++ ) cdgCoverNodes(handle, covered, 2);
+  assert(4 == getHitCount(cdgGetHitCounts(handle), 0, 1) && 4 == getHitCount(cdgGetHitCounts(handle), 1, 1));
+  assert(0 == getOutcome(cdgRoot(handle)) && 2 * CDG_HIT_BUCKETS == getScore(cdgRoot(handle)));
+  assert(0 == getOutcome(getTrueNodeSet(cdgRoot(handle))));
+  cdgCoverNodes(plain, covered, 2);
+  assert(NULL == cdgGetHitCounts(plain) && 1 == getOutcome(cdgRoot(plain)));
+  cdgDelete(handle);
+  cdgDelete(plain);
+  deleteNode(covered[0]);
+  deleteNode(covered[1]);
+  deleteHitCounts(hits);
+  deleteCDG(cdg);
+}
+
+int inNodeList(CDGNode* node, int id) {
+  for ( ; node; node = getNextNode(node) ) {
+    if ( id == getID(node) ) return 1;
+  }
+  return 0;
+}
+
+/* Checks that every step of a directed path leads to the next one and the last to the target */
+
+int leadsTo(CDG* cdg, CDGNode* path, int target) {
+  CDGNode* node;
+  CDGNode* next;
+  int depth = 0;
+  for ( ; path; path = next, depth++ ) {
+    if ( getNextNode(path) ) return -1;
+    node = cdgFindNode(cdg, getID(path));
+    next = getOutcome(path) ? getTrueNodeSet(path) : getFalseNodeSet(path);
+    if ( !inNodeList(getOutcome(path) ? getTrueNodeSet(node) : getFalseNodeSet(node), next ? getID(next) : target) ) return -1;
+  }
+  return depth;
+}
+
+void tDirectedPath() {
+  CDG* cdg = cdgNew(buildRandomCDG(2000, 17));
+  int i, depth;
+  for ( i = 0; i < 2000; i += 37 ) {
+    assert(findNode(cdgRoot(cdg), i) == cdgFindNode(cdg, i));
+  }
+  assert(NULL == cdgFindNode(cdg, 5000));
+  assert(NULL == cdgGetDirectedPath(cdg, 5000, 0));
+  assert(NULL == cdgGetDirectedPath(cdg, 0, 0));
+
+  CDGNode* target = cdgFindNode(cdg, 1999);
+  CDGNode* node;
+  for ( depth = 0, node = getParent(target); node; node = getParent(node) ) depth++;
+  CDGNode* path = cdgGetDirectedPath(cdg, 1999, 0);
+  assert(depth == leadsTo(cdg, path, 1999));
+  deleteCDG(path);
+
+  for ( target = cdgFindNode(cdg, 1); isLeaf(target); target = getParent(target) );
+  CDGTransaction* txn = beginTransaction();
+  CDGNode* below = getTopPath(getOutcome(target) ? getTrueNodeSet(target) : getFalseNodeSet(target), txn);
+  rollbackTransaction(txn);
+  path = cdgGetDirectedPath(cdg, getID(target), 1);
+  for ( node = path; getID(node) != getID(target); node = getOutcome(node) ? getTrueNodeSet(node) : getFalseNodeSet(node) );
+  assert(getOutcome(node) == getOutcome(target));
+  assert(samePath(below, getOutcome(node) ? getTrueNodeSet(node) : getFalseNodeSet(node)));
+  deleteCDG(below);
+  deleteCDG(path);
+
+  node = newNode(4000, 1, 1, NULL, NULL, NULL, NULL, NULL);
+  cdgAddFalseNode(cdg, target, node);
+  assert(node == cdgFindNode(cdg, 4000));
+  path = cdgGetDirectedPath(cdg, 4000, 0);
+  assert(0 < leadsTo(cdg, path, 4000));
+  deleteCDG(path);
+  cdgDelete(cdg);
+}
+
+int pathHasBranch(CDGNode* path, int id, int outcome) {
+  for ( ; path; path = getNextNode(path) ) {
+    if ( id == getID(path) && (0 != outcome) == (0 != getOutcome(path)) ) return 1;
+    if ( pathHasBranch(getTrueNodeSet(path), id, outcome) ) return 1;
+    if ( pathHasBranch(getFalseNodeSet(path), id, outcome) ) return 1;
+  }
+  return 0;
+}
+
+/* Returns the number of paths taking every branch of a core */
+
+int countCorePaths(CDGPath* paths, CDGNode* core[], int size) {
+  int count = 0, i;
+  for ( ; paths; paths = getNextPath(paths) ) {
+    for ( i = 0; i < size && pathHasBranch(getPathNode(paths), getID(core[i]), getOutcome(core[i])); i++ );
+    if ( i == size ) count++;
+  }
+  return count;
+}
+
+void tInfeasibleCores() {
+  CDGNode* root = updateCDG(buildRandomCDG(2000, 23));
+  int before = getConditionalNodeSum(root);
+  CDGPath* paths = getTopPaths(root, 1);
+  CDGNode* outer = getPathNode(paths);
+  while ( NULL == (getOutcome(outer) ? getTrueNodeSet(outer) : getFalseNodeSet(outer)) ) outer = getNextNode(outer);
+  CDGNode* inner = getOutcome(outer) ? getTrueNodeSet(outer) : getFalseNodeSet(outer);
+  CDGNode* other = getNextNode(outer) ? getNextNode(outer) : getPathNode(paths);
+  assert(other != outer);
+  CDGNode* single[1] = { newNode(getID(inner), 0, getOutcome(inner), NULL, NULL, NULL, NULL, NULL) };
+  CDGNode* pair[2] = { newNode(getID(outer), 0, getOutcome(outer), NULL, NULL, NULL, NULL, NULL),
+                       newNode(getID(other), 0, getOutcome(other), NULL, NULL, NULL, NULL, NULL) };
+  CDGNode* implied[2] = { single[0], pair[1] };
+  CDGPath* top = paths;
+
+  CDGCores* cores = newInfeasibleCores();
+  assert(1 == addInfeasibleCore(cores, single, 1));
+  assert(1 == addInfeasibleCore(cores, pair, 2));
+  assert(0 == addInfeasibleCore(cores, implied, 2));
+  assert(0 == addInfeasibleCore(cores, pair, 2));
+  assert(2 == getInfeasibleCoreCount(cores));
+  CDGScoring scoring = { NULL, cores };
+  updateCDGWith(root, &scoring);
+  assert(getConditionalNodeSum(root) <= before);
+  assert(isBranchBlocked(cores, findNode(root, getID(inner)), getOutcome(inner)));
+  assert(!isBranchBlocked(cores, findNode(root, getID(outer)), getOutcome(outer)));
+  deletePaths(top);
+  paths = getTopPathsWith(root, 20, &scoring);
+  assert(NULL != paths);
+  assert(0 == countCorePaths(paths, single, 1));
+  assert(0 == countCorePaths(paths, pair, 2));
+  deletePaths(paths);
+  deleteInfeasibleCores(cores);
+  updateCDG(root);
+  assert(getConditionalNodeSum(root) == before);
+  deleteCDG(root);
+
+  CDG* cdg = cdgNew(buildRandomCDG(2000, 23));
+  unsigned long epoch = cdgEpoch(cdg);
+  assert(1 == cdgAddInfeasibleCore(cdg, pair, 2));
+  assert(0 == cdgAddInfeasibleCore(cdg, pair, 2));
+  assert(epoch < cdgEpoch(cdg));
+  CDGPathSet* set = cdgGetTopPaths(cdg, 20);
+  assert(0 == countCorePaths(getPathSetPaths(set), pair, 2));
+  releasePathSet(set);
+
+  /* The cores of another handle leave this one alone */
+  CDG* second = cdgNew(buildRandomCDG(2000, 23));
+  assert(1 == cdgAddInfeasibleCore(second, single, 1));
+  int sum = getConditionalNodeSum(cdgRoot(cdg));
+  cdgTouch(cdg);
+  updateCDGWith(cdgRoot(cdg), &cdg->scoring);
+  assert(sum == getConditionalNodeSum(cdgRoot(cdg)));
+  assert(getConditionalNodeSum(cdgRoot(second)) < before);
+  assert(!isBranchBlocked(cdg->scoring.cores, findNode(cdgRoot(cdg), getID(single[0])), getOutcome(single[0])));
+  set = cdgGetTopPaths(second, 20);
+  assert(0 == countCorePaths(getPathSetPaths(set), single, 1));
+  releasePathSet(set);
+  cdgDelete(second);
+  cdgDelete(cdg);
+  deleteNode(single[0]);
+  deleteNode(pair[0]);
+  deleteNode(pair[1]);
+
+  /* The branch left when a core blocks the only productive one has nothing to cover */
+  CDGNode* decision = newNode(1, 0, 1, NULL, NULL, NULL, NULL, NULL);
+  CDGNode* nested = newNode(2, 0, 1, NULL, NULL, NULL, NULL, NULL);
+  addTrueNode(nested, newNode(3, 1, 1, NULL, NULL, NULL, NULL, NULL));
+  addFalseNode(nested, newNode(4, 1, 1, NULL, NULL, NULL, NULL, NULL));
+  addTrueNode(decision, nested);
+  addFalseNode(decision, newNode(5, 0, 1, NULL, NULL, NULL, NULL, NULL));
+  cdg = cdgNew(decision);
+  assert(0 < getScore(cdgRoot(cdg)));
+  CDGNode* blocked = newNode(1, 0, 1, NULL, NULL, NULL, NULL, NULL);
+  assert(1 == cdgAddInfeasibleCore(cdg, &blocked, 1));
+  assert(0 == getScore(cdgRoot(cdg)));
+  set = cdgGetTopPaths(cdg, 3);
+  assert(NULL == getPathSetPaths(set));
+  releasePathSet(set);
+  cdgDelete(cdg);
+  deleteNode(blocked);
+}
+
+void tDistinctPaths() {
+  CDGNode* root = updateCDG(buildRandomCDG(2000, 29));
+  CDGPath* expected = getTopPaths(root, 10);
+  CDGPath* sixth = expected;
+  unsigned long long fingerprint;
+  int i;
+  for ( i = 0; i < 5; i++ ) sixth = getNextPath(sixth);
+
+  CDGTransaction* txn = beginTransaction();
+  CDGNode* path = getTopPathFingerprint(root, txn, &fingerprint);
+  rollbackTransaction(txn);
+  assert(samePath(getPathNode(expected), path));
+  assert(fingerprint == getPathFingerprint(path));
+  assert(fingerprint != getPathFingerprint(getPathNode(sixth)));
+  deleteCDG(path);
+
+  CDGSeenSet* seen = newSeenSet();
+  CDGPath* first = getDistinctTopPaths(root, 5, seen);
+  CDGPath* second = getDistinctTopPaths(root, 5, seen);
+  CDGPath* a = expected;
+  CDGPath* b = first;
+  for ( i = 0; i < 5; i++, a = getNextPath(a), b = getNextPath(b) ) {
+    assert(samePath(getPathNode(a), getPathNode(b)));
+    assert(hasSeenPath(seen, getPathFingerprint(getPathNode(b))));
+  }
+  assert(NULL == b);
+  for ( b = second; a; a = getNextPath(a), b = getNextPath(b) ) {
+    assert(samePath(getPathNode(a), getPathNode(b)));
+  }
+  assert(NULL == b);
+  assert(10 == getSeenCount(seen));
+  assert(!addSeenPath(seen, getPathFingerprint(getPathNode(sixth))));
+  clearSeenSet(seen);
+  assert(0 == getSeenCount(seen) && !hasSeenPath(seen, getPathFingerprint(getPathNode(sixth))));
+  assert(addSeenPath(seen, 0) && !addSeenPath(seen, 0) && hasSeenPath(seen, 0));
+  deleteSeenSet(seen);
+  deletePaths(first);
+  deletePaths(second);
+
+  CDG* cdg = cdgNew(root);
+  CDGPathSet* once = cdgGetDistinctTopPaths(cdg, 5);
+  CDGPathSet* twice = cdgGetDistinctTopPaths(cdg, 5);
+  assert(samePath(getPathNode(sixth), getPathNode(getPathSetPaths(twice))));
+  cdgClearSeenPaths(cdg);
+  CDGPathSet* again = cdgGetDistinctTopPaths(cdg, 5);
+  assert(samePath(getPathNode(getPathSetPaths(once)), getPathNode(getPathSetPaths(again))));
+  releasePathSet(once);
+  releasePathSet(twice);
+  releasePathSet(again);
+  deletePaths(expected);
+  cdgDelete(cdg);
+}
+
+/* Attaches blank dummy leaves the way addDummyNodes used to */
+
+void addBlankDummies(CDGNode* node) {
+  while ( node ) {
+    if ( !isLeaf(node) ) {
+      if ( NULL == getTrueNodeSet(node) ) {
+        addTrueNode(node, newBlankNode());
+      } else if ( NULL == getFalseNodeSet(node) ) {
+        addFalseNode(node, newBlankNode());
+      }
+    }
+    addBlankDummies(getTrueNodeSet(node));
+    addBlankDummies(getFalseNodeSet(node));
+    node = getNextNode(node);
+  }
+}
+
+/* Compares the scores of a CDG with implicit blocks to the same CDG with blank dummies */
+
+int sameAsBlank(CDGNode* implicit, CDGNode* blank) {
+  while ( 1 ) {
+    while ( blank && -1 == getID(blank) ) blank = getNextNode(blank);
+    if ( NULL == implicit || NULL == blank ) return implicit == blank;
+    if ( getID(implicit) != getID(blank) || getScore(implicit) != getScore(blank) ) return 0;
+    if ( getOutcome(implicit) != getOutcome(blank) ) return 0;
+    if ( !sameAsBlank(getTrueNodeSet(implicit), getTrueNodeSet(blank)) ) return 0;
+    if ( !sameAsBlank(getFalseNodeSet(implicit), getFalseNodeSet(blank)) ) return 0;
+    implicit = getNextNode(implicit);
+    blank = getNextNode(blank);
+  }
+}
+
+int countImplicit(CDGNode* node) {
+  int count = 0;
+  for ( ; node; node = getNextNode(node) ) {
+    count += (getFlags(node) & CDG_IMPLICIT_TRUE) + (getFlags(node) >> 1);
+    count += countImplicit(getTrueNodeSet(node)) + countImplicit(getFalseNodeSet(node));
+  }
+  return count;
+}
+
+void tImplicitBranches() {
+  int kernels[3] = {CDG_KERNEL_SCALAR, CDG_KERNEL_SSE2, CDG_KERNEL_AVX2};
+  CDGNode* implicit = buildRandomCDG(3000, 31);
+  CDGNode* blank = buildRandomCDG(3000, 31);
+  CDGNode nodes[4096];
+  CDGNode* heads[4];
+  CDGUndoEntry undo[4096];
+  CDGPathBuffer buffer;
+  CDGPath* expected;
+  CDGPath* actual;
+  CDGPath* path;
+  CDGPath* other;
+  int i, implicitCnt;
+  addDummyNodes(implicit);
+  addBlankDummies(blank);
+  implicitCnt = countImplicit(implicit);
+  assert(0 < implicitCnt);
+  assert(getPathLength(implicit) + implicitCnt == getPathLength(blank));
+
+  CDGLevelGraph* graph = newLevelGraph(implicit);
+  for ( i = 0; i < 3; i++ ) {
+    setLevelKernel(kernels[i]);
+    updateCDGLevels(graph);
+    updateCDG(blank);
+    assert(sameAsBlank(implicit, blank));
+    coverRandomLeaves(implicit, 5 + i);
+    coverRandomLeaves(blank, 5 + i);
+  }
+  setLevelKernel(CDG_KERNEL_AUTO);
+  deleteLevelGraph(graph);
+  updateCDG(implicit);
+  updateCDG(blank);
+
+  CDGNode* covered[3];
+  CDGNode* node;
+  int id, size = 0;
+  implicitCnt = countImplicit(implicit);
+  for ( id = 0; size < 3; id++ ) {
+    node = findNode(implicit, id);
+    if ( 0 == getFlags(node) ) continue;
+    covered[size++] = newNode(id, 0, getFlags(node) & CDG_IMPLICIT_TRUE, NULL, NULL, NULL, NULL, NULL);
+  }
+  coverNodes(blank, covered, 3);
+  assert(0 < coverNodesWithChanges(implicit, covered, 3, NULL, 0, NULL));
+  assert(sameAsBlank(implicit, blank));
+  assert(implicitCnt - 3 == countImplicit(implicit));
+  implicitCnt -= 3;
+
+  expected = getTopPaths(blank, 10);
+  actual = getTopPaths(implicit, 10);
+  assert(implicitCnt == countImplicit(implicit));
+  assert(sameAsBlank(implicit, blank));
+  for ( path = expected, other = actual; path; path = getNextPath(path), other = getNextPath(other) ) {
+    assert(samePath(getPathNode(path), getPathNode(other)));
+  }
+  assert(NULL == other);
+  deletePaths(actual);
+
+  CDGStealPool* pool = newStealPool(4);
+  actual = getTopPathsParallel(pool, implicit, 10);
+  for ( path = expected, other = actual; path; path = getNextPath(path), other = getNextPath(other) ) {
+    assert(samePath(getPathNode(path), getPathNode(other)));
+  }
+  deletePaths(actual);
+  deleteStealPool(pool);
+
+  initPathBuffer(&buffer, nodes, 4096, heads, 4, undo, 4096);
+  assert(4 == getTopPathsInto(implicit, 4, &buffer));
+  for ( path = expected, i = 0; i < 4; path = getNextPath(path), i++ ) {
+    assert(samePath(getPathNode(path), heads[i]));
+  }
+  assert(implicitCnt == countImplicit(implicit));
+  assert(sameAsBlank(implicit, blank));
+
+  CDGNode* compact = compactCDG(implicit);
+  assert(implicitCnt == countImplicit(compact));
+  actual = getTopPaths(compact, 10);
+  for ( path = expected, other = actual; path; path = getNextPath(path), other = getNextPath(other) ) {
+    assert(samePath(getPathNode(path), getPathNode(other)));
+  }
+  deletePaths(actual);
+  deleteCDG(compact);
+  deletePaths(expected);
+  for ( i = 0; i < 3; i++ ) deleteNode(covered[i]);
+  deleteCDG(implicit);
+  deleteCDG(blank);
+}
+
+/* Returns 1 if the id index of a handle agrees with findNode on ids from 0 to size */
+
+int sameIndex(CDG* cdg, int size) {
+  int id;
+  for ( id = 0; id < size; id++ ) {
+    if ( cdgFindNode(cdg, id) != findNode(cdgRoot(cdg), id) ) return 0;
+  }
+  return 1;
+}
+
+/* Removes a node with a parent from a copy of a CDG the slow way, rescoring it all */
+
+void removeAndUpdate(CDGNode* root, CDGNode* node) {
+  CDGNode* parent = getParent(node);
+  CDGNode* set = getTrueNodeSet(parent);
+  CDGNode* prev;
+  int inTrue = 0;
+  for ( prev = set; prev; prev = getNextNode(prev) ) inTrue |= node == prev;
+  if ( !inTrue ) set = getFalseNodeSet(parent);
+  if ( node == set ) {
+    set = getNextNode(node);
+  } else {
+    for ( prev = set; node != getNextNode(prev); prev = getNextNode(prev) );
+    setNextNode(prev, getNextNode(node));
+  }
+  if ( inTrue ) {
+    setTrueNodeSet(parent, set);
+  } else {
+    setFalseNodeSet(parent, set);
+  }
+  if ( isLeaf(parent) ) {
+    setFlags(parent, 0);
+    setScore(parent, 1);
+  } else if ( NULL == set ) {
+    setFlags(parent, getFlags(parent) | CDG_IMPLICIT(inTrue));
+  }
+  setNextNode(node, NULL);
+  deleteCDG(node);
+  updateCDG(root);
+}
+
+CDGNode* newAddedCDG(int i) {
+  return newDecision(1000 + i, newLeaf(2000 + i), newDecision(3000 + i, newLeaf(4000 + i), NULL));
+}
+
+void tIncrementalStructure() {
+  CDG* cdg = cdgNew(buildRandomCDG(400, 17));
+  CDGNode* expected = buildRandomCDG(400, 17);
+  CDGNode* node;
+  CDGPathSet* set;
+  int i, id, removed = 0, added = 0;
+  coverRandomLeaves(cdgRoot(cdg), 3);
+  coverRandomLeaves(expected, 3);
+  updateCDG(cdgRoot(cdg));
+  updateCDG(expected);
+  cdgTouch(cdg);
+  assert(sameIndex(cdg, 400));
+
+  for ( i = 0; i < 150; i++ ) {
+    id = (i * 37) % 400;
+    node = cdgFindNode(cdg, id);
+    if ( NULL == node ) continue;
+    set = cdgGetTopPaths(cdg, 3);
+    if ( 0 == i % 3 && getParent(node) ) {
+      cdgRemoveNode(cdg, node);
+      removeAndUpdate(expected, findNode(expected, id));
+      assert(NULL == cdgFindNode(cdg, id));
+      removed++;
+    } else {
+      if ( i % 2 ) {
+        cdgAddTrueNode(cdg, node, newAddedCDG(i));
+        addTrueNode(findNode(expected, id), newAddedCDG(i));
+      } else {
+        cdgAddFalseNode(cdg, node, newAddedCDG(i));
+        addFalseNode(findNode(expected, id), newAddedCDG(i));
+      }
+      updateCDG(expected);
+      assert(cdgFindNode(cdg, 1000 + i) == findNode(cdgRoot(cdg), 1000 + i));
+      added++;
+    }
+    assert(sameCDG(expected, cdgRoot(cdg)));
+    assert(set != cdg->topPaths);
+    releasePathSet(set);
+  }
+  assert(0 < removed && 0 < added);
+  assert(sameIndex(cdg, 400));
+
+  /* A node sharing an id takes over the index slot once the indexed one is removed */
+  cdgAddTrueNode(cdg, cdgRoot(cdg), newDecision(5000, newLeaf(5001), NULL));
+  node = cdgFindNode(cdg, 5001);
+  cdgAddFalseNode(cdg, cdgFindNode(cdg, 5000), newLeaf(5001));
+  assert(node == cdgFindNode(cdg, 5001) && 1 == cdg->index->shadowed);
+  cdgRemoveNode(cdg, node);
+  assert(NULL == cdg->index);
+  node = cdgFindNode(cdg, 5001);
+  assert(NULL != node && getFalseNodeSet(cdgFindNode(cdg, 5000)) == node);
+  cdgRemoveNode(cdg, node);
+  assert(isLeaf(cdgFindNode(cdg, 5000)) && 0 == cdg->index->shadowed);
+  assert(1 == getScore(cdgFindNode(cdg, 5000)) && 0 == getFlags(cdgFindNode(cdg, 5000)));
+
+  /* Emptying one side of a decision leaves an uncovered implicit block there */
+  cdgAddTrueNode(cdg, cdgRoot(cdg), newDecision(6000, newLeaf(6001), newLeaf(6002)));
+  setScore(cdgFindNode(cdg, 6001), 0);
+  setScore(cdgFindNode(cdg, 6002), 0);
+  cdgRemoveNode(cdg, cdgFindNode(cdg, 6001));
+  node = cdgFindNode(cdg, 6000);
+  assert(CDG_IMPLICIT_TRUE == getFlags(node) && 0 < getScore(node));
+  cdgRemoveNode(cdg, cdgFindNode(cdg, 6002));
+  assert(isLeaf(node) && 1 == getScore(node) && 0 == getFlags(node));
+
+  deleteCDG(expected);
+  cdgDelete(cdg);
+}
+
+void tTraceReplay() {
+  CDGNode* cdg = buildRandomCDG(300, 23);
+  CDGNode* covered[4];
+  CDGNode* list;
+  CDGNode* feasible;
+  CDGPath* paths;
+  CDGPath* kept;
+  FILE* file = tmpfile();
+  int ids[2], i, step;
+  assert(NULL != file);
+  for ( i = 0; i < 4; i++ ) covered[i] = newBlankNode();
+  CDGTraceRecorder* rec = newTraceRecorder(file);
+  setTraceRecorder(rec);
+  kept = getTopPaths(cdg, 2);
+  for ( step = 0; step < 20; step++ ) {
+    for ( i = 0; i < 4; i++ ) {
+      setID(covered[i], (step * 31 + i * 7) % 300);
+      setOutcome(covered[i], step % 2);
+    }
+    if ( step % 2 ) {
+      coverNodes(cdg, covered, 4);
+    } else {
+      coverNodesWithChanges(cdg, covered, 4, NULL, 0, NULL);
+    }
+    paths = getTopPaths(cdg, 3);
+    ids[0] = getID(getPathNode(paths));
+    ids[1] = getID(getPathNode(kept));
+    list = newIdList(ids, 2);
+    feasible = getFeasiblePath(getPathNode(paths), list);
+    deleteCDG(feasible);
+    feasible = getFeasiblePath(getPathNode(kept), list);
+    deleteCDG(feasible);
+    deleteCDG(list);
+    deletePaths(paths);
+  }
+  deletePaths(kept);
+  setTraceRecorder(NULL);
+  deletePaths(getTopPaths(cdg, 1));
+  assert(1 + 1 + 20 * 5 + 1 == rec->records);
+  deleteTraceRecorder(rec);
+
+  long size = ftell(file);
+  unsigned char* data = (unsigned char*)malloc(size);
+  rewind(file);
+  assert((size_t)size == fread(data, 1, size, file));
+  fclose(file);
+  CDGTraceStats* stats = newTraceStats();
+  assert(replayTrace(data, size, stats));
+  assert(20 == stats->counts[CDG_TRACE_COVER] && 21 == stats->counts[CDG_TRACE_TOP_PATHS]);
+  assert(40 == stats->counts[CDG_TRACE_FEASIBLE] && 21 == stats->counts[CDG_TRACE_DELETE]);
+  assert(0 == stats->divergences);
+  assert(getTraceLatency(stats, CDG_TRACE_COVER, 50) <= getTraceLatency(stats, CDG_TRACE_COVER, 99));
+  deleteTraceStats(stats);
+
+  /* A truncated trace replays the records before the cut */
+  stats = newTraceStats();
+  assert(!replayTrace(data, size - 1, stats));
+  assert(20 == stats->counts[CDG_TRACE_COVER] && 20 == stats->counts[CDG_TRACE_DELETE]);
+  deleteTraceStats(stats);
+
+  free(data);
+
+  /* Structural changes through a handle are recorded again and deleted roots are forgotten */
+  file = tmpfile();
+  assert(NULL != file);
+  rec = newTraceRecorder(file);
+  setTraceRecorder(rec);
+  CDG* handle = cdgNew(buildRandomCDG(50, 5));
+  CDGNode* added = newNode(50, 1, 1, NULL, NULL, NULL, NULL, NULL);
+  CDGPathSet* set;
+  unsigned long records;
+  for ( step = 0; step < 3; step++ ) {
+    cdgTouch(handle);
+    records = rec->records;
+    if ( 1 == step ) cdgAddTrueNode(handle, cdgRoot(handle), added);
+    if ( 2 == step ) cdgRemoveNode(handle, added);
+    assert(records + (0 < step) == rec->records);
+    for ( i = 0; i < 4; i++ ) {
+      setID(covered[i], (step * 13 + i * 5) % 50);
+      setOutcome(covered[i], step % 2);
+    }
+    cdgCoverNodes(handle, covered, 4);
+    set = cdgGetTopPaths(handle, 3);
+    releasePathSet(set);
+  }
+  cdgDelete(handle);
+  for ( i = 0; i < rec->rootCnt; i++ ) assert(NULL == rec->roots[i].ptr);
+  setTraceRecorder(NULL);
+  deleteTraceRecorder(rec);
+
+  size = ftell(file);
+  data = (unsigned char*)malloc(size);
+  rewind(file);
+  assert((size_t)size == fread(data, 1, size, file));
+  fclose(file);
+  stats = newTraceStats();
+  assert(replayTrace(data, size, stats));
+  assert(3 == stats->counts[CDG_TRACE_COVER] && 0 == stats->divergences);
+  deleteTraceStats(stats);
+  free(data);
+
+  for ( i = 0; i < 4; i++ ) deleteNode(covered[i]);
+  deleteCDG(cdg);
+}
+
+/* An expanded macro: the same decisions and predicates with ids from base on */
+
+CDGNode* newMacroCDG(int base) {
+  char expr[32];
+  CDGNode* n[6];
+  int i;
+  for ( i = 0; i < 6; i++ ) {
+    sprintf(expr, "(m %d)", i);
+    n[i] = newNode(base + i, 1, 1, expr, NULL, NULL, NULL, NULL);
+  }
+  addTrueNode(n[0], n[1]);
+  addTrueNode(n[0], n[2]);
+  addTrueNode(n[2], n[3]);
+  addTrueNode(n[2], n[4]);
+  addFalseNode(n[0], n[5]);
+  return n[0];
+}
+
+CDGNode* newMacroUser(int instances) {
+  CDGNode* root = newNode(0, 1, 1, "(r)", NULL, NULL, NULL, NULL);
+  int i;
+  for ( i = 0; i < instances; i++ ) {
+    if ( i % 2 ) {
+      addTrueNode(root, newMacroCDG(1 + 6 * i));
+    } else {
+      addFalseNode(root, newMacroCDG(1 + 6 * i));
+    }
+  }
+  addDummyNodes(root);
+  return root;
+}
+
+void tSharedShapes() {
+  CDGNode* root = newMacroUser(60);
+  CDGNode* expected = newMacroUser(60);
+  CDGSharing* sharing = hashConsCDG(root, 6 * 60);
+  int i;
+  assert(7 == getShapeCount(sharing));
+  assert(60 == getShapeInstances(sharing, getShape(sharing, 1)));
+  assert(getShape(sharing, 1) == getShape(sharing, 1 + 6 * 59));
+  assert(getShape(sharing, 3) != getShape(sharing, 4));
+  assert(0 == strcmp("(m 2)", getShapeExpr(sharing, getShape(sharing, 6 * 7 + 3))));
+  assert(-1 == getShape(sharing, 6 * 60 + 1));
+
+  updateSharedCDG(sharing, root, NULL);
+  updateCDG(expected);
+  assert(sameCDG(expected, root));
+  assert(0 < sharing->reused);
+
+  /* Instances with covered leaves get scored on their own */
+  for ( i = 0; i < 60; i += 7 ) {
+    setScore(findNode(root, 1 + 6 * i + 3), 0);
+    setScore(findNode(expected, 1 + 6 * i + 3), 0);
+    if ( i % 3 ) continue;
+    setFlags(findNode(root, 1 + 6 * i + 2), 0);
+    setFlags(findNode(expected, 1 + 6 * i + 2), 0);
+  }
+  updateSharedCDG(sharing, root, NULL);
+  updateCDG(expected);
+  assert(sameCDG(expected, root));
+  assert(0 < sharing->reused);
+  deleteSharing(sharing);
+  deleteCDG(expected);
+  deleteCDG(root);
+
+  root = buildRandomCDG(500, 29);
+  expected = buildRandomCDG(500, 29);
+  sharing = hashConsCDG(root, 499);
+  assert(getShapeCount(sharing) < 500);
+  coverRandomLeaves(root, 4);
+  coverRandomLeaves(expected, 4);
+  updateSharedCDG(sharing, root, NULL);
+  updateCDG(expected);
+  assert(sameCDG(expected, root));
+
+  /* Ids weigh branches under hit scoring, no scores are shared */
+  CDGHitCounts* hits = newHitCounts(499);
+  CDGNode* node = newNode(7, 0, 1, NULL, NULL, NULL, NULL, NULL);
+  recordHits(hits, &node, 1);
+  CDGScoring scoring = { hits, NULL };
+  updateSharedCDG(sharing, root, &scoring);
+  updateCDGWith(expected, &scoring);
+  assert(sameCDG(expected, root) && 0 == sharing->reused);
+  deleteHitCounts(hits);
+  deleteNode(node);
+  deleteSharing(sharing);
+  deleteCDG(expected);
+  deleteCDG(root);
+}
+
+int getPathDepth(CDGNode* path) {
+  int depth = 0, below;
+  for ( ; path; path = getNextNode(path) ) {
+    below = 1 + getPathDepth(getOutcome(path) ? getTrueNodeSet(path) : getFalseNodeSet(path));
+    if ( below > depth ) depth = below;
+  }
+  return depth;
+}
+
+int samePathLists(CDGPath* expected, CDGPath* actual) {
+  for ( ; expected && actual; expected = getNextPath(expected), actual = getNextPath(actual) ) {
+    if ( getPathFingerprint(getPathNode(expected)) != getPathFingerprint(getPathNode(actual)) ) return 0;
+  }
+  return NULL == expected && NULL == actual;
+}
+
+/* Score of the decisions of a list in a subset of ids, reached through decisions of the subset.
+   Adds their count and depth, returns -1 for decisions of the subset on both branches */
+
+int scoreSubset(CDGNode* node, int subset, int depth, int* count, int* maxDepth) {
+  int sum = 0, sums[2], outcome, score;
+  CDGNode* child;
+  for ( ; node; node = getNextNode(node) ) {
+    if ( isLeaf(node) || !(subset >> getID(node) & 1) ) continue;
+    (*count)++;
+    if ( depth > *maxDepth ) *maxDepth = depth;
+    for ( outcome = 0; outcome < 2; outcome++ ) {
+      child = outcome ? getTrueNodeSet(node) : getFalseNodeSet(node);
+      sums[outcome] = scoreSubset(child, subset, depth + 1, count, maxDepth);
+      if ( 0 > sums[outcome] ) return -1;
+    }
+    if ( 0 < sums[0] && 0 < sums[1] ) return -1;
+    for ( outcome = 0, score = 0; outcome < 2; outcome++ ) {
+      if ( 0 < sums[outcome] ) score = sums[outcome] + 1;
+      else if ( 0 == sums[!outcome] && hasUncoveredChild(node, outcome) && 1 > score ) score = 1;
+    }
+    sum += score;
+  }
+  return sum;
+}
+
+void tBudgetedPaths() {
+  CDGNode* root = updateCDG(buildRandomCDG(2000, 31));
+  CDGPath* expected = getTopPaths(root, 5);
+  CDGPath* actual = getTopPathsWithinLength(root, 5, 1 << 30);
+  CDGPath* paths;
+  CDGTransaction* txn;
+  int length, depth, score, last, seed, subset, count, maxDepth;
+  int bestByLength[17], bestByDepth[17];
+  assert(samePathLists(expected, actual));
+  deletePaths(actual);
+  actual = getTopPathsWithinDepth(root, 5, 1 << 30);
+  assert(samePathLists(expected, actual));
+  deletePaths(actual);
+  length = getPathLength(getPathNode(expected));
+  depth = getPathDepth(getPathNode(expected));
+  assert(getConditionalNodeSum(root) == getScoreWithinLength(root, length));
+  assert(getConditionalNodeSum(root) == getScoreWithinDepth(root, depth));
+  assert(getConditionalNodeSum(root) > getScoreWithinDepth(root, depth - 1));
+  deletePaths(expected);
+
+  /* Scores grow with the budget and paths stay within it */
+  for ( last = 0, length = 0; length <= 40; length++ ) {
+    score = getScoreWithinLength(root, length);
+    assert(last <= score);
+    last = score;
+    paths = getTopPathsWithinLength(root, 3, length);
+    for ( actual = paths; actual; actual = getNextPath(actual) ) {
+      assert(getPathLength(getPathNode(actual)) <= length);
+    }
+    if ( paths ) deletePaths(paths);
+  }
+  for ( last = 0, depth = 0; depth <= 8; depth++ ) {
+    score = getScoreWithinDepth(root, depth);
+    assert(last <= score);
+    last = score;
+    paths = getTopPathsWithinDepth(root, 3, depth);
+    for ( actual = paths; actual; actual = getNextPath(actual) ) {
+      assert(getPathDepth(getPathNode(actual)) <= depth);
+    }
+    if ( paths ) deletePaths(paths);
+  }
+  assert(getConditionalNodeSum(root) == getScoreWithinLength(root, 1 << 30));
+
+  /* Tables kept across the paths of a call match tables built again for each path */
+  for ( length = 1; length <= 64; length *= 4 ) {
+    for ( depth = 0; depth < 2; depth++ ) {
+      paths = depth ? getTopPathsWithinDepth(root, 6, length / 4 + 2) : getTopPathsWithinLength(root, 6, length);
+      txn = beginTransaction();
+      for ( actual = paths; actual; actual = getNextPath(actual) ) {
+        expected = setPathNode(newPath(), depth ? getTopPathWithinDepth(root, txn, length / 4 + 2)
+                                                : getTopPathWithinLength(root, txn, length));
+        assert(NULL != getPathNode(expected));
+        assert(getPathFingerprint(getPathNode(expected)) == getPathFingerprint(getPathNode(actual)));
+        deletePaths(expected);
+      }
+      rollbackTransaction(txn);
+      if ( paths ) deletePaths(paths);
+    }
+  }
+  deleteCDG(root);
+
+  /* Against every subset of decisions of small CDGs */
+  for ( seed = 1; seed <= 6; seed++ ) {
+    root = updateCDG(buildRandomCDG(16, seed));
+    coverRandomLeaves(root, 3);
+    updateCDG(root);
+    for ( length = 0; length <= 16; length++ ) bestByLength[length] = bestByDepth[length] = 0;
+    for ( subset = 0; subset < 1 << 16; subset++ ) {
+      count = maxDepth = 0;
+      score = scoreSubset(root, subset, 1, &count, &maxDepth);
+      if ( score > bestByLength[count] ) bestByLength[count] = score;
+      if ( score > bestByDepth[maxDepth] ) bestByDepth[maxDepth] = score;
+    }
+    for ( length = 1; length <= 16; length++ ) {
+      if ( bestByLength[length - 1] > bestByLength[length] ) bestByLength[length] = bestByLength[length - 1];
+      if ( bestByDepth[length - 1] > bestByDepth[length] ) bestByDepth[length] = bestByDepth[length - 1];
+    }
+    for ( length = 0; length <= 16; length++ ) {
+      assert(bestByLength[length] == getScoreWithinLength(root, length));
+      assert(bestByDepth[length] == getScoreWithinDepth(root, length));
+    }
+    deleteCDG(root);
+  }
+}
+
+/* Parse callbacks counting their calls. A parsed predicate is its expr's length */
+
+int predicateCalls[2];
+
+void* parseCountedPredicate(const char* expr, void* context) {
+  int* parsed = (int*)malloc(sizeof(int));
+  *parsed = (int)strlen(expr);
+  ((int*)context)[0]++;
+  return parsed;
+}
+
+void releaseCountedPredicate(void* parsed, void* context) {
+  free(parsed);
+  ((int*)context)[1]++;
+}
+
+int sharesPredicates(CDGNode* path, CDGNode* root) {
+  for ( ; path; path = getNextNode(path) ) {
+    if ( getPredicate(path) != getPredicate(findNode(root, getID(path))) ) return 0;
+    if ( (int)strlen(getExpr(path)) != *(int*)getParsedPredicate(path) ) return 0;
+    if ( !sharesPredicates(getTrueNodeSet(path), root) ) return 0;
+    if ( !sharesPredicates(getFalseNodeSet(path), root) ) return 0;
+  }
+  return 1;
+}
+
+void tParsedPredicates() {
+  CDGNode* plain = newNode(1, 0, 1, "(p 1)", NULL, NULL, NULL, NULL);
+  assert(NULL == getPredicate(plain) && NULL == getParsedPredicate(plain));
+  CDGPredicateParser* parser = newPredicateParser(parseCountedPredicate, releaseCountedPredicate, predicateCalls);
+  setPredicateParser(parser);
+  CDGNode* root = updateCDG(buildRandomCDG(500, 37));
+  assert(50 == getPredicateCount(parser) && 50 == predicateCalls[0]);
+  assert(getPredicate(findNode(root, 3)) == getPredicate(findNode(root, 53)));
+  assert(getPredicate(findNode(root, 3)) == internPredicate(parser, "(p 3)"));
+  assert(0 == strcmp("(p 3)", getExpr(findNode(root, 53))));
+  assert(5 == *(int*)getParsedPredicate(findNode(root, 53)));
+
+  CDGPath* paths = getTopPaths(root, 4);
+  CDGPath* temp;
+  for ( temp = paths; temp; temp = getNextPath(temp) ) assert(sharesPredicates(getPathNode(temp), root));
+  int satisfied[3] = { getID(getPathNode(paths)), 0, 0 };
+  int sizes[1] = { 1 };
+  int* satisfiedIds[1] = { satisfied };
+  CDGNode* list = newNode(satisfied[0], 0, 1, NULL, NULL, NULL, NULL, NULL);
+  CDGNode* feasible = getFeasiblePath(getPathNode(paths), list);
+  CDGNode* pathNodes[1] = { getPathNode(paths) };
+  CDGFeasibleBatch* batch = getFeasiblePaths(pathNodes, satisfiedIds, sizes, 1, 1);
+  assert(NULL != feasible && sharesPredicates(feasible, root));
+  assert(sharesPredicates(getBatchPath(batch, 0), root));
+  assert(50 == predicateCalls[0]);
+
+  /* deletePaths frees the whole tree of every path, nested nodes releasing their predicates */
+  CDGNode* outer = newNode(1, 0, 1, "(p 1)", NULL, NULL, NULL, NULL);
+  setTrueNodeSet(outer, newNode(2, 0, 1, "(p 2)", NULL, NULL, NULL, NULL));
+  CDGPredicate* nested = getPredicate(getTrueNodeSet(outer));
+  int refs = nested->refs;
+  deletePaths(setPathNode(newPath(), outer));
+  assert(refs - 1 == nested->refs);
+
+  /* Predicates outlive the parser while nodes hold them */
+  setPredicateParser(NULL);
+  deletePredicateParser(parser);
+  assert(NULL == getPredicateParser() && 0 == predicateCalls[1]);
+  deleteFeasibleBatch(batch);
+  deleteCDG(feasible);
+  deleteCDG(list);
+  deletePaths(paths);
+  deleteCDG(root);
+  assert(50 == predicateCalls[1]);
+  deleteNode(plain);
+}
+
+/* Reader of a replicated graph, checking its top paths against the expected ones */
+
+typedef struct ReplicaReader {
+  CDGReplicatedGraph* graph;
+  CDGPath* expected;
+  int same;
+} ReplicaReader;
+
+void* readReplicatedPaths(void* arg) {
+  ReplicaReader* reader = (ReplicaReader*)arg;
+  CDGPath* paths;
+  int i;
+  reader->same = 1;
+  for ( i = 0; i < 20; i++ ) {
+    paths = getReplicatedTopPaths(reader->graph, 5);
+    reader->same = reader->same && samePathLists(reader->expected, paths);
+    deletePaths(paths);
+  }
+  return NULL;
+}
+
+void tReplicatedGraph() {
+  CDGNode* root = updateCDG(buildRandomCDG(3000, 41));
+  CDGNode* expected = updateCDG(buildRandomCDG(3000, 41));
+  CDGReplicatedGraph* graph = newReplicatedGraph(root, 3);
+  ReplicaReader readers[4];
+  pthread_t threads[4];
+  int i;
+  assert(3 == graph->replicaCnt);
+  assert(getLocalReplica(graph) >= graph->replicas && getLocalReplica(graph) < graph->replicas + 3);
+  for ( i = 0; i < 3; i++ ) {
+    assert(graph->replicas[i].view.score == graph->shared->score);
+    assert(graph->replicas[i].view.childStart != graph->shared->childStart);
+    assert(0 == memcmp(graph->replicas[i].view.childEnd, graph->shared->childEnd, sizeof(int) * graph->shared->size));
+  }
+  CDGPath* paths = getTopPaths(expected, 5);
+  CDGPath* actual = getReplicatedTopPaths(graph, 5);
+  assert(samePathLists(paths, actual));
+  deletePaths(actual);
+  deletePaths(paths);
+
+  coverRandomLeaves(root, 3);
+  coverRandomLeaves(expected, 3);
+  updateReplicatedCDG(graph);
+  updateCDG(expected);
+  assert(sameCDG(expected, root));
+
+  /* Concurrent readers leave the shared scores untouched */
+  paths = getTopPaths(expected, 5);
+  for ( i = 0; i < 4; i++ ) {
+    readers[i].graph = graph;
+    readers[i].expected = paths;
+    pthread_create(&threads[i], NULL, readReplicatedPaths, &readers[i]);
+  }
+  for ( i = 0; i < 4; i++ ) {
+    pthread_join(threads[i], NULL);
+    assert(readers[i].same);
+  }
+  storeLevelScores(graph->shared);
+  assert(sameCDG(expected, root));
+  deletePaths(paths);
+  deleteReplicatedGraph(graph);
+
+  setenv("CDG_NUMA_NODES", "2", 1);
+  graph = newReplicatedGraph(root, 0);
+  assert(2 == graph->replicaCnt);
+  deleteReplicatedGraph(graph);
+  unsetenv("CDG_NUMA_NODES");
+  deleteCDG(expected);
+  deleteCDG(root);
+}
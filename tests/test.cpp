@@ -0,0 +1,123 @@
+#include <cstdio>
+#include <cstring>
+#include <type_traits>
+#include "../src/cdg.hpp"
+
+static_assert(!std::is_copy_constructible<cdg::Cdg>::value, "Cdg is move only");
+static_assert(!std::is_copy_assignable<cdg::PathSet>::value, "PathSet is move only");
+static_assert(std::is_nothrow_move_constructible<cdg::Cdg>::value, "Cdg moves");
+static_assert(std::is_nothrow_move_constructible<cdg::PathSet>::value, "PathSet moves");
+
+CDGNode* buildRandomCDG(int size, unsigned int seed) {
+  std::vector<CDGNode*> nodes(size);
+  char expr[32];
+  int i, parent;
+  srand(seed);
+  nodes[0] = newNode(0, 1, 1, "(p 0)", NULL, NULL, NULL, NULL);
+  for ( i = 1; i < size; i++ ) {
+    sprintf(expr, "(p %d)", i % 50);
+    nodes[i] = newNode(i, 1, 1, expr, NULL, NULL, NULL, NULL);
+    parent = rand() % i;
+    if ( 0 == parent % 7 && 0 == rand() % 3 ) {
+      setNextNode(nodes[i], getNextNode(nodes[0]));
+      setNextNode(nodes[0], nodes[i]);
+    } else if ( rand() % 2 ) {
+      addTrueNode(nodes[parent], nodes[i]);
+    } else {
+      addFalseNode(nodes[parent], nodes[i]);
+    }
+  }
+  return nodes[0];
+}
+
+/* Compares a node set of the C++ layer with the C accessors, node by node */
+
+template <class Storage>
+bool sameAsC(cdg::BasicNodeSet<Storage> set, CDGNode* node) {
+  for ( cdg::BasicNode<Storage> n : set ) {
+    if ( NULL == node ) return false;
+    if ( n.c() != node || n.id() != getID(node) || n.score() != getScore(node) ) return false;
+    if ( n.outcome() != (0 != getOutcome(node)) || n.isLeaf() != (0 != isLeaf(node)) ) return false;
+    if ( n.parent().c() != getParent(node) ) return false;
+    if ( (NULL == n.expr()) != (NULL == getExpr(node)) ) return false;
+    if ( n.expr() && 0 != strcmp(n.expr(), getExpr(node)) ) return false;
+    if ( !sameAsC(n.trueSet(), getTrueNodeSet(node)) ) return false;
+    if ( !sameAsC(n.falseSet(), getFalseNodeSet(node)) ) return false;
+    node = getNextNode(node);
+  }
+  return NULL == node;
+}
+
+void tAccessors() {
+  cdg::Cdg graph(buildRandomCDG(3000, 3));
+  assert(sameAsC(graph.nodes(), graph.get()));
+  assert(graph.score() == getConditionalNodeSum(graph.get()));
+  assert(cdg::countNodes(graph.nodes()) == getPathLength(graph.get()));
+
+  cdg::Cdg compact = graph.toCompact();
+  assert(compact.compact() && !graph.compact());
+  assert(sameAsC(compact.compactNodes(), compact.get()));
+  assert(compact.score() == graph.score());
+  assert(cdg::countNodes(compact.compactNodes()) == 3000);
+  cdg::CompactNode first = cdg::CompactNode::fromC(compact.get());
+  assert(first.id() == 0 && first.next().c() == getNextNode(compact.get()));
+}
+
+void tOwnership() {
+  cdg::Cdg graph(buildRandomCDG(2000, 5));
+  CDGNode* expected = updateCDG(buildRandomCDG(2000, 5));
+
+  std::vector<std::pair<int, bool>> branches;
+  std::vector<CDGNode*> covered;
+  for ( int i = 0; i < 6; i++ ) {
+    branches.push_back(std::make_pair(i * 17, 0 == i % 2));
+    covered.push_back(newNode(i * 17, 0, 0 == i % 2, NULL, NULL, NULL, NULL, NULL));
+  }
+  graph.cover(branches);
+  coverNodes(expected, covered.data(), (int)covered.size());
+  assert(sameAsC(graph.nodes(), graph.get()));
+  assert(graph.score() == getConditionalNodeSum(expected));
+
+  cdg::Cdg moved = std::move(graph);
+  assert(!graph && moved);
+  cdg::PathSet paths = moved.topPaths(3);
+  CDGPath* cPaths = getTopPaths(expected, 3);
+  CDGPath* cPath = cPaths;
+  for ( cdg::Node head : paths ) {
+    assert(NULL != cPath);
+    assert(cdg::countNodes(head.siblings()) == getPathLength(getPathNode(cPath)));
+    assert(head.id() == getID(getPathNode(cPath)) && head.outcome() == (0 != getOutcome(getPathNode(cPath))));
+    cPath = getNextPath(cPath);
+  }
+  assert(NULL == cPath && 3 == paths.size());
+
+  cdg::PathSet other;
+  other = std::move(paths);
+  assert(paths.empty() && !other.empty());
+  cdg::Node top = *other.begin();
+  cdg::Path feasible = cdg::feasiblePath(top, top);
+  assert(feasible && cdg::countNodes(feasible.nodes()) == cdg::countNodes(top.siblings()));
+
+  CDGPath* released = other.release();
+  cdg::PathSet adopted(released);
+  assert(adopted.get() == released);
+
+  CDGNode* raw = moved.release();
+  assert(!moved);
+  deleteCDG(raw);
+  while ( cPaths ) {
+    cPath = getNextPath(cPaths);
+    deleteCDG(getPathNode(cPaths));
+    free(cPaths);
+    cPaths = cPath;
+  }
+  for ( CDGNode* node : covered ) deleteNode(node);
+  deleteCDG(expected);
+}
+
+int main() {
+  tAccessors();
+  tOwnership();
+  printf("Hurray... !!! C++ Layer Worked !!!\n");
+  return 0;
+}